@@ -158,10 +158,58 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define configUSE_TIMERS 1
 #endif
 
+/* Select the next task to run with a ready priority bitmap and the port's
+count leading zeros instruction rather than by searching the ready lists.  Ports
+that do not provide portGET_HIGHEST_PRIORITY() use the search whatever this is
+set to. */
+#ifndef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 ) && !defined( portGET_HIGHEST_PRIORITY )
+	#undef configUSE_PORT_OPTIMISED_TASK_SELECTION
+	#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
+
 #ifndef configUSE_COUNTING_SEMAPHORES
 	#define configUSE_COUNTING_SEMAPHORES 0
 #endif
 
+/* Set configSUPPORT_STATIC_ALLOCATION to 1 to provide xTaskCreateStatic(),
+xQueueCreateStatic(), vSemaphoreCreateBinaryStatic() and xTimerCreateStatic(),
+which take the memory for the object from the caller instead of the heap. */
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION 0
+#endif
+
+/* Set configUSE_TASK_NOTIFICATIONS to 1 to give each task a notification
+value, with ulTaskNotifyTake() and vTaskNotifyGiveFromISR() to use it as a
+light weight binary or counting semaphore. */
+#ifndef configUSE_TASK_NOTIFICATIONS
+	#define configUSE_TASK_NOTIFICATIONS 0
+#endif
+
+/* Set configUSE_QUEUE_SETS to 1 to provide xQueueCreateSet() and the other
+queue set functions, with which a task can block on several queues and
+semaphores at once. */
+#ifndef configUSE_QUEUE_SETS
+	#define configUSE_QUEUE_SETS 0
+#endif
+
+/* Set configUSE_TIMER_WHEEL to 1 to keep the active software timers in a
+hierarchical timing wheel rather than in a list sorted by expiry time, so
+starting, stopping and reloading a timer take the same time however many timers
+are running.  Each of the wheel's three levels has
+( 1 << configTIMER_WHEEL_SLOT_BITS ) slots, and each slot costs one xList of
+RAM. */
+#ifndef configUSE_TIMER_WHEEL
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+#ifndef configTIMER_WHEEL_SLOT_BITS
+	#define configTIMER_WHEEL_SLOT_BITS 4
+#endif
+
 #ifndef configUSE_ALTERNATIVE_API
 	#define configUSE_ALTERNATIVE_API 0
 #endif
@@ -264,6 +312,12 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define traceTASK_SWITCHED_OUT()
 #endif
 
+#ifndef traceMOVED_TASK_TO_READY_STATE
+	/* Called when a task is added to a ready list.  pxTCB is a pointer to the
+	task control block of the task. */
+	#define traceMOVED_TASK_TO_READY_STATE( pxTCB )
+#endif
+
 #ifndef traceBLOCKING_ON_QUEUE_RECEIVE
 	/* Task is about to block because it cannot read from a
 	queue/mutex/semaphore.  pxQueue is a pointer to the queue/mutex/semaphore
@@ -386,6 +440,18 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define traceTASK_DELAY()
 #endif
 
+#ifndef traceTASK_NOTIFY_TAKE_BLOCK
+	#define traceTASK_NOTIFY_TAKE_BLOCK()
+#endif
+
+#ifndef traceTASK_NOTIFY_TAKE
+	#define traceTASK_NOTIFY_TAKE()
+#endif
+
+#ifndef traceTASK_NOTIFY_GIVE_FROM_ISR
+	#define traceTASK_NOTIFY_GIVE_FROM_ISR( pxTCB )
+#endif
+
 #ifndef traceTASK_PRIORITY_SET
 	#define traceTASK_PRIORITY_SET( pxTask, uxNewPriority )
 #endif
@@ -468,5 +534,95 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define vPortFreeAligned( pvBlockToFree ) vPortFree( pvBlockToFree )
 #endif
 
+/*
+ * Memory for the objects created by xTaskCreateStatic(), xQueueCreateStatic()
+ * (and vSemaphoreCreateBinaryStatic()) and xTimerCreateStatic().  The members
+ * are not to be used - they are only here so that each structure is the same
+ * size as the one that is private to tasks.c, queue.c or timers.c, and must be
+ * kept in step with it.  The create functions assert that the sizes match.
+ * They are defined here rather than in the API headers because queue.c cannot
+ * include queue.h.
+ */
+typedef struct xSTATIC_LIST_ITEM
+{
+	portTickType xDummy1;
+	void *pvDummy2[ 4 ];
+} xStaticListItem;
+
+typedef struct xSTATIC_LIST
+{
+	unsigned portBASE_TYPE uxDummy1;
+	void *pvDummy2;
+	portTickType xDummy3;
+	void *pvDummy4[ 2 ];
+} xStaticList;
+
+typedef struct xSTATIC_TCB
+{
+	void *pvDummy1;
+	#if ( portUSING_MPU_WRAPPERS == 1 )
+		xMPU_SETTINGS xDummy2;
+	#endif
+	xStaticListItem xDummy3[ 2 ];
+	unsigned portBASE_TYPE uxDummy4;
+	void *pvDummy5;
+	signed char ucDummy6[ configMAX_TASK_NAME_LEN ];
+	#if ( portSTACK_GROWTH > 0 )
+		void *pvDummy7;
+	#endif
+	#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+		unsigned portBASE_TYPE uxDummy8;
+	#endif
+	#if ( configUSE_TRACE_FACILITY == 1 )
+		unsigned portBASE_TYPE uxDummy9;
+	#endif
+	#if ( configUSE_MUTEXES == 1 )
+		unsigned portBASE_TYPE uxDummy10;
+	#endif
+	#if ( configUSE_APPLICATION_TASK_TAG == 1 )
+		void *pvDummy11;
+	#endif
+	#if ( configGENERATE_RUN_TIME_STATS == 1 )
+		unsigned long ulDummy12;
+	#endif
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		unsigned long ulDummy13;
+		unsigned char ucDummy14;
+	#endif
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucDummy15;
+	#endif
+} xStaticTask;
+
+typedef struct xSTATIC_QUEUE
+{
+	void *pvDummy1[ 4 ];
+	xStaticList xDummy2[ 2 ];
+	unsigned portBASE_TYPE uxDummy3[ 3 ];
+	signed portBASE_TYPE xDummy4[ 2 ];
+	#if ( configUSE_QUEUE_SETS == 1 )
+		void *pvDummy5;
+	#endif
+	#if ( configUSE_TRACE_FACILITY == 1 )
+		unsigned char ucDummy6;
+	#endif
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucDummy7;
+	#endif
+} xStaticQueue;
+typedef xStaticQueue xStaticSemaphore;
+
+typedef struct xSTATIC_TIMER
+{
+	void *pvDummy1;
+	xStaticListItem xDummy2;
+	portTickType xDummy3;
+	unsigned portBASE_TYPE uxDummy4;
+	void *pvDummy5[ 2 ];
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucDummy6;
+	#endif
+} xStaticTimer;
+
 #endif /* INC_FREERTOS_H */
 
@@ -79,6 +79,13 @@ extern "C" {
  */
 typedef void * xQueueHandle;
 
+/**
+ * Type by which queue sets are referenced, and the type of the queue or
+ * semaphore returned by xQueueSelectFromSet().
+ */
+typedef xQueueHandle xQueueSetHandle;
+typedef xQueueHandle xQueueSetMemberHandle;
+
 
 /* For internal use only. */
 #define	queueSEND_TO_BACK	( 0 )
@@ -143,6 +150,50 @@ typedef void * xQueueHandle;
  */
 xQueueHandle xQueueCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize );
 
+/**
+ * queue. h
+ * <pre>
+ xQueueHandle xQueueCreateStatic(
+							  unsigned portBASE_TYPE uxQueueLength,
+							  unsigned portBASE_TYPE uxItemSize,
+							  unsigned char *pucQueueStorage,
+							  xStaticQueue *pxStaticQueue
+						  );
+ * </pre>
+ *
+ * As xQueueCreate(), but the memory for the queue is given by the caller
+ * instead of being taken from the heap.  It must exist for as long as the
+ * queue does - it is not freed by vQueueDelete().
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * @param pucQueueStorage An array of at least ( uxQueueLength * uxItemSize )
+ * bytes to hold the items, or NULL if uxItemSize is 0.
+ *
+ * @param pxStaticQueue The memory to use for the queue structure.
+ *
+ * @return A handle to the queue (which will be the address of pxStaticQueue).
+ *
+ * Example usage:
+   <pre>
+ #define QUEUE_LENGTH 10
+ static unsigned char ucQueueStorage[ QUEUE_LENGTH * sizeof( struct AMessage ) ];
+ static xStaticQueue xQueueBuffer;
+
+ void vATask( void *pvParameters )
+ {
+ xQueueHandle xQueue;
+
+	xQueue = xQueueCreateStatic( QUEUE_LENGTH, sizeof( struct AMessage ), ucQueueStorage, &xQueueBuffer );
+ }
+ </pre>
+ * \defgroup xQueueCreateStatic xQueueCreateStatic
+ * \ingroup QueueManagement
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxStaticQueue );
+#endif
+
 /**
  * queue. h
  * <pre>
@@ -1258,6 +1309,126 @@ portBASE_TYPE xQueueGiveMutexRecursive( xQueueHandle pxMutex );
 	void vQueueAddToRegistry( xQueueHandle xQueue, signed char *pcName );
 #endif
 
+/**
+ * queue. h
+ * <pre>
+ xQueueSetHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength );
+ </pre>
+ *
+ * Creates a queue set, with which a task can block on several queues and
+ * semaphores at once.  configUSE_QUEUE_SETS must be set to 1 in
+ * FreeRTOSConfig.h for the queue set functions to be available.
+ *
+ * Queues and semaphores are put in the set with xQueueAddToSet().  Each time
+ * an item is sent to a member (or a member semaphore is given) the handle of
+ * the member is added to the set, and xQueueSelectFromSet() returns the next
+ * of those handles.  The item is then read from the member with a block time
+ * of 0, which will not fail.  A member should only be read this way, after
+ * its handle has been returned.
+ *
+ * Mutexes cannot be members of a set.
+ *
+ * @param uxEventQueueLength The number of handles the set can hold.  This must
+ * be at least the sum of the lengths of all of its members (a binary semaphore
+ * has a length of 1), so that there is always room for one more.
+ *
+ * @return The handle of the set, or NULL if it could not be created.
+ *
+ * Example usage:
+   <pre>
+ void vATask( void *pvParameters )
+ {
+ xQueueSetHandle xSet;
+ xQueueSetMemberHandle xMember;
+
+	xSet = xQueueCreateSet( QUEUE_LENGTH_1 + QUEUE_LENGTH_2 );
+	xQueueAddToSet( xQueue1, xSet );
+	xQueueAddToSet( xQueue2, xSet );
+
+	for( ;; )
+	{
+		xMember = xQueueSelectFromSet( xSet, portMAX_DELAY );
+		if( xMember == xQueue1 )
+		{
+			xQueueReceive( xQueue1, &xReceived1, 0 );
+		}
+		else if( xMember == xQueue2 )
+		{
+			xQueueReceive( xQueue2, &xReceived2, 0 );
+		}
+	}
+ }
+ </pre>
+ * \defgroup xQueueCreateSet xQueueCreateSet
+ * \ingroup QueueSets
+ */
+#if ( configUSE_QUEUE_SETS == 1 )
+	xQueueSetHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength );
+#endif
+
+/**
+ * queue. h
+ * <pre>
+ xQueueSetHandle xQueueCreateSetStatic(
+							  unsigned portBASE_TYPE uxEventQueueLength,
+							  unsigned char *pucQueueSetStorage,
+							  xStaticQueue *pxStaticQueueSet
+						  );
+ </pre>
+ *
+ * As xQueueCreateSet(), but the memory is given by the caller as for
+ * xQueueCreateStatic().  pucQueueSetStorage must be an array of at least
+ * uxEventQueueLength handles.  This is a macro, as a set is a queue.
+ *
+ * \defgroup xQueueCreateSetStatic xQueueCreateSetStatic
+ * \ingroup QueueSets
+ */
+#if ( ( configUSE_QUEUE_SETS == 1 ) && ( configSUPPORT_STATIC_ALLOCATION == 1 ) )
+	#define xQueueCreateSetStatic( uxEventQueueLength, pucQueueSetStorage, pxStaticQueueSet ) xQueueCreateStatic( ( uxEventQueueLength ), sizeof( xQueueSetMemberHandle ), ( pucQueueSetStorage ), ( pxStaticQueueSet ) )
+#endif
+
+/**
+ * queue. h
+ * <pre>
+ portBASE_TYPE xQueueAddToSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+ portBASE_TYPE xQueueRemoveFromSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+ </pre>
+ *
+ * Adds a queue or semaphore to a set, or takes it out again.  Either only
+ * works when the queue is empty (a binary semaphore made by
+ * vSemaphoreCreateBinary() has to be taken first).  A queue can only be in
+ * one set at a time.
+ *
+ * @return pdPASS if the queue was added or removed, otherwise pdFAIL.
+ *
+ * \defgroup xQueueAddToSet xQueueAddToSet
+ * \ingroup QueueSets
+ */
+#if ( configUSE_QUEUE_SETS == 1 )
+	portBASE_TYPE xQueueAddToSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+	portBASE_TYPE xQueueRemoveFromSet( xQueueSetMemberHandle xQueueOrSemaphore, xQueueSetHandle xQueueSet );
+#endif
+
+/**
+ * queue. h
+ * <pre>
+ xQueueSetMemberHandle xQueueSelectFromSet( xQueueSetHandle xQueueSet, portTickType xBlockTimeTicks );
+ xQueueSetMemberHandle xQueueSelectFromSetFromISR( xQueueSetHandle xQueueSet );
+ </pre>
+ *
+ * Waits (for at most xBlockTimeTicks) for a member of the set to have an item
+ * sent to it, and returns which one.  The FromISR version does not wait.
+ *
+ * @return The member that an item was sent to, or NULL if the wait timed out.
+ *
+ * \defgroup xQueueSelectFromSet xQueueSelectFromSet
+ * \ingroup QueueSets
+ */
+#if ( configUSE_QUEUE_SETS == 1 )
+	xQueueSetMemberHandle xQueueSelectFromSet( xQueueSetHandle xQueueSet, portTickType xBlockTimeTicks );
+	xQueueSetMemberHandle xQueueSelectFromSetFromISR( xQueueSetHandle xQueueSet );
+#endif
+
 /* Not a public API function, hence the 'Restricted' in the name. */
 void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait );
 
@@ -119,6 +119,43 @@ typedef xQueueHandle xSemaphoreHandle;
 														}																								\
 													}
 
+/**
+ * semphr. h
+ * <pre>vSemaphoreCreateBinaryStatic( xSemaphoreHandle xSemaphore, xStaticSemaphore *pxSemaphoreBuffer )</pre>
+ *
+ * <i>Macro</i> that creates a binary semaphore as vSemaphoreCreateBinary()
+ * does, but in the memory given by pxSemaphoreBuffer instead of memory taken
+ * from the heap.  configSUPPORT_STATIC_ALLOCATION must be set to 1 in
+ * FreeRTOSConfig.h for this macro to be available.
+ *
+ * @param xSemaphore Handle to the created semaphore.  Should be of type xSemaphoreHandle.
+ *
+ * @param pxSemaphoreBuffer The memory to use for the semaphore, which must
+ * exist for as long as the semaphore does.
+ *
+ * Example usage:
+ <pre>
+ xSemaphoreHandle xSemaphore;
+ static xStaticSemaphore xSemaphoreBuffer;
+
+ void vATask( void * pvParameters )
+ {
+    vSemaphoreCreateBinaryStatic( xSemaphore, &xSemaphoreBuffer );
+ }
+ </pre>
+ * \defgroup vSemaphoreCreateBinaryStatic vSemaphoreCreateBinaryStatic
+ * \ingroup Semaphores
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	#define vSemaphoreCreateBinaryStatic( xSemaphore, pxSemaphoreBuffer )	{																									\
+																				( xSemaphore ) = xQueueCreateStatic( ( unsigned portBASE_TYPE ) 1, semSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, ( pxSemaphoreBuffer ) );	\
+																				if( ( xSemaphore ) != NULL )																	\
+																				{																								\
+																					xSemaphoreGive( ( xSemaphore ) );															\
+																				}																								\
+																			}
+#endif
+
 /**
  * semphr. h
  * <pre>xSemaphoreTake( 
@@ -275,6 +275,54 @@ typedef struct xTASK_PARAMTERS
  */
 #define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ) )
 
+/**
+ * task. h
+ *<pre>
+ portBASE_TYPE xTaskCreateStatic(
+							  pdTASK_CODE pvTaskCode,
+							  const char * const pcName,
+							  unsigned short usStackDepth,
+							  void *pvParameters,
+							  unsigned portBASE_TYPE uxPriority,
+							  xTaskHandle *pvCreatedTask,
+							  portSTACK_TYPE *puxStackBuffer,
+							  xStaticTask *pxTaskBuffer
+						  );</pre>
+ *
+ * As xTaskCreate(), but the stack and the task control block are given by
+ * the caller instead of being taken from the heap.  Both must exist for as
+ * long as the task does - they are not freed when the task is deleted.
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * @param puxStackBuffer An array of at least usStackDepth portSTACK_TYPE
+ * entries to use as the stack of the task.
+ *
+ * @param pxTaskBuffer The memory to use for the task control block.
+ *
+ * @return pdPASS if the task was successfully created and added to a ready
+ * list, otherwise an error code defined in the file errors. h
+ *
+ * Example usage:
+   <pre>
+ #define STACK_SIZE 200
+ static portSTACK_TYPE xStack[ STACK_SIZE ];
+ static xStaticTask xTaskBuffer;
+
+ void vOtherFunction( void )
+ {
+	 // Neither xStack nor xTaskBuffer come from the heap, so if there is not
+	 // enough RAM for them the link fails.
+	 xTaskCreateStatic( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL, xStack, &xTaskBuffer );
+ }
+   </pre>
+ * \defgroup xTaskCreateStatic xTaskCreateStatic
+ * \ingroup Tasks
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	signed portBASE_TYPE xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  *<pre>
@@ -1117,6 +1165,61 @@ unsigned long ulTaskEndTrace( void ) PRIVILEGED_FUNCTION;
  */
 unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
 
+/**
+ * task.h
+ * <PRE>unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );</PRE>
+ *
+ * configUSE_TASK_NOTIFICATIONS must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.
+ *
+ * Each task has a notification value that vTaskNotifyGiveFromISR() adds one
+ * to.  ulTaskNotifyTake() waits for the value of the calling task to be
+ * non-zero, then clears it (to be used like a binary semaphore) or takes one
+ * from it (to be used like a counting semaphore).  Unlike a semaphore no
+ * queue is needed, so it is faster and uses no RAM, but only the one task can
+ * wait for it.
+ *
+ * @param xClearCountOnExit pdTRUE to clear the value before returning, pdFALSE
+ * to take one from it.
+ *
+ * @param xTicksToWait The maximum time to wait for the value to be non-zero.
+ * Setting it to portMAX_DELAY (with INCLUDE_vTaskSuspend set to 1) waits
+ * without a time out.
+ *
+ * @return The value before it was cleared or decremented, so zero if the wait
+ * timed out.
+ *
+ * \page ulTaskNotifyTake ulTaskNotifyTake
+ * \ingroup TaskNotifications
+ */
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task.h
+ * <PRE>void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * configUSE_TASK_NOTIFICATIONS must be set to 1 in FreeRTOSConfig.h for this
+ * function to be available.
+ *
+ * Adds one to the notification value of xTaskToNotify, unblocking the task if
+ * it is waiting in ulTaskNotifyTake().  For use from an interrupt, in place of
+ * xSemaphoreGiveFromISR().
+ *
+ * @param xTaskToNotify The task to notify.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the notified task was
+ * unblocked and has a priority at least that of the running task, in which
+ * case a context switch should be requested before the interrupt is exited.
+ *
+ * \page vTaskNotifyGiveFromISR vTaskNotifyGiveFromISR
+ * \ingroup TaskNotifications
+ */
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+#endif
+
 /* When using trace macros it is sometimes necessary to include tasks.h before
 FreeRTOS.h.  When this is done pdTASK_HOOK_CODE will not yet have been defined,
 so the following two prototypes will cause a compilation error.  This can be
@@ -225,6 +225,29 @@ typedef void (*tmrTIMER_CALLBACK)( xTimerHandle xTimer );
  */
 xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
 
+/**
+ * xTimerHandle xTimerCreateStatic( 	const signed char *pcTimerName,
+ * 									portTickType xTimerPeriodInTicks,
+ * 									unsigned portBASE_TYPE uxAutoReload,
+ * 									void * pvTimerID,
+ * 									tmrTIMER_CALLBACK pxCallbackFunction,
+ * 									xStaticTimer *pxTimerBuffer );
+ *
+ * As xTimerCreate(), but the memory for the timer is given by the caller
+ * instead of being taken from the heap.  It must exist for as long as the
+ * timer does - it is not freed when the timer is deleted.
+ * configSUPPORT_STATIC_ALLOCATION must be set to 1 in FreeRTOSConfig.h for
+ * this function to be available.
+ *
+ * @param pxTimerBuffer The memory to use for the timer.
+ *
+ * @return If the timer period is not zero, a handle to the timer (which will
+ * be the address of pxTimerBuffer), otherwise NULL.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimer *pxTimerBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * void *pvTimerGetTimerID( xTimerHandle xTimer );
  *
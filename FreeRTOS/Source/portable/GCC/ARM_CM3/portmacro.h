@@ -142,6 +142,33 @@ extern void vPortExitCritical( void );
 #define portEXIT_CRITICAL()			vPortExitCritical()
 /*-----------------------------------------------------------*/
 
+/* Port optimised task selection (configUSE_PORT_OPTIMISED_TASK_SELECTION).
+uxTopReadyPriority holds a bit for each priority that has a ready task, so the
+highest ready priority is found with a single clz instruction whatever the
+spread of priorities. */
+#if defined( configUSE_PORT_OPTIMISED_TASK_SELECTION ) && ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 1 )
+
+	/* configUSE_PORT_OPTIMISED_TASK_SELECTION can only be set to 1 when
+	configMAX_PRIORITIES is less than or equal to 32.  This is checked by the
+	compiler rather than the preprocessor because configMAX_PRIORITIES is
+	usually defined with a cast. */
+	typedef char xPortMaxPrioritiesCheck[ ( configMAX_PRIORITIES <= 32 ) ? 1 : -1 ];
+
+	static inline unsigned char ucPortCountLeadingZeros( unsigned long ulBitmap )
+	{
+	unsigned char ucReturn;
+
+		__asm volatile ( "clz %0, %1" : "=r" ( ucReturn ) : "r" ( ulBitmap ) );
+		return ucReturn;
+	}
+
+	#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+	#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities ) ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+	#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities ) uxTopPriority = ( 31 - ucPortCountLeadingZeros( ( uxReadyPriorities ) ) )
+
+#endif
+/*-----------------------------------------------------------*/
+
 /* Task function macros as described on the FreeRTOS.org WEB site. */
 #define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
 #define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
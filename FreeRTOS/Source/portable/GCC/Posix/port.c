@@ -0,0 +1,847 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+	
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for a POSIX host.
+ *
+ * Each task is a pthread.  A thread only runs while its task is the one
+ * pointed to by pxCurrentTCB; every other task thread is parked on its own 
+ * condition variable.  The tick and any other simulated interrupts are 
+ * delivered as signals.  Only the thread that is running a task ever has 
+ * those signals unblocked, so the signal handler always executes in the 
+ * context of the running task - just as an interrupt handler on the target
+ * executes on top of whatever task it interrupted.  A context switch from 
+ * within the handler parks the interrupted thread inside the handler until 
+ * its task is selected again.
+ *
+ * Critical sections block the signals (with nesting), which holds off ticks
+ * and simulated interrupts until the critical section is exited.
+ *
+ * With virtual time (see vPortSetVirtualTime()) there is no tick timer.  The
+ * clock only moves when the idle task calls vPortWaitForInterrupt(), which
+ * steps it to the next tick or the next deadline of a host thread sleeping in
+ * vPortSleepMicroseconds().  The host threads that model the peripherals are
+ * woken one at a time, and the interrupts they raise are taken once they have
+ * all blocked again, so a run depends only on its inputs and not on how the
+ * host schedules its threads.
+ *
+ * Note that a task can be switched out while it is inside a C library call
+ * that holds a library lock.  Tasks should therefore not call stdio 
+ * functions that lock (printf(), fprintf() etc.) unless the scheduler is
+ * suspended - the same restriction as the Win32 simulator port.
+ *----------------------------------------------------------*/
+
+#include <pthread.h>
+#include <signal.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define portMAX_INTERRUPTS				( ( unsigned long ) sizeof( unsigned long ) * 8UL ) /* The number of bits in an unsigned long. */
+#define portNO_CRITICAL_NESTING 		( ( unsigned long ) 0 )
+
+/* Signals used to deliver the simulated interrupts. */
+#define portSIGNAL_TICK					SIGALRM
+#define portSIGNAL_INTERRUPT			SIGUSR1
+
+/* The tick period in microseconds. */
+#define portTICK_PERIOD_US				( 1000000UL / configTICK_RATE_HZ )
+
+/*-----------------------------------------------------------*/
+
+/* As with the Win32 simulator the task stack is not used to hold a context, 
+but is used to hold an xThreadState structure.  The first member of the TCB
+points to it, which maps the task handle to the thread that runs the task. */
+typedef struct
+{
+	/* The thread that executes the task. */
+	pthread_t xThread;
+
+	/* Signalled when the task is selected to run. */
+	pthread_cond_t xResumeCondition;
+
+	/* pdTRUE while the task is the one that should be executing. */
+	volatile portBASE_TYPE xRunning;
+
+	/* Set when the task has been deleted and the thread should exit. */
+	volatile portBASE_TYPE xDeleted;
+
+	/* The task function and its parameter, used when the thread starts. */
+	pdTASK_CODE pxCode;
+	void *pvParameters;
+
+} xThreadState;
+
+/*
+ * Entry point of every task thread.  Waits until the task is first selected
+ * to run, then calls the task function.
+ */
+static void *prvTaskThreadEntry( void *pvParameters );
+
+/*
+ * The single handler for all the signals used to simulate interrupts.
+ */
+static void prvSimulatedInterruptHandler( int iSignal );
+
+/*
+ * Select the next task to run and, if it is not the calling task, hand the 
+ * processor to it and park the calling thread.  Must be called with the 
+ * simulated interrupts blocked.
+ */
+static void prvSwitchThread( void );
+
+/*
+ * Interrupt handlers used by the kernel itself.
+ */
+static unsigned long prvProcessYieldInterrupt( void );
+static unsigned long prvProcessTickInterrupt( void );
+
+/*
+ * Obtain the thread state from a TCB.
+ */
+static xThreadState *prvGetThreadState( void *pvTCB );
+
+/*
+ * With virtual time, wait until every host thread is blocked.  Must be called
+ * with xTimeMutex held.
+ */
+static void prvWaitForHostThreads( void );
+
+/*
+ * With virtual time, count the calling host thread as blocked.  Must be called
+ * with xTimeMutex held.
+ */
+static void prvHostThreadBlocked( void );
+
+/*-----------------------------------------------------------*/
+
+/* Simulated interrupts waiting to be processed.  This is a bit mask where each
+bit represents one interrupt. */
+static volatile unsigned long ulPendingInterrupts = 0UL;
+
+/* Handlers for all the simulated interrupts.  The first two positions are 
+used for the Yield and Tick interrupts, the rest can be user defined. */
+static unsigned long (*ulIsrHandler[ portMAX_INTERRUPTS ])( void ) = { 0 };
+
+/* Set when a context switch has been requested while it could not be 
+performed - from within a simulated interrupt or a critical section. */
+static volatile portBASE_TYPE xSwitchPending = pdFALSE;
+
+/* Each thread has its own critical nesting count, in the same way each task 
+on the target saves its nesting count as part of its context.  The signal mask
+is also per thread, so the two always agree.  Initialised to a non-zero value
+so the thread that calls main() does not enable interrupts before the 
+scheduler has started. */
+static __thread unsigned long ulCriticalNesting = 9999UL;
+
+/* Guards the xRunning flags and all the resume conditions. */
+static pthread_mutex_t xSwitchMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Used to return control to the thread that called vTaskStartScheduler(). */
+static pthread_cond_t xSchedulerEndCondition = PTHREAD_COND_INITIALIZER;
+static volatile portBASE_TYPE xSchedulerEnded = pdFALSE;
+
+/* The set of signals used to simulate interrupts. */
+static sigset_t xInterruptSignals;
+
+/* Simulated clock speed relative to the host clock (see vPortSetTimeScale()). */
+static unsigned long ulTimeScale = 1UL;
+
+/* A host thread sleeping in vPortSleepMicroseconds() with virtual time.  Each
+one lives on the stack of the thread that is sleeping. */
+typedef struct xSLEEPER
+{
+	unsigned long ulWakeTime;
+	volatile portBASE_TYPE xWoken;
+	struct xSLEEPER *pxNext;
+} xSleeper;
+
+/* Set by vPortSetVirtualTime(). */
+static portBASE_TYPE xVirtualTime = pdFALSE;
+
+/* The virtual clock, and when it next reaches a tick. */
+static volatile unsigned long ulVirtualMicroseconds = 0UL;
+static unsigned long ulNextTickTime = portTICK_PERIOD_US;
+
+/* The sleeping host threads, in the order they went to sleep. */
+static xSleeper *pxSleepers = NULL;
+
+/* The number of host threads that have been woken and have not yet blocked 
+again.  Only ever incremented when the clock is not moving. */
+static volatile unsigned long ulHostThreadsBusy = 0UL;
+
+/* Guards the virtual clock and the sleepers. */
+static pthread_mutex_t xTimeMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xSleepCondition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t xHostThreadsCondition = PTHREAD_COND_INITIALIZER;
+
+/* Pointer to the TCB of the currently executing task. */
+extern void *pxCurrentTCB;
+
+/*-----------------------------------------------------------*/
+
+static xThreadState *prvGetThreadState( void *pvTCB )
+{
+	/* The first member of the TCB is pxTopOfStack, which holds the address 
+	returned by pxPortInitialiseStack(). */
+	return ( xThreadState * ) *( ( portSTACK_TYPE ** ) pvTCB );
+}
+/*-----------------------------------------------------------*/
+
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters )
+{
+xThreadState *pxThreadState;
+sigset_t xAllSignals, xOldSignals;
+uintptr_t uxAddress;
+
+	/* In this simulated case a stack is not initialised, but instead a thread
+	is created that will execute the task being created.  The xThreadState
+	object is placed at the top of the stack that was created for the task, 
+	aligned for the pthread objects it contains. */
+	uxAddress = ( uintptr_t ) pxTopOfStack - sizeof( xThreadState );
+	uxAddress &= ~( ( uintptr_t ) 0x0f );
+	pxThreadState = ( xThreadState * ) uxAddress;
+
+	pxThreadState->xRunning = pdFALSE;
+	pxThreadState->xDeleted = pdFALSE;
+	pxThreadState->pxCode = pxCode;
+	pxThreadState->pvParameters = pvParameters;
+	pthread_cond_init( &( pxThreadState->xResumeCondition ), NULL );
+
+	/* The new thread inherits the signal mask of this thread.  Block 
+	everything while it is created so it cannot be picked to handle a 
+	simulated interrupt before it has run for the first time. */
+	sigfillset( &xAllSignals );
+	pthread_sigmask( SIG_SETMASK, &xAllSignals, &xOldSignals );
+	if( pthread_create( &( pxThreadState->xThread ), NULL, prvTaskThreadEntry, pxThreadState ) != 0 )
+	{
+		/* There is no way of reporting the failure from here, and the task
+		would never run. */
+		abort();
+	}
+	pthread_sigmask( SIG_SETMASK, &xOldSignals, NULL );
+
+	return ( portSTACK_TYPE * ) pxThreadState;
+}
+/*-----------------------------------------------------------*/
+
+static void *prvTaskThreadEntry( void *pvParameters )
+{
+xThreadState *pxThreadState = ( xThreadState * ) pvParameters;
+
+	/* Wait to be selected to run for the first time. */
+	pthread_mutex_lock( &xSwitchMutex );
+	while( ( pxThreadState->xRunning == pdFALSE ) && ( pxThreadState->xDeleted == pdFALSE ) )
+	{
+		pthread_cond_wait( &( pxThreadState->xResumeCondition ), &xSwitchMutex );
+	}
+	pthread_mutex_unlock( &xSwitchMutex );
+
+	if( pxThreadState->xDeleted != pdFALSE )
+	{
+		/* Deleted before it ever ran. */
+		return NULL;
+	}
+
+	/* A task always starts with interrupts enabled. */
+	ulCriticalNesting = portNO_CRITICAL_NESTING;
+	pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+
+	pxThreadState->pxCode( pxThreadState->pvParameters );
+
+	/* Tasks must not return from their implementing function. */
+	vTaskDelete( NULL );
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+portBASE_TYPE xPortStartScheduler( void )
+{
+struct sigaction xAction;
+struct itimerval xTimer;
+xThreadState *pxThreadState;
+sigset_t xAllSignals;
+
+	/* Install the interrupt handlers used by the scheduler itself. */
+	vPortSetInterruptHandler( portINTERRUPT_YIELD, prvProcessYieldInterrupt );
+	vPortSetInterruptHandler( portINTERRUPT_TICK, prvProcessTickInterrupt );
+
+	/* This thread never runs a task, so it must never handle a simulated 
+	interrupt. */
+	sigfillset( &xAllSignals );
+	pthread_sigmask( SIG_SETMASK, &xAllSignals, NULL );
+
+	/* Simulated interrupts do not nest - both signals are blocked while 
+	either handler is running. */
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvSimulatedInterruptHandler;
+	xAction.sa_flags = SA_RESTART;
+	sigemptyset( &( xAction.sa_mask ) );
+	sigaddset( &( xAction.sa_mask ), portSIGNAL_TICK );
+	sigaddset( &( xAction.sa_mask ), portSIGNAL_INTERRUPT );
+	sigaction( portSIGNAL_TICK, &xAction, NULL );
+	sigaction( portSIGNAL_INTERRUPT, &xAction, NULL );
+
+	/* Start the first task. */
+	pxThreadState = prvGetThreadState( pxCurrentTCB );
+	pthread_mutex_lock( &xSwitchMutex );
+	pxThreadState->xRunning = pdTRUE;
+	pthread_cond_signal( &( pxThreadState->xResumeCondition ) );
+	pthread_mutex_unlock( &xSwitchMutex );
+
+	/* Start the timer that generates the tick.  With virtual time the tick 
+	comes from vPortWaitForInterrupt() instead. */
+	if( xVirtualTime == pdFALSE )
+	{
+		xTimer.it_interval.tv_sec = 0;
+		xTimer.it_interval.tv_usec = portTICK_PERIOD_US / ulTimeScale;
+		xTimer.it_value = xTimer.it_interval;
+		setitimer( ITIMER_REAL, &xTimer, NULL );
+	}
+
+	/* Wait here until vTaskEndScheduler() is called. */
+	pthread_mutex_lock( &xSwitchMutex );
+	while( xSchedulerEnded == pdFALSE )
+	{
+		pthread_cond_wait( &xSchedulerEndCondition, &xSwitchMutex );
+	}
+	pthread_mutex_unlock( &xSwitchMutex );
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+xThreadState *pxThreadState;
+
+	/* Stop the tick. */
+	memset( &xTimer, 0, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	pxThreadState = prvGetThreadState( pxCurrentTCB );
+
+	/* Return control to the thread that started the scheduler, then park this 
+	thread for good - none of the task threads run again. */
+	pthread_mutex_lock( &xSwitchMutex );
+	xSchedulerEnded = pdTRUE;
+	pxThreadState->xRunning = pdFALSE;
+	pthread_cond_signal( &xSchedulerEndCondition );
+	for( ;; )
+	{
+		pthread_cond_wait( &( pxThreadState->xResumeCondition ), &xSwitchMutex );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvProcessYieldInterrupt( void )
+{
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static unsigned long prvProcessTickInterrupt( void )
+{
+unsigned long ulSwitchRequired;
+
+	/* Process the tick itself. */
+	vTaskIncrementTick();
+	#if( configUSE_PREEMPTION != 0 )
+	{
+		/* A context switch is only automatically performed from the tick
+		interrupt if the pre-emptive scheduler is being used. */
+		ulSwitchRequired = pdTRUE;
+	}
+	#else
+	{
+		ulSwitchRequired = pdFALSE;
+	}
+	#endif
+
+	return ulSwitchRequired;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSimulatedInterruptHandler( int iSignal )
+{
+unsigned long ulPending, i;
+int iSavedErrno = errno;
+
+	if( iSignal == portSIGNAL_TICK )
+	{
+		__sync_fetch_and_or( &ulPendingInterrupts, 1UL << portINTERRUPT_TICK );
+	}
+
+	if( xSchedulerEnded == pdFALSE )
+	{
+		/* Hold off any context switch requested by the handlers until they 
+		have all completed. */
+		ulCriticalNesting++;
+
+		/* For each interrupt we are interested in processing, each of which
+		is represented by a bit in ulPendingInterrupts.  Interrupts raised 
+		while the handlers run are picked up on the next pass. */
+		while( ( ulPending = __sync_fetch_and_and( &ulPendingInterrupts, 0UL ) ) != 0UL )
+		{
+			for( i = 0; i < portMAX_INTERRUPTS; i++ )
+			{
+				if( ( ulPending & ( 1UL << i ) ) && ( ulIsrHandler[ i ] != NULL ) )
+				{
+					if( ulIsrHandler[ i ]() != pdFALSE )
+					{
+						xSwitchPending = pdTRUE;
+					}
+				}
+			}
+		}
+
+		ulCriticalNesting--;
+
+		if( xSwitchPending != pdFALSE )
+		{
+			xSwitchPending = pdFALSE;
+			prvSwitchThread();
+		}
+	}
+
+	errno = iSavedErrno;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( void )
+{
+xThreadState *pxOldThreadState, *pxNewThreadState;
+
+	pxOldThreadState = prvGetThreadState( pxCurrentTCB );
+
+	/* Select the next task to run. */
+	vTaskSwitchContext();
+
+	pxNewThreadState = prvGetThreadState( pxCurrentTCB );
+
+	/* If the task selected to enter the running state is not the task that
+	is already in the running state. */
+	if( pxOldThreadState != pxNewThreadState )
+	{
+		pthread_mutex_lock( &xSwitchMutex );
+
+		pxOldThreadState->xRunning = pdFALSE;
+		pxNewThreadState->xRunning = pdTRUE;
+		pthread_cond_signal( &( pxNewThreadState->xResumeCondition ) );
+
+		if( pxOldThreadState->xDeleted != pdFALSE )
+		{
+			/* The task deleted itself.  Its stack, and so its thread state, 
+			is freed by the idle task, which cannot run until the mutex is 
+			released - so nothing is touched after the release. */
+			pthread_detach( pthread_self() );
+			pthread_mutex_unlock( &xSwitchMutex );
+			pthread_exit( NULL );
+		}
+
+		while( pxOldThreadState->xRunning == pdFALSE )
+		{
+			pthread_cond_wait( &( pxOldThreadState->xResumeCondition ), &xSwitchMutex );
+
+			if( pxOldThreadState->xDeleted != pdFALSE )
+			{
+				/* Deleted by another task while parked. */
+				pthread_mutex_unlock( &xSwitchMutex );
+				pthread_exit( NULL );
+			}
+		}
+
+		pthread_mutex_unlock( &xSwitchMutex );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDeleteThread( void *pvTaskToDelete )
+{
+xThreadState *pxThreadState;
+
+	pxThreadState = prvGetThreadState( pvTaskToDelete );
+
+	if( pvTaskToDelete == pxCurrentTCB )
+	{
+		/* The task is deleting itself.  The thread exits when it is switched
+		out by the yield that vTaskDelete() performs next. */
+		pxThreadState->xDeleted = pdTRUE;
+	}
+	else
+	{
+		/* Wake the parked thread so it can exit, and wait for it to do so
+		before vTaskDelete() allows the idle task to free its stack. */
+		pthread_mutex_lock( &xSwitchMutex );
+		pxThreadState->xDeleted = pdTRUE;
+		pthread_cond_signal( &( pxThreadState->xResumeCondition ) );
+		pthread_mutex_unlock( &xSwitchMutex );
+		pthread_join( pxThreadState->xThread, NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	vPortEnterCritical();
+
+	if( ulCriticalNesting > ( portNO_CRITICAL_NESTING + 1 ) )
+	{
+		/* Called from within a critical section.  As with PendSV on the 
+		target the switch does not happen until the critical section is 
+		exited. */
+		xSwitchPending = pdTRUE;
+	}
+	else
+	{
+		prvSwitchThread();
+	}
+
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+	xSwitchPending = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGenerateSimulatedInterrupt( unsigned long ulInterruptNumber )
+{
+	if( ulInterruptNumber < portMAX_INTERRUPTS )
+	{
+		__sync_fetch_and_or( &ulPendingInterrupts, 1UL << ulInterruptNumber );
+
+		/* The signal is directed at the process, and the only thread that can
+		accept it is the one running a task.  If that task is in a critical
+		section the signal stays pending until the section is exited.  With
+		virtual time vPortWaitForInterrupt() raises it once the host threads 
+		have all blocked. */
+		if( xVirtualTime == pdFALSE )
+		{
+			kill( getpid(), portSIGNAL_INTERRUPT );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetInterruptHandler( unsigned long ulInterruptNumber, unsigned long (*pvHandler)( void ) )
+{
+	if( ulInterruptNumber < portMAX_INTERRUPTS )
+	{
+		/* Handlers are normally installed before the scheduler is started,
+		but a pointer store cannot be torn so no locking is needed here. */
+		ulIsrHandler[ ulInterruptNumber ] = pvHandler;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	pthread_sigmask( SIG_UNBLOCK, &xInterruptSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	vPortDisableInterrupts();
+	ulCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	if( ulCriticalNesting > portNO_CRITICAL_NESTING )
+	{
+		ulCriticalNesting--;
+
+		if( ulCriticalNesting == portNO_CRITICAL_NESTING )
+		{
+			/* Perform any switch that was requested while the critical 
+			section was held, then let the pending interrupts in. */
+			if( ( xSwitchPending != pdFALSE ) && ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) )
+			{
+				xSwitchPending = pdFALSE;
+				prvSwitchThread();
+			}
+
+			vPortEnableInterrupts();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulPortGetMicroseconds( void )
+{
+struct timespec xNow;
+
+	if( xVirtualTime != pdFALSE )
+	{
+		return ulVirtualMicroseconds;
+	}
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return ( ( unsigned long ) xNow.tv_sec * 1000000UL + ( unsigned long ) ( xNow.tv_nsec / 1000L ) ) * ulTimeScale;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetTimeScale( unsigned long ulScale )
+{
+	/* The tick interval has to stay at least a microsecond. */
+	if( ulScale == 0UL )
+	{
+		ulScale = 1UL;
+	}
+	else if( ulScale > portTICK_PERIOD_US )
+	{
+		ulScale = portTICK_PERIOD_US;
+	}
+	ulTimeScale = ulScale;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSetVirtualTime( void )
+{
+	xVirtualTime = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortSleepMicroseconds( unsigned long ulMicroseconds )
+{
+struct timespec xDelay;
+unsigned long ulHostMicroseconds = ulMicroseconds / ulTimeScale;
+xSleeper xSleep, **ppxLast;
+
+	if( xVirtualTime != pdFALSE )
+	{
+		pthread_mutex_lock( &xTimeMutex );
+		xSleep.ulWakeTime = ulVirtualMicroseconds + ulMicroseconds;
+		xSleep.xWoken = pdFALSE;
+		xSleep.pxNext = NULL;
+		for( ppxLast = &pxSleepers; *ppxLast != NULL; ppxLast = &( ( *ppxLast )->pxNext ) );
+		*ppxLast = &xSleep;
+		prvHostThreadBlocked();
+
+		/* vPortWaitForInterrupt() takes the entry off the list, and counts 
+		this thread as busy again, when the clock reaches the wake time. */
+		while( xSleep.xWoken == pdFALSE )
+		{
+			pthread_cond_wait( &xSleepCondition, &xTimeMutex );
+		}
+		pthread_mutex_unlock( &xTimeMutex );
+		return;
+	}
+
+	xDelay.tv_sec = ulHostMicroseconds / 1000000UL;
+	xDelay.tv_nsec = ( long ) ( ulHostMicroseconds % 1000000UL ) * 1000L;
+	while( ( nanosleep( &xDelay, &xDelay ) != 0 ) && ( errno == EINTR ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortHostThreadWake( void )
+{
+	if( xVirtualTime != pdFALSE )
+	{
+		/* May be called from a simulated interrupt handler, so no lock is 
+		taken.  The count only goes up while the clock is not moving. */
+		__sync_fetch_and_add( &ulHostThreadsBusy, 1UL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortHostThreadWait( void )
+{
+	if( xVirtualTime != pdFALSE )
+	{
+		pthread_mutex_lock( &xTimeMutex );
+		prvHostThreadBlocked();
+		pthread_mutex_unlock( &xTimeMutex );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortWaitForHostThreads( void )
+{
+	if( xVirtualTime != pdFALSE )
+	{
+		/* The interrupts are held off so this cannot be re-entered from a 
+		handler while the mutex is held. */
+		vPortEnterCritical();
+		pthread_mutex_lock( &xTimeMutex );
+		prvWaitForHostThreads();
+		pthread_mutex_unlock( &xTimeMutex );
+		vPortExitCritical();
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvHostThreadBlocked( void )
+{
+	if( __sync_sub_and_fetch( &ulHostThreadsBusy, 1UL ) == 0UL )
+	{
+		pthread_cond_broadcast( &xHostThreadsCondition );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvWaitForHostThreads( void )
+{
+	while( ulHostThreadsBusy != 0UL )
+	{
+		pthread_cond_wait( &xHostThreadsCondition, &xTimeMutex );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortWaitForInterrupt( void )
+{
+xSleeper *pxSleeper, **ppxSleeper;
+unsigned long ulNextTime;
+
+	if( xVirtualTime == pdFALSE )
+	{
+		/* Sleep until the next signal. */
+		pause();
+		return;
+	}
+
+	/* Every task is blocked, so nothing can happen until the clock moves or a 
+	host thread raises an interrupt.  The interrupts are held off while the
+	host threads run, and taken in one go once they have all blocked. */
+	vPortEnterCritical();
+	pthread_mutex_lock( &xTimeMutex );
+	prvWaitForHostThreads();
+
+	if( ulPendingInterrupts == 0UL )
+	{
+		/* Move the clock on to the next tick or the earliest wake time,
+		whichever comes first - but never back. */
+		ulNextTime = ulNextTickTime;
+		for( pxSleeper = pxSleepers; pxSleeper != NULL; pxSleeper = pxSleeper->pxNext )
+		{
+			if( ( long ) ( pxSleeper->ulWakeTime - ulNextTime ) < 0 )
+			{
+				ulNextTime = pxSleeper->ulWakeTime;
+			}
+		}
+		if( ( long ) ( ulNextTime - ulVirtualMicroseconds ) > 0 )
+		{
+			ulVirtualMicroseconds = ulNextTime;
+		}
+
+		if( ( long ) ( ulNextTickTime - ulVirtualMicroseconds ) <= 0 )
+		{
+			ulNextTickTime += portTICK_PERIOD_US;
+			__sync_fetch_and_or( &ulPendingInterrupts, 1UL << portINTERRUPT_TICK );
+		}
+
+		/* Wake the sleepers that are due one at a time, in the order they went
+		to sleep, so they never race each other. */
+		ppxSleeper = &pxSleepers;
+		while( *ppxSleeper != NULL )
+		{
+			pxSleeper = *ppxSleeper;
+			if( ( long ) ( pxSleeper->ulWakeTime - ulVirtualMicroseconds ) <= 0 )
+			{
+				*ppxSleeper = pxSleeper->pxNext;
+				pxSleeper->xWoken = pdTRUE;
+				__sync_fetch_and_add( &ulHostThreadsBusy, 1UL );
+				pthread_cond_broadcast( &xSleepCondition );
+				prvWaitForHostThreads();
+
+				/* The thread may have gone back to sleep, so start again. */
+				ppxSleeper = &pxSleepers;
+			}
+			else
+			{
+				ppxSleeper = &( pxSleeper->pxNext );
+			}
+		}
+	}
+
+	pthread_mutex_unlock( &xTimeMutex );
+
+	/* Taken here, by the idle task, as the critical section is left. */
+	if( ulPendingInterrupts != 0UL )
+	{
+		raise( portSIGNAL_INTERRUPT );
+	}
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+/* Build the signal set before main() runs, as critical sections can be used 
+while the tasks are being created. */
+static void prvInitialiseSignalSet( void ) __attribute__( ( constructor ) );
+static void prvInitialiseSignalSet( void )
+{
+	sigemptyset( &xInterruptSignals );
+	sigaddset( &xInterruptSignals, portSIGNAL_TICK );
+	sigaddset( &xInterruptSignals, portSIGNAL_INTERRUPT );
+}
@@ -0,0 +1,218 @@
+/*
+    FreeRTOS V7.0.1 - Copyright (C) 2011 Real Time Engineers Ltd.
+	
+
+    ***************************************************************************
+     *                                                                       *
+     *    FreeRTOS tutorial books are available in pdf and paperback.        *
+     *    Complete, revised, and edited pdf reference manuals are also       *
+     *    available.                                                         *
+     *                                                                       *
+     *    Purchasing FreeRTOS documentation will not only help you, by       *
+     *    ensuring you get running as quickly as possible and with an        *
+     *    in-depth knowledge of how to use FreeRTOS, it will also help       *
+     *    the FreeRTOS project to continue with its mission of providing     *
+     *    professional grade, cross platform, de facto standard solutions    *
+     *    for microcontrollers - completely free of charge!                  *
+     *                                                                       *
+     *    >>> See http://www.FreeRTOS.org/Documentation for details. <<<     *
+     *                                                                       *
+     *    Thank you for using FreeRTOS, and thank you for your support!      *
+     *                                                                       *
+    ***************************************************************************
+
+
+    This file is part of the FreeRTOS distribution.
+
+    FreeRTOS is free software; you can redistribute it and/or modify it under
+    the terms of the GNU General Public License (version 2) as published by the
+    Free Software Foundation AND MODIFIED BY the FreeRTOS exception.
+    >>>NOTE<<< The modification to the GPL is included to allow you to
+    distribute a combined work that includes FreeRTOS without being obliged to
+    provide the source code for proprietary components outside of the FreeRTOS
+    kernel.  FreeRTOS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+    more details. You should have received a copy of the GNU General Public
+    License and the FreeRTOS license exception along with FreeRTOS; if not it
+    can be viewed here: http://www.freertos.org/a00114.html and also obtained
+    by writing to Richard Barry, contact details for whom are available on the
+    FreeRTOS WEB site.
+
+    1 tab == 4 spaces!
+
+    http://www.FreeRTOS.org - Documentation, latest information, license and
+    contact details.
+
+    http://www.SafeRTOS.com - A version that is certified for use in safety
+    critical systems.
+
+    http://www.OpenRTOS.com - Commercial support, development, porting,
+    licensing and training services.
+*/
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Port specific definitions.  
+ *
+ * The settings in this file configure FreeRTOS correctly for a POSIX host
+ * (Linux, GCC, pthreads).  Each task runs in its own thread, only one of
+ * which is ever allowed to execute at a time.  Interrupts are simulated with
+ * signals, so "disabling interrupts" means blocking those signals in the 
+ * calling thread.
+ *
+ * These settings should not be altered.
+ *-----------------------------------------------------------
+ */
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	unsigned portLONG
+#define portBASE_TYPE	portLONG
+
+/* The tick count is kept at 32 bits, as it is on the target, so tick overflow
+behaves the same way on the host. */
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef unsigned portSHORT portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffff
+#else
+	typedef unsigned int portTickType;
+	#define portMAX_DELAY ( portTickType ) 0xffffffff
+#endif
+/*-----------------------------------------------------------*/	
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_RATE_MS			( ( portTickType ) 1000 / configTICK_RATE_HZ )		
+#define portBYTE_ALIGNMENT			8
+/*-----------------------------------------------------------*/	
+
+/* Scheduler utilities. */
+extern void vPortYield( void );
+extern void vPortYieldFromISR( void );
+
+#define portYIELD()					vPortYield()
+
+/* Only ever called from a simulated interrupt handler, so the switch is held
+pending until the handler completes - the same as setting PendSV on the CM3. */
+#define portEND_SWITCHING_ISR( xSwitchRequired ) if( xSwitchRequired ) vPortYieldFromISR()
+
+void vPortDeleteThread( void *pvTaskToDelete );
+#define traceTASK_DELETE( pxTCB )	vPortDeleteThread( pxTCB )
+/*-----------------------------------------------------------*/
+
+/* Critical section management. */
+extern void vPortDisableInterrupts( void );
+extern void vPortEnableInterrupts( void );
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+
+#define portDISABLE_INTERRUPTS()	vPortDisableInterrupts()
+#define portENABLE_INTERRUPTS()		vPortEnableInterrupts()
+#define portENTER_CRITICAL()		vPortEnterCritical()
+#define portEXIT_CRITICAL()			vPortExitCritical()
+/*-----------------------------------------------------------*/
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#define portNOP()
+/*-----------------------------------------------------------*/
+
+/* Simulated interrupt numbers.  The first two are used by the kernel itself,
+the rest are free for the host stand-ins of the target peripherals. */
+#define portINTERRUPT_YIELD				( 0UL )
+#define portINTERRUPT_TICK				( 1UL )
+
+/* 
+ * Raise a simulated interrupt.  This may be called from any thread, including
+ * host threads that are not running a task (for example a thread that models 
+ * the timing of a peripheral).  The handler runs in the context of whichever
+ * task is executing, as soon as that task is not in a critical section.  With
+ * virtual time it runs once every host thread has blocked (see below).
+ */
+void vPortGenerateSimulatedInterrupt( unsigned long ulInterruptNumber );
+
+/*
+ * Install an interrupt handler for a simulated interrupt.  The interrupt 
+ * number must be above those used by the kernel (0 and 1 as defined above) and
+ * lower than the number of bits in an unsigned long.
+ *
+ * Interrupt handler functions must return a non-zero value if executing the
+ * handler resulted in a task switch being required.  Handlers that end with
+ * portEND_SWITCHING_ISR() can simply return pdFALSE.
+ */
+void vPortSetInterruptHandler( unsigned long ulInterruptNumber, unsigned long (*pvHandler)( void ) );
+
+/*
+ * Returns a free running microsecond count taken from the host monotonic 
+ * clock.  Used by the host build as the run time stats counter and for
+ * benchmarking.  The count runs at the time scale (see below), or is the 
+ * virtual clock.
+ */
+unsigned long ulPortGetMicroseconds( void );
+
+/*
+ * Run the simulated clock ulScale times faster than the host clock: the tick
+ * interrupt comes ulScale times as often and ulPortGetMicroseconds() counts
+ * ulScale times as fast, so a simulated second takes 1/ulScale seconds.  Host
+ * threads that model peripheral timing should sleep with 
+ * vPortSleepMicroseconds().  Must be called before the scheduler is started.
+ */
+void vPortSetTimeScale( unsigned long ulScale );
+
+/*
+ * Run on a virtual clock instead of the host clock.  There is no tick timer:
+ * when every task is blocked the idle task's call to vPortWaitForInterrupt()
+ * moves the clock on to the next tick or to the next wake time of a host 
+ * thread in vPortSleepMicroseconds(), whichever is sooner.  The same inputs 
+ * then always give the same run, however busy the host is.  Host threads that
+ * model peripherals must tell the port when they are woken and when they 
+ * block other than in vPortSleepMicroseconds() (see below), as the clock only
+ * moves while they are all blocked.  The time scale is not used.  Must be 
+ * called before any host thread is started.
+ */
+void vPortSetVirtualTime( void );
+
+/*
+ * Sleep the calling (non task) thread for a number of simulated microseconds.
+ */
+void vPortSleepMicroseconds( unsigned long ulMicroseconds );
+
+/*
+ * For virtual time.  vPortHostThreadWake() is called just before a host thread
+ * is started, or is woken by anything but the clock (a task posting to a 
+ * semaphore, say), and may be called from an interrupt handler.  The host 
+ * thread calls vPortHostThreadWait() just before it blocks on anything but 
+ * vPortSleepMicroseconds().  vPortWaitForHostThreads() waits until every host
+ * thread has blocked, so a task that hands work to a host thread can wait for
+ * the result to be ready at the same time on the clock.  All three do nothing
+ * without virtual time.
+ */
+void vPortHostThreadWake( void );
+void vPortHostThreadWait( void );
+void vPortWaitForHostThreads( void );
+
+/*
+ * The host equivalent of __WFI(), for the idle hook: sleeps until the next 
+ * signal, or with virtual time moves the clock on as described above.
+ */
+void vPortWaitForInterrupt( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
+
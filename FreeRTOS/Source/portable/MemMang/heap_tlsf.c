@@ -0,0 +1,452 @@
+/*
+ * An implementation of pvPortMalloc() and vPortFree() that uses a two level
+ * segregated fit (TLSF) allocator, so that both take the same time whatever
+ * the state of the heap, and that combines a freed block with the free blocks
+ * either side of it straight away.
+ *
+ * Free blocks are kept in a list per size class.  The first level splits the
+ * sizes by powers of two, and the second level splits each power of two into
+ * heapSL_COUNT equal steps.  A bit is set in a bitmap for every list that is
+ * not empty, so finding a list with a block that is big enough is a couple of
+ * count leading zeros instructions rather than a walk along the free blocks.
+ *
+ * Every block starts with a header holding its size and a pointer to the
+ * block physically before it, so the neighbours of a freed block can be found
+ * without searching.  A zero sized block at the end of the heap stops the
+ * merge there.  The overhead is the same as heap_2.c (two pointers a block).
+ *
+ * As well as xPortGetFreeHeapSize() this provides
+ * xPortGetMinimumEverFreeHeapSize() and xPortGetLargestFreeBlock().  The
+ * price of not searching is that a request is only given a block from a class
+ * in which every block is big enough, so xPortGetLargestFreeBlock() reports
+ * the smallest size in the class of the largest free block.
+ *
+ * See heap_1.c, heap_2.c and heap_3.c for alternative implementations, and the
+ * memory management pages of http://www.FreeRTOS.org for more information.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/* Allocate the memory for the heap.  The struct is used to force byte
+alignment without using any non-portable code. */
+static union xRTOS_HEAP
+{
+	#if portBYTE_ALIGNMENT == 8
+		volatile portDOUBLE dDummy;
+	#else
+		volatile unsigned long ulDummy;
+	#endif
+	unsigned char ucHeap[ configTOTAL_HEAP_SIZE ];
+} xHeap;
+
+/* The header at the start of every block.  pxNextFree and pxPrevFree are only
+used while the block is free, so they sit in the memory that is handed out when
+it is not. */
+typedef struct TLSF_BLOCK
+{
+	struct TLSF_BLOCK *pxPrevPhysBlock;		/*<< The block before this one in memory (NULL for the first). */
+	size_t xBlockSize;						/*<< The size of the block, header included.  Bit 0 is set while it is free. */
+	struct TLSF_BLOCK *pxNextFree;			/*<< The next free block in the same size class. */
+	struct TLSF_BLOCK *pxPrevFree;			/*<< The previous free block in the same size class. */
+} xTLSFBlock;
+
+/* The header kept by a block in use - the free list links are not part of it. */
+#define heapHEADER_SIZE			( ( ( 2 * sizeof( void * ) ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+/* A free block must be able to hold the whole of xTLSFBlock. */
+#define heapMINIMUM_BLOCK_SIZE	( ( sizeof( xTLSFBlock ) + portBYTE_ALIGNMENT_MASK ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+#define heapBLOCK_FREE			( ( size_t ) 1 )
+#define heapSIZE_MASK			( ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) )
+
+/* Each power of two is split into 2^heapSL_COUNT_LOG2 size classes. */
+#define heapSL_COUNT_LOG2		3
+#define heapSL_COUNT			( 1 << heapSL_COUNT_LOG2 )
+/* Below 2^heapFL_SHIFT bytes the classes are portBYTE_ALIGNMENT apart and are
+all kept in first level 0. */
+#if portBYTE_ALIGNMENT == 8
+	#define heapALIGNMENT_LOG2	3
+#elif portBYTE_ALIGNMENT == 4
+	#define heapALIGNMENT_LOG2	2
+#else
+	#error heap_tlsf.c only supports a portBYTE_ALIGNMENT of 4 or 8
+#endif
+#define heapFL_SHIFT			( heapSL_COUNT_LOG2 + heapALIGNMENT_LOG2 )
+#define heapSMALL_BLOCK_SIZE	( ( size_t ) 1 << heapFL_SHIFT )
+/* Blocks up to 2^heapFL_MAX_LOG2 bytes can be kept, which is more RAM than the
+parts this is used on have. */
+#define heapFL_MAX_LOG2			17
+#define heapFL_COUNT			( heapFL_MAX_LOG2 - heapFL_SHIFT + 1 )
+
+/* A bit for each first level that has any free block in it, and for each of
+its second level lists that is not empty. */
+static unsigned long ulFLBitmap = 0UL;
+static unsigned long ulSLBitmap[ heapFL_COUNT ];
+static xTLSFBlock *pxFreeLists[ heapFL_COUNT ][ heapSL_COUNT ];
+
+/* Keeps track of the number of free bytes remaining, and the fewest there have
+ever been. */
+static size_t xFreeBytesRemaining = ( size_t ) 0;
+static size_t xMinimumEverFreeBytesRemaining = ( size_t ) 0;
+
+static portBASE_TYPE xHeapHasBeenInitialised = pdFALSE;
+
+/* Index of the highest and lowest bits set in a word that is not zero. */
+#ifdef __GNUC__
+	#define heapFLS( ulValue )	( 31 - __builtin_clz( ( unsigned int ) ( ulValue ) ) )
+	#define heapFFS( ulValue )	( __builtin_ctz( ( unsigned int ) ( ulValue ) ) )
+#else
+	static int prvFLS( unsigned long ulValue )
+	{
+	int iBit = 0;
+
+		while( ulValue >>= 1 )
+		{
+			iBit++;
+		}
+		return iBit;
+	}
+
+	static int prvFFS( unsigned long ulValue )
+	{
+	int iBit = 0;
+
+		while( ( ulValue & 1UL ) == 0UL )
+		{
+			ulValue >>= 1;
+			iBit++;
+		}
+		return iBit;
+	}
+
+	#define heapFLS( ulValue )	prvFLS( ulValue )
+	#define heapFFS( ulValue )	prvFFS( ulValue )
+#endif
+
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xBlockSize & heapSIZE_MASK )
+#define heapNEXT_BLOCK( pxBlock )	( ( xTLSFBlock * ) ( ( ( unsigned char * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/*
+ * The size class a block of xSize bytes is kept in.
+ */
+static void prvMappingInsert( size_t xSize, int *piFL, int *piSL );
+
+/*
+ * The first size class in which every block is at least xSize bytes.
+ */
+static void prvMappingSearch( size_t xSize, int *piFL, int *piSL );
+
+/*
+ * Add a free block to, or take it out of, the list for its size class.
+ */
+static void prvInsertFreeBlock( xTLSFBlock *pxBlock );
+static void prvRemoveFreeBlock( xTLSFBlock *pxBlock );
+
+/*
+ * Set up the heap as one free block followed by the end marker.
+ */
+static void prvHeapInit( void );
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, int *piFL, int *piSL )
+{
+int iFL;
+
+	if( xSize < heapSMALL_BLOCK_SIZE )
+	{
+		*piFL = 0;
+		*piSL = ( int ) ( xSize >> heapALIGNMENT_LOG2 );
+	}
+	else
+	{
+		iFL = heapFLS( xSize );
+		*piSL = ( int ) ( ( xSize >> ( iFL - heapSL_COUNT_LOG2 ) ) ^ ( ( size_t ) 1 << heapSL_COUNT_LOG2 ) );
+		*piFL = iFL - ( heapFL_SHIFT - 1 );
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingSearch( size_t xSize, int *piFL, int *piSL )
+{
+	if( xSize >= heapSMALL_BLOCK_SIZE )
+	{
+		/* Round up to the start of the next class so that any block found
+		there is big enough. */
+		xSize += ( ( size_t ) 1 << ( heapFLS( xSize ) - heapSL_COUNT_LOG2 ) ) - 1;
+	}
+	prvMappingInsert( xSize, piFL, piSL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( xTLSFBlock *pxBlock )
+{
+int iFL, iSL;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &iFL, &iSL );
+	pxBlock->pxPrevFree = NULL;
+	pxBlock->pxNextFree = pxFreeLists[ iFL ][ iSL ];
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock;
+	}
+	pxFreeLists[ iFL ][ iSL ] = pxBlock;
+	ulFLBitmap |= ( 1UL << iFL );
+	ulSLBitmap[ iFL ] |= ( 1UL << iSL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( xTLSFBlock *pxBlock )
+{
+int iFL, iSL;
+
+	prvMappingInsert( heapBLOCK_SIZE( pxBlock ), &iFL, &iSL );
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+	}
+	if( pxBlock->pxPrevFree != NULL )
+	{
+		pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+	}
+	else
+	{
+		pxFreeLists[ iFL ][ iSL ] = pxBlock->pxNextFree;
+		if( pxFreeLists[ iFL ][ iSL ] == NULL )
+		{
+			ulSLBitmap[ iFL ] &= ~( 1UL << iSL );
+			if( ulSLBitmap[ iFL ] == 0UL )
+			{
+				ulFLBitmap &= ~( 1UL << iFL );
+			}
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+xTLSFBlock *pxFirstBlock, *pxEnd;
+size_t xTotal;
+
+	/* The first level bitmap has a bit for each first level. */
+	configASSERT( heapFL_COUNT <= 32 );
+
+	xTotal = ( ( size_t ) configTOTAL_HEAP_SIZE ) & heapSIZE_MASK;
+	configASSERT( xTotal < ( ( size_t ) 1 << heapFL_MAX_LOG2 ) );
+
+	/* One free block covering all of the heap but the end marker (which is
+	given room for a whole xTLSFBlock, though only its header is used). */
+	pxFirstBlock = ( void * ) xHeap.ucHeap;
+	pxFirstBlock->pxPrevPhysBlock = NULL;
+	pxFirstBlock->xBlockSize = ( xTotal - heapMINIMUM_BLOCK_SIZE ) | heapBLOCK_FREE;
+
+	/* The end marker is never free, so nothing merges past it. */
+	pxEnd = heapNEXT_BLOCK( pxFirstBlock );
+	pxEnd->pxPrevPhysBlock = pxFirstBlock;
+	pxEnd->xBlockSize = ( size_t ) 0;
+
+	prvInsertFreeBlock( pxFirstBlock );
+	xFreeBytesRemaining = heapBLOCK_SIZE( pxFirstBlock );
+	xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+xTLSFBlock *pxBlock = NULL, *pxNewBlock;
+unsigned long ulMap;
+int iFL, iSL;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		/* If this is the first call to malloc then the heap will require
+		initialisation to setup the list of free blocks. */
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+			xHeapHasBeenInitialised = pdTRUE;
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize < configTOTAL_HEAP_SIZE ) )
+		{
+			/* The wanted size is increased so it can contain the header in
+			addition to the requested amount of bytes, and rounded up so that
+			blocks are always aligned to the required number of bytes. */
+			xWantedSize = ( xWantedSize + heapHEADER_SIZE + portBYTE_ALIGNMENT_MASK ) & heapSIZE_MASK;
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+
+			prvMappingSearch( xWantedSize, &iFL, &iSL );
+			if( iFL < heapFL_COUNT )
+			{
+				/* A list in the same first level at or above the class... */
+				ulMap = ulSLBitmap[ iFL ] & ( ~0UL << iSL );
+				if( ulMap == 0UL )
+				{
+					/* ...or else the smallest list of any larger first level. */
+					ulMap = ulFLBitmap & ( ~0UL << ( iFL + 1 ) );
+					if( ulMap != 0UL )
+					{
+						iFL = heapFFS( ulMap );
+						ulMap = ulSLBitmap[ iFL ];
+					}
+				}
+				if( ulMap != 0UL )
+				{
+					iSL = heapFFS( ulMap );
+					pxBlock = pxFreeLists[ iFL ][ iSL ];
+				}
+			}
+		}
+
+		if( pxBlock != NULL )
+		{
+			prvRemoveFreeBlock( pxBlock );
+
+			/* If the block is larger than required it can be split into two. */
+			if( ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+			{
+				pxNewBlock = ( void * ) ( ( ( unsigned char * ) pxBlock ) + xWantedSize );
+				pxNewBlock->xBlockSize = ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) | heapBLOCK_FREE;
+				pxNewBlock->pxPrevPhysBlock = pxBlock;
+				heapNEXT_BLOCK( pxNewBlock )->pxPrevPhysBlock = pxNewBlock;
+				pxBlock->xBlockSize = xWantedSize;
+				prvInsertFreeBlock( pxNewBlock );
+			}
+			else
+			{
+				pxBlock->xBlockSize = heapBLOCK_SIZE( pxBlock );
+			}
+
+			xFreeBytesRemaining -= pxBlock->xBlockSize;
+			if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+			{
+				xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+			}
+
+			/* Return the memory space - jumping over the header at its start. */
+			pvReturn = ( void * ) ( ( ( unsigned char * ) pxBlock ) + heapHEADER_SIZE );
+		}
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+unsigned char *puc = ( unsigned char * ) pv;
+xTLSFBlock *pxBlock, *pxNeighbour;
+
+	if( pv )
+	{
+		/* The memory being freed will have a header immediately before it. */
+		puc -= heapHEADER_SIZE;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxBlock = ( void * ) puc;
+
+		/* It must be a block from this heap that is in use. */
+		configASSERT( ( puc >= xHeap.ucHeap ) && ( puc < &( xHeap.ucHeap[ configTOTAL_HEAP_SIZE ] ) ) );
+		configASSERT( ( pxBlock->xBlockSize & heapBLOCK_FREE ) == 0 );
+
+		vTaskSuspendAll();
+		{
+			xFreeBytesRemaining += pxBlock->xBlockSize;
+
+			/* Merge with the block after it... */
+			pxNeighbour = heapNEXT_BLOCK( pxBlock );
+			if( pxNeighbour->xBlockSize & heapBLOCK_FREE )
+			{
+				prvRemoveFreeBlock( pxNeighbour );
+				pxBlock->xBlockSize += heapBLOCK_SIZE( pxNeighbour );
+			}
+
+			/* ...and the one before it. */
+			pxNeighbour = pxBlock->pxPrevPhysBlock;
+			if( ( pxNeighbour != NULL ) && ( pxNeighbour->xBlockSize & heapBLOCK_FREE ) )
+			{
+				prvRemoveFreeBlock( pxNeighbour );
+				pxNeighbour->xBlockSize = heapBLOCK_SIZE( pxNeighbour ) + pxBlock->xBlockSize;
+				pxBlock = pxNeighbour;
+			}
+
+			pxBlock->xBlockSize |= heapBLOCK_FREE;
+			heapNEXT_BLOCK( pxBlock )->pxPrevPhysBlock = pxBlock;
+			prvInsertFreeBlock( pxBlock );
+		}
+		xTaskResumeAll();
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetLargestFreeBlock( void )
+{
+size_t xLargest = 0;
+int iFL, iSL;
+
+	vTaskSuspendAll();
+	{
+		if( ulFLBitmap != 0UL )
+		{
+			/* pvPortMalloc() only takes a block from a class in which every
+			block is big enough, so the most it is sure to give is the smallest
+			size kept in the highest class that is not empty. */
+			iFL = heapFLS( ulFLBitmap );
+			iSL = heapFLS( ulSLBitmap[ iFL ] );
+			if( iFL == 0 )
+			{
+				xLargest = ( size_t ) iSL << heapALIGNMENT_LOG2;
+			}
+			else
+			{
+				xLargest = ( ( size_t ) ( heapSL_COUNT + iSL ) ) << ( iFL + heapFL_SHIFT - 1 - heapSL_COUNT_LOG2 );
+			}
+
+			/* Report what could be asked for, not the size with the header. */
+			xLargest -= heapHEADER_SIZE;
+		}
+	}
+	xTaskResumeAll();
+
+	return xLargest;
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
@@ -119,7 +119,26 @@ typedef struct QueueDefinition
 	signed portBASE_TYPE xRxLock;			/*< Stores the number of items received from the queue (removed from the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 	signed portBASE_TYPE xTxLock;			/*< Stores the number of items transmitted to the queue (added to the queue) while the queue was locked.  Set to queueUNLOCKED when the queue is not locked. */
 
+	#if ( configUSE_QUEUE_SETS == 1 )
+		struct QueueDefinition *pxQueueSetContainer;	/*< The set the queue is a member of, or NULL. */
+	#endif
+
+	#if ( configUSE_TRACE_FACILITY == 1 )
+		unsigned char ucQueueNumber;		/*< Set by the trace macros to identify the queue in a trace. */
+	#endif
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< Set to pdTRUE if the memory was given by xQueueCreateStatic(), so is not freed by vQueueDelete(). */
+	#endif
+
 } xQUEUE;
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* xStaticQueue has to be kept the same size as xQUEUE.  configASSERT() is not
+	defined in every build, so the check is made here, where it fails to compile
+	if the sizes differ. */
+	typedef char xStaticQueueSizeCheck[ ( sizeof( xStaticQueue ) == sizeof( xQUEUE ) ) ? 1 : -1 ];
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -135,6 +154,7 @@ typedef xQUEUE * xQueueHandle;
  * functions are documented in the API header file.
  */
 xQueueHandle xQueueCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize ) PRIVILEGED_FUNCTION;
+xQueueHandle xQueueCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxStaticQueue ) PRIVILEGED_FUNCTION;
 signed portBASE_TYPE xQueueGenericSend( xQueueHandle xQueue, const void * const pvItemToQueue, portTickType xTicksToWait, portBASE_TYPE xCopyPosition ) PRIVILEGED_FUNCTION;
 unsigned portBASE_TYPE uxQueueMessagesWaiting( const xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 void vQueueDelete( xQueueHandle xQueue ) PRIVILEGED_FUNCTION;
@@ -152,6 +172,14 @@ signed portBASE_TYPE xQueueIsQueueFullFromISR( const xQueueHandle pxQueue ) PRIV
 unsigned portBASE_TYPE uxQueueMessagesWaitingFromISR( const xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_QUEUE_SETS == 1 )
+	xQueueHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength ) PRIVILEGED_FUNCTION;
+	portBASE_TYPE xQueueAddToSet( xQueueHandle xQueueOrSemaphore, xQueueHandle xQueueSet ) PRIVILEGED_FUNCTION;
+	portBASE_TYPE xQueueRemoveFromSet( xQueueHandle xQueueOrSemaphore, xQueueHandle xQueueSet ) PRIVILEGED_FUNCTION;
+	xQueueHandle xQueueSelectFromSet( xQueueHandle xQueueSet, portTickType xBlockTimeTicks ) PRIVILEGED_FUNCTION;
+	xQueueHandle xQueueSelectFromSetFromISR( xQueueHandle xQueueSet ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * Co-routine queue functions differ from task queue functions.  Co-routines are
  * an optional component.
@@ -219,10 +247,27 @@ static signed portBASE_TYPE prvIsQueueFull( const xQueueHandle pxQueue ) PRIVILE
  */
 static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, portBASE_TYPE xPosition ) PRIVILEGED_FUNCTION;
 
+/*
+ * Set up the members of a queue whose storage area (pcHead) has already been
+ * found.
+ */
+static void prvInitialiseNewQueue( xQUEUE *pxNewQueue, unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize ) PRIVILEGED_FUNCTION;
+
 /*
  * Copies an item out of a queue.
  */
 static void prvCopyDataFromQueue( xQUEUE * const pxQueue, const void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+#if ( configUSE_QUEUE_SETS == 1 )
+	/*
+	 * Posts the handle of pxQueue to the set it is a member of, after an item
+	 * has been added to pxQueue.  Must be called with interrupts masked.
+	 *
+	 * @return pdTRUE if a task blocked on the set was unblocked and has a
+	 * priority at least that of the calling task.
+	 */
+	static portBASE_TYPE prvNotifyQueueSetContainer( const xQUEUE * const pxQueue, portBASE_TYPE xCopyPosition ) PRIVILEGED_FUNCTION;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -268,20 +313,13 @@ xQueueHandle xReturn = NULL;
 			pxNewQueue->pcHead = ( signed char * ) pvPortMalloc( xQueueSizeInBytes );
 			if( pxNewQueue->pcHead != NULL )
 			{
-				/* Initialise the queue members as described above where the
-				queue type is defined. */
-				pxNewQueue->pcTail = pxNewQueue->pcHead + ( uxQueueLength * uxItemSize );
-				pxNewQueue->uxMessagesWaiting = ( unsigned portBASE_TYPE ) 0U;
-				pxNewQueue->pcWriteTo = pxNewQueue->pcHead;
-				pxNewQueue->pcReadFrom = pxNewQueue->pcHead + ( ( uxQueueLength - ( unsigned portBASE_TYPE ) 1U ) * uxItemSize );
-				pxNewQueue->uxLength = uxQueueLength;
-				pxNewQueue->uxItemSize = uxItemSize;
-				pxNewQueue->xRxLock = queueUNLOCKED;
-				pxNewQueue->xTxLock = queueUNLOCKED;
-
-				/* Likewise ensure the event queues start with the correct state. */
-				vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
-				vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+				prvInitialiseNewQueue( pxNewQueue, uxQueueLength, uxItemSize );
+
+				#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+				{
+					pxNewQueue->ucStaticallyAllocated = pdFALSE;
+				}
+				#endif
 
 				traceQUEUE_CREATE( pxNewQueue );
 				xReturn = pxNewQueue;
@@ -300,6 +338,73 @@ xQueueHandle xReturn = NULL;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xQueueHandle xQueueCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxStaticQueue )
+	{
+	xQUEUE *pxNewQueue;
+	xQueueHandle xReturn = NULL;
+
+		configASSERT( pxStaticQueue );
+
+		/* There must be storage if, and only if, the items have a size. */
+		configASSERT( ( uxItemSize == ( unsigned portBASE_TYPE ) 0 ) == ( pucQueueStorage == NULL ) );
+
+		if( uxQueueLength > ( unsigned portBASE_TYPE ) 0 )
+		{
+			pxNewQueue = ( xQUEUE * ) pxStaticQueue;
+
+			/* A NULL pcHead marks a mutex, so a semaphore points it at the
+			queue structure instead - nothing is ever copied through it. */
+			if( uxItemSize == ( unsigned portBASE_TYPE ) 0 )
+			{
+				pxNewQueue->pcHead = ( signed char * ) pxNewQueue;
+			}
+			else
+			{
+				pxNewQueue->pcHead = ( signed char * ) pucQueueStorage;
+			}
+
+			prvInitialiseNewQueue( pxNewQueue, uxQueueLength, uxItemSize );
+			pxNewQueue->ucStaticallyAllocated = pdTRUE;
+
+			traceQUEUE_CREATE( pxNewQueue );
+			xReturn = pxNewQueue;
+		}
+
+		configASSERT( xReturn );
+
+		return xReturn;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewQueue( xQUEUE *pxNewQueue, unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize )
+{
+	/* Initialise the queue members as described above where the queue type
+	is defined. */
+	pxNewQueue->pcTail = pxNewQueue->pcHead + ( uxQueueLength * uxItemSize );
+	pxNewQueue->uxMessagesWaiting = ( unsigned portBASE_TYPE ) 0U;
+	pxNewQueue->pcWriteTo = pxNewQueue->pcHead;
+	pxNewQueue->pcReadFrom = pxNewQueue->pcHead + ( ( uxQueueLength - ( unsigned portBASE_TYPE ) 1U ) * uxItemSize );
+	pxNewQueue->uxLength = uxQueueLength;
+	pxNewQueue->uxItemSize = uxItemSize;
+	pxNewQueue->xRxLock = queueUNLOCKED;
+	pxNewQueue->xTxLock = queueUNLOCKED;
+
+	#if ( configUSE_QUEUE_SETS == 1 )
+	{
+		pxNewQueue->pxQueueSetContainer = NULL;
+	}
+	#endif
+
+	/* Likewise ensure the event queues start with the correct state. */
+	vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
+	vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
+}
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_MUTEXES == 1 )
 
 	xQueueHandle xQueueCreateMutex( void )
@@ -332,6 +437,12 @@ xQueueHandle xReturn = NULL;
 			vListInitialise( &( pxNewQueue->xTasksWaitingToSend ) );
 			vListInitialise( &( pxNewQueue->xTasksWaitingToReceive ) );
 
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				pxNewQueue->ucStaticallyAllocated = pdFALSE;
+			}
+			#endif
+
 			/* Start with the semaphore in the expected state. */
 			xQueueGenericSend( pxNewQueue, NULL, ( portTickType ) 0U, queueSEND_TO_BACK );
 
@@ -486,6 +597,19 @@ xTimeOutType xTimeOut;
 				traceQUEUE_SEND( pxQueue );
 				prvCopyDataToQueue( pxQueue, pvItemToQueue, xCopyPosition );
 
+				/* A member of a set wakes the task blocked on the set, not a
+				task blocked on the queue itself. */
+				#if ( configUSE_QUEUE_SETS == 1 )
+					if( pxQueue->pxQueueSetContainer != NULL )
+					{
+						if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) != pdFALSE )
+						{
+							portYIELD_WITHIN_API();
+						}
+					}
+					else
+				#endif
+
 				/* If there was a task waiting for data to arrive on the
 				queue then unblock it now. */
 				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
@@ -815,6 +939,16 @@ unsigned portBASE_TYPE uxSavedInterruptStatus;
 			be done when the queue is unlocked later. */
 			if( pxQueue->xTxLock == queueUNLOCKED )
 			{
+				#if ( configUSE_QUEUE_SETS == 1 )
+					if( pxQueue->pxQueueSetContainer != NULL )
+					{
+						if( prvNotifyQueueSetContainer( pxQueue, xCopyPosition ) != pdFALSE )
+						{
+							*pxHigherPriorityTaskWoken = pdTRUE;
+						}
+					}
+					else
+				#endif
 				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
 				{
 					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
@@ -1083,8 +1217,16 @@ void vQueueDelete( xQueueHandle pxQueue )
 
 	traceQUEUE_DELETE( pxQueue );
 	vQueueUnregisterQueue( pxQueue );
-	vPortFree( pxQueue->pcHead );
-	vPortFree( pxQueue );
+
+	/* The memory of a queue created by xQueueCreateStatic() belongs to the
+	application. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		if( pxQueue->ucStaticallyAllocated == pdFALSE )
+	#endif
+	{
+		vPortFree( pxQueue->pcHead );
+		vPortFree( pxQueue );
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -1153,6 +1295,21 @@ static void prvUnlockQueue( xQueueHandle pxQueue )
 		/* See if data was added to the queue while it was locked. */
 		while( pxQueue->xTxLock > queueLOCKED_UNMODIFIED )
 		{
+			/* The set of a member is told about each item posted while the
+			member was locked, whether or not a task is waiting. */
+			#if ( configUSE_QUEUE_SETS == 1 )
+				if( pxQueue->pxQueueSetContainer != NULL )
+				{
+					if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
+					{
+						vTaskMissedYield();
+					}
+
+					--( pxQueue->xTxLock );
+				}
+				else
+			#endif
+
 			/* Data was posted while the queue was locked.  Are any tasks
 			blocked waiting for data to become available? */
 			if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
@@ -1508,6 +1665,166 @@ signed portBASE_TYPE xReturn;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	xQueueHandle xQueueCreateSet( unsigned portBASE_TYPE uxEventQueueLength )
+	{
+		/* A set is a queue of the handles of its members that have had an
+		item added. */
+		return xQueueCreate( uxEventQueueLength, sizeof( xQUEUE * ) );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	portBASE_TYPE xQueueAddToSet( xQueueHandle xQueueOrSemaphore, xQueueHandle xQueueSet )
+	{
+	portBASE_TYPE xReturn;
+
+		configASSERT( xQueueOrSemaphore );
+		configASSERT( xQueueSet );
+
+		taskENTER_CRITICAL();
+		{
+			if( xQueueOrSemaphore->pxQueueSetContainer != NULL )
+			{
+				/* A queue can only be in one set. */
+				xReturn = pdFAIL;
+			}
+			else if( xQueueOrSemaphore->uxMessagesWaiting != ( unsigned portBASE_TYPE ) 0 )
+			{
+				/* The set would not know about the items already in the
+				queue. */
+				xReturn = pdFAIL;
+			}
+			else if( xQueueOrSemaphore->uxQueueType == queueQUEUE_IS_MUTEX )
+			{
+				/* Giving a mutex has to wake the task blocked on it, so it
+				cannot be in a set. */
+				xReturn = pdFAIL;
+			}
+			else
+			{
+				xQueueOrSemaphore->pxQueueSetContainer = xQueueSet;
+				xReturn = pdPASS;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	portBASE_TYPE xQueueRemoveFromSet( xQueueHandle xQueueOrSemaphore, xQueueHandle xQueueSet )
+	{
+	portBASE_TYPE xReturn;
+
+		configASSERT( xQueueOrSemaphore );
+
+		taskENTER_CRITICAL();
+		{
+			if( xQueueOrSemaphore->pxQueueSetContainer != xQueueSet )
+			{
+				/* The queue was not a member of the set. */
+				xReturn = pdFAIL;
+			}
+			else if( xQueueOrSemaphore->uxMessagesWaiting != ( unsigned portBASE_TYPE ) 0 )
+			{
+				/* The set still holds the handle of the queue for each item
+				in it. */
+				xReturn = pdFAIL;
+			}
+			else
+			{
+				xQueueOrSemaphore->pxQueueSetContainer = NULL;
+				xReturn = pdPASS;
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	xQueueHandle xQueueSelectFromSet( xQueueHandle xQueueSet, portTickType xBlockTimeTicks )
+	{
+	xQueueHandle xReturn = NULL;
+
+		( void ) xQueueGenericReceive( xQueueSet, &xReturn, xBlockTimeTicks, pdFALSE );
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	xQueueHandle xQueueSelectFromSetFromISR( xQueueHandle xQueueSet )
+	{
+	xQueueHandle xReturn = NULL;
+	signed portBASE_TYPE xTaskWoken = pdFALSE;
+
+		/* Taking an item out of a set never unblocks a task, as nothing
+		blocks sending to a set. */
+		( void ) xQueueReceiveFromISR( xQueueSet, &xReturn, &xTaskWoken );
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_QUEUE_SETS == 1 )
+
+	static portBASE_TYPE prvNotifyQueueSetContainer( const xQUEUE * const pxQueue, portBASE_TYPE xCopyPosition )
+	{
+	xQUEUE *pxQueueSetContainer = pxQueue->pxQueueSetContainer;
+	portBASE_TYPE xReturn = pdFALSE;
+
+		configASSERT( pxQueueSetContainer );
+
+		/* The set is made at least as long as all of its members together,
+		so there is always room for the handle. */
+		configASSERT( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength );
+
+		if( pxQueueSetContainer->uxMessagesWaiting < pxQueueSetContainer->uxLength )
+		{
+			traceQUEUE_SEND( pxQueueSetContainer );
+			prvCopyDataToQueue( pxQueueSetContainer, &pxQueue, xCopyPosition );
+
+			if( pxQueueSetContainer->xTxLock == queueUNLOCKED )
+			{
+				if( listLIST_IS_EMPTY( &( pxQueueSetContainer->xTasksWaitingToReceive ) ) == pdFALSE )
+				{
+					if( xTaskRemoveFromEventList( &( pxQueueSetContainer->xTasksWaitingToReceive ) ) != pdFALSE )
+					{
+						xReturn = pdTRUE;
+					}
+				}
+			}
+			else
+			{
+				/* The task blocking on the set will see this when it unlocks
+				the set. */
+				++( pxQueueSetContainer->xTxLock );
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if configUSE_TIMERS == 1
 
 	void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait )
@@ -79,6 +79,13 @@ task.h is included from an application file. */
  */
 #define tskIDLE_STACK_SIZE	configMINIMAL_STACK_SIZE
 
+/*
+ * Values for the ucNotifyState member of the TCB.
+ */
+#define taskNOT_WAITING_NOTIFICATION	( ( unsigned char ) 0 )
+#define taskWAITING_NOTIFICATION		( ( unsigned char ) 1 )
+#define taskNOTIFIED					( ( unsigned char ) 2 )
+
 /*
  * Task control block.  A task control block (TCB) is allocated to each task,
  * and stores the context of the task.
@@ -121,8 +128,24 @@ typedef struct tskTaskControlBlock
 		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
 	#endif
 
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned long ulNotifiedValue;	/*< Count of notifications given to the task and not yet taken. */
+		volatile unsigned char ucNotifyState;	/*< One of the taskNOT_WAITING_NOTIFICATION, taskWAITING_NOTIFICATION or taskNOTIFIED values. */
+	#endif
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< Set to pdTRUE if the TCB and stack were given by xTaskCreateStatic(), so are not freed when the task is deleted. */
+	#endif
+
 } tskTCB;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* xStaticTask has to be kept the same size as the TCB.  configASSERT() is not
+	defined in every build, so the check is made here, where it fails to compile
+	if the sizes differ. */
+	typedef char xStaticTaskSizeCheck[ ( sizeof( xStaticTask ) == sizeof( tskTCB ) ) ? 1 : -1 ];
+#endif
+
 
 /*
  * Some kernel aware debuggers require data to be viewed to be global, rather
@@ -161,6 +184,8 @@ PRIVILEGED_DATA static xList xPendingReadyList;							/*< Tasks that have been r
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxCurrentNumberOfTasks 	= ( unsigned portBASE_TYPE ) 0;
 PRIVILEGED_DATA static volatile portTickType xTickCount 						= ( portTickType ) 0;
 PRIVILEGED_DATA static unsigned portBASE_TYPE uxTopUsedPriority	 				= tskIDLE_PRIORITY;
+/* The highest priority with a ready task, or with port optimised task selection
+a bitmap of the priorities with ready tasks. */
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxTopReadyPriority 		= tskIDLE_PRIORITY;
 PRIVILEGED_DATA static volatile signed portBASE_TYPE xSchedulerRunning 			= pdFALSE;
 PRIVILEGED_DATA static volatile unsigned portBASE_TYPE uxSchedulerSuspended	 	= ( unsigned portBASE_TYPE ) pdFALSE;
@@ -248,6 +273,68 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
 #endif
 /*-----------------------------------------------------------*/
 
+/*
+ * Keeping track of which priorities have ready tasks, and picking the next task
+ * to run.
+ *
+ * taskRECORD_READY_PRIORITY() is used when a task is added to a ready list and
+ * taskRESET_READY_PRIORITY() when a task that may have been in a ready list is
+ * taken out of it.  taskSELECT_HIGHEST_PRIORITY_TASK() sets pxCurrentTCB.
+ */
+#if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
+
+	/* uxTopReadyPriority is the highest priority that may have a ready task;
+	the selection searches down from it for a ready list that is not empty. */
+	#define taskRECORD_READY_PRIORITY( uxPriority )														\
+	{																									\
+		if( ( uxPriority ) > uxTopReadyPriority )														\
+		{																								\
+			uxTopReadyPriority = ( uxPriority );														\
+		}																								\
+	}
+
+	#define taskRESET_READY_PRIORITY( uxPriority )
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()															\
+	{																									\
+		/* Find the highest priority queue that contains ready tasks. */								\
+		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )						\
+		{																								\
+			configASSERT( uxTopReadyPriority );															\
+			--uxTopReadyPriority;																		\
+		}																								\
+																										\
+		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the						\
+		same priority get an equal share of the processor time. */										\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );		\
+	}
+
+#else
+
+	/* uxTopReadyPriority has a bit set for each priority whose ready list is
+	not empty, and the port finds the highest of them. */
+	#define taskRECORD_READY_PRIORITY( uxPriority ) portRECORD_READY_PRIORITY( ( uxPriority ), uxTopReadyPriority )
+
+	#define taskRESET_READY_PRIORITY( uxPriority )															\
+	{																										\
+		if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ ( uxPriority ) ] ) ) == ( unsigned portBASE_TYPE ) 0 )	\
+		{																									\
+			portRESET_READY_PRIORITY( ( uxPriority ), uxTopReadyPriority );									\
+		}																									\
+	}
+
+	#define taskSELECT_HIGHEST_PRIORITY_TASK()															\
+	{																									\
+	unsigned portBASE_TYPE uxTopPriority;																\
+																										\
+		portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );									\
+		configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 );			\
+		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );			\
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready queue for
  * the task.  It is inserted at the end of the list.  One quirk of this is
@@ -256,10 +343,8 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
  * executing task has been rescheduled.
  */
 #define prvAddTaskToReadyQueue( pxTCB )																					\
-	if( ( pxTCB )->uxPriority > uxTopReadyPriority )																	\
-	{																													\
-		uxTopReadyPriority = ( pxTCB )->uxPriority;																		\
-	}																													\
+	traceMOVED_TASK_TO_READY_STATE( pxTCB );																		\
+	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );																\
 	vListInsertEnd( ( xList * ) &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xGenericListItem ) )
 /*-----------------------------------------------------------*/
 
@@ -391,9 +476,15 @@ static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake ) PRIVILEGE
 
 /*
  * Allocates memory from the heap for a TCB and associated stack.  Checks the
- * allocation was successful.
+ * allocation was successful.  If pxTaskBuffer is not NULL it is used as the
+ * TCB and puxStackBuffer as the stack, and nothing is allocated.
  */
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer ) PRIVILEGED_FUNCTION;
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Does the work of xTaskGenericCreate() and xTaskCreateStatic().
+ */
+static signed portBASE_TYPE prvTaskCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, xStaticTask *pxTaskBuffer ) PRIVILEGED_FUNCTION;
 
 /*
  * Called from vTaskList.  vListTasks details all the tasks currently under
@@ -431,6 +522,25 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
  *----------------------------------------------------------*/
 
 signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions )
+{
+	return prvTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, xRegions, NULL );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	signed portBASE_TYPE xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer )
+	{
+		configASSERT( puxStackBuffer );
+		configASSERT( pxTaskBuffer );
+
+		return prvTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, NULL, pxTaskBuffer );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+static signed portBASE_TYPE prvTaskCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, xStaticTask *pxTaskBuffer )
 {
 signed portBASE_TYPE xReturn;
 tskTCB * pxNewTCB;
@@ -440,7 +550,7 @@ tskTCB * pxNewTCB;
 
 	/* Allocate the memory required by the TCB and stack for the new task,
 	checking that the allocation was successful. */
-	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer );
+	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer, pxTaskBuffer );
 
 	if( pxNewTCB != NULL )
 	{
@@ -615,6 +725,7 @@ tskTCB * pxNewTCB;
 			the termination list and free up any memory allocated by the
 			scheduler for the TCB and stack. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer )
@@ -707,6 +818,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 		}
@@ -753,6 +865,7 @@ tskTCB * pxNewTCB;
 				ourselves to the blocked list as the same list item is used for
 				both lists. */
 				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 				prvAddCurrentTaskToDelayedList( xTimeToWake );
 			}
 			xAlreadyYielded = xTaskResumeAll();
@@ -884,6 +997,7 @@ tskTCB * pxNewTCB;
 					it to it's new ready list.  As we are in a critical section we
 					can do this even if the scheduler is suspended. */
 					vListRemove( &( pxTCB->xGenericListItem ) );
+					taskRESET_READY_PRIORITY( uxCurrentPriority );
 					prvAddTaskToReadyQueue( pxTCB );
 				}
 
@@ -921,6 +1035,7 @@ tskTCB * pxNewTCB;
 
 			/* Remove task from the ready/delayed list and place in the	suspended list. */
 			vListRemove( &( pxTCB->xGenericListItem ) );
+			taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 			/* Is the task waiting on an event also? */
 			if( pxTCB->xEventListItem.pvContainer )
@@ -1714,16 +1829,7 @@ void vTaskSwitchContext( void )
 		taskFIRST_CHECK_FOR_STACK_OVERFLOW();
 		taskSECOND_CHECK_FOR_STACK_OVERFLOW();
 	
-		/* Find the highest priority queue that contains ready tasks. */
-		while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopReadyPriority ] ) ) )
-		{
-			configASSERT( uxTopReadyPriority );
-			--uxTopReadyPriority;
-		}
-	
-		/* listGET_OWNER_OF_NEXT_ENTRY walks through the list, so the tasks of the
-		same priority get an equal share of the processor time. */
-		listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopReadyPriority ] ) );
+		taskSELECT_HIGHEST_PRIORITY_TASK();
 	
 		traceTASK_SWITCHED_IN();
 		vWriteTraceToBuffer();
@@ -1749,6 +1855,7 @@ portTickType xTimeToWake;
 	to the blocked list as the same list item is used for both lists.  We have
 	exclusive access to the ready lists as the scheduler is locked. */
 	vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+	taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 
 	#if ( INCLUDE_vTaskSuspend == 1 )
@@ -1803,6 +1910,7 @@ portTickType xTimeToWake;
 		blocked list as the same list item is used for both lists.  This
 		function is called form a critical section. */
 		vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+		taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
 
 		/* Calculate the time at which the task should be woken if the event does
 		not occur.  This may overflow but this doesn't matter. */
@@ -2053,6 +2161,13 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	}
 	#endif
 
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	{
+		pxTCB->ulNotifiedValue = 0UL;
+		pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+	}
+	#endif
+
 	#if ( portUSING_MPU_WRAPPERS == 1 )
 	{
 		vPortStoreTaskMPUSettings( &( pxTCB->xMPUSettings ), xRegions, pxTCB->pxStack, usStackDepth );
@@ -2178,34 +2293,61 @@ static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 }
 /*-----------------------------------------------------------*/
 
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer )
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer )
 {
-tskTCB *pxNewTCB;
+tskTCB *pxNewTCB = NULL;
 
-	/* Allocate space for the TCB.  Where the memory comes from depends on
-	the implementation of the port malloc function. */
-	pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
-
-	if( pxNewTCB != NULL )
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
 	{
-		/* Allocate space for the stack used by the task being created.
-		The base of the stack memory stored in the TCB so the task can
-		be deleted later if required. */
-		pxNewTCB->pxStack = ( portSTACK_TYPE * ) pvPortMallocAligned( ( ( ( size_t )usStackDepth ) * sizeof( portSTACK_TYPE ) ), puxStackBuffer );
-
-		if( pxNewTCB->pxStack == NULL )
+		if( pxTaskBuffer != NULL )
 		{
-			/* Could not allocate the stack.  Delete the allocated TCB. */
-			vPortFree( pxNewTCB );
-			pxNewTCB = NULL;
+			/* The caller has provided both the TCB and the stack. */
+			pxNewTCB = ( tskTCB * ) pxTaskBuffer;
+			pxNewTCB->pxStack = puxStackBuffer;
+			pxNewTCB->ucStaticallyAllocated = pdTRUE;
 		}
-		else
+	}
+	#else
+	{
+		/* Only used when static allocation is provided. */
+		( void ) pxTaskBuffer;
+	}
+	#endif
+
+	if( pxNewTCB == NULL )
+	{
+		/* Allocate space for the TCB.  Where the memory comes from depends on
+		the implementation of the port malloc function. */
+		pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
+
+		if( pxNewTCB != NULL )
 		{
-			/* Just to help debugging. */
-			memset( pxNewTCB->pxStack, tskSTACK_FILL_BYTE, usStackDepth * sizeof( portSTACK_TYPE ) );
+			/* Allocate space for the stack used by the task being created.
+			The base of the stack memory stored in the TCB so the task can
+			be deleted later if required. */
+			pxNewTCB->pxStack = ( portSTACK_TYPE * ) pvPortMallocAligned( ( ( ( size_t )usStackDepth ) * sizeof( portSTACK_TYPE ) ), puxStackBuffer );
+
+			if( pxNewTCB->pxStack == NULL )
+			{
+				/* Could not allocate the stack.  Delete the allocated TCB. */
+				vPortFree( pxNewTCB );
+				pxNewTCB = NULL;
+			}
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			else
+			{
+				pxNewTCB->ucStaticallyAllocated = pdFALSE;
+			}
+			#endif
 		}
 	}
 
+	if( pxNewTCB != NULL )
+	{
+		/* Just to help debugging. */
+		memset( pxNewTCB->pxStack, tskSTACK_FILL_BYTE, usStackDepth * sizeof( portSTACK_TYPE ) );
+	}
+
 	return pxNewTCB;
 }
 /*-----------------------------------------------------------*/
@@ -2365,9 +2507,16 @@ tskTCB *pxNewTCB;
 	static void prvDeleteTCB( tskTCB *pxTCB )
 	{
 		/* Free up the memory allocated by the scheduler for the task.  It is up to
-		the task to free any memory allocated at the application level. */
-		vPortFreeAligned( pxTCB->pxStack );
-		vPortFree( pxTCB );
+		the task to free any memory allocated at the application level.  The
+		memory of a task created by xTaskCreateStatic() belongs to the
+		application too. */
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			if( pxTCB->ucStaticallyAllocated == pdFALSE )
+		#endif
+		{
+			vPortFreeAligned( pxTCB->pxStack );
+			vPortFree( pxTCB );
+		}
 	}
 
 #endif
@@ -2439,6 +2588,7 @@ tskTCB *pxNewTCB;
 			if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xGenericListItem ) ) )
 			{
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Inherit the priority before being moved into the new list. */
 				pxTCB->uxPriority = pxCurrentTCB->uxPriority;
@@ -2468,6 +2618,7 @@ tskTCB *pxNewTCB;
 				/* We must be the running task to be able to give the mutex back.
 				Remove ourselves from the ready list we currently appear in. */
 				vListRemove( &( pxTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxTCB->uxPriority );
 
 				/* Disinherit the priority before adding ourselves into the new
 				ready list. */
@@ -2517,6 +2668,136 @@ void vTaskExitCritical( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
 
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	unsigned long ulReturn;
+	portBASE_TYPE xBlocked = pdFALSE;
+	signed portBASE_TYPE xAlreadyYielded;
 
+		vTaskSuspendAll();
+		{
+			/* The count is checked with interrupts masked.  A notification given
+			from an interrupt after that finds the task waiting and the scheduler
+			suspended, so the task is placed in xPendingReadyList and
+			xTaskResumeAll() below moves it straight back to its ready list. */
+			taskENTER_CRITICAL();
+			{
+				if( ( pxCurrentTCB->ulNotifiedValue == 0UL ) && ( xTicksToWait > ( portTickType ) 0 ) )
+				{
+					pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+					xBlocked = pdTRUE;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			if( xBlocked != pdFALSE )
+			{
+				traceTASK_NOTIFY_TAKE_BLOCK();
+
+				/* We must remove ourselves from the ready list before adding
+				ourselves to the blocked list as the same list item is used for
+				both lists. */
+				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+				taskRESET_READY_PRIORITY( pxCurrentTCB->uxPriority );
+
+				#if ( INCLUDE_vTaskSuspend == 1 )
+				{
+					if( xTicksToWait == portMAX_DELAY )
+					{
+						/* Block indefinitely - only a notification wakes the task. */
+						vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+					}
+					else
+					{
+						prvAddCurrentTaskToDelayedList( xTickCount + xTicksToWait );
+					}
+				}
+				#else
+				{
+					prvAddCurrentTaskToDelayedList( xTickCount + xTicksToWait );
+				}
+				#endif
+			}
+		}
+		xAlreadyYielded = xTaskResumeAll();
+
+		if( ( xBlocked != pdFALSE ) && ( xAlreadyYielded == pdFALSE ) )
+		{
+			portYIELD_WITHIN_API();
+		}
+
+		/* Either notified or timed out. */
+		taskENTER_CRITICAL();
+		{
+			traceTASK_NOTIFY_TAKE();
+			ulReturn = pxCurrentTCB->ulNotifiedValue;
+
+			if( ulReturn != 0UL )
+			{
+				if( xClearCountOnExit != pdFALSE )
+				{
+					pxCurrentTCB->ulNotifiedValue = 0UL;
+				}
+				else
+				{
+					pxCurrentTCB->ulNotifiedValue = ulReturn - 1UL;
+				}
+			}
+
+			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB *pxTCB;
+	unsigned char ucOriginalState;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			traceTASK_NOTIFY_GIVE_FROM_ISR( pxTCB );
+			ucOriginalState = pxTCB->ucNotifyState;
+			pxTCB->ucNotifyState = taskNOTIFIED;
+			( pxTCB->ulNotifiedValue )++;
+
+			/* Only a task blocked in ulTaskNotifyTake() needs to be moved. */
+			if( ucOriginalState == taskWAITING_NOTIFICATION )
+			{
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					prvAddTaskToReadyQueue( pxTCB );
+				}
+				else
+				{
+					/* We cannot access the delayed or ready lists, so will hold
+					this task pending until the scheduler is resumed. */
+					vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+				}
+
+				if( ( pxTCB->uxPriority >= pxCurrentTCB->uxPriority ) && ( pxHigherPriorityTaskWoken != NULL ) )
+				{
+					*pxHigherPriorityTaskWoken = pdTRUE;
+				}
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
 
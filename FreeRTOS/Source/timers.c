@@ -78,6 +78,28 @@ configUSE_TIMERS is set to 1 in FreeRTOSConfig.h. */
 /* Misc definitions. */
 #define tmrNO_DELAY		( portTickType ) 0U
 
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+	/* The wheel has tmrWHEEL_LEVELS levels of tmrWHEEL_SLOTS slots.  A slot on
+	level 0 stands for one tick, a slot on level 1 for tmrWHEEL_SLOTS ticks, and
+	so on, so the wheel reaches ( 1 << tmrWHEEL_SPAN_SHIFT ) ticks ahead.  The
+	slot a timer goes in is picked from the bits of its expiry time. */
+	#define tmrWHEEL_LEVELS					( 3U )
+	#define tmrWHEEL_SLOTS					( 1U << configTIMER_WHEEL_SLOT_BITS )
+	#define tmrWHEEL_SLOT_MASK				( ( portTickType ) ( tmrWHEEL_SLOTS - 1U ) )
+	#define tmrWHEEL_LEVEL_SHIFT( uxLevel )	( ( uxLevel ) * configTIMER_WHEEL_SLOT_BITS )
+	#define tmrWHEEL_SPAN_SHIFT				( 3 * configTIMER_WHEEL_SLOT_BITS )
+
+	#if ( configUSE_16_BIT_TICKS == 1 ) && ( tmrWHEEL_SPAN_SHIFT > 15 )
+		#error configTIMER_WHEEL_SLOT_BITS must be 5 or less when configUSE_16_BIT_TICKS is set to 1.
+	#endif
+
+	#if ( tmrWHEEL_SPAN_SHIFT > 30 )
+		#error configTIMER_WHEEL_SLOT_BITS must be 10 or less.
+	#endif
+
+#endif /* configUSE_TIMER_WHEEL */
+
 /* The definition of the timers themselves. */
 typedef struct tmrTimerControl
 {
@@ -87,8 +109,18 @@ typedef struct tmrTimerControl
 	unsigned portBASE_TYPE	uxAutoReload;		/*<< Set to pdTRUE if the timer should be automatically restarted once expired.  Set to pdFALSE if the timer is, in effect, a one shot timer. */
 	void 					*pvTimerID;			/*<< An ID to identify the timer.  This allows the timer to be identified when the same callback is used for multiple timers. */
 	tmrTIMER_CALLBACK		pxCallbackFunction;	/*<< The function that will be called when the timer expires. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char		ucStaticallyAllocated;	/*<< Set to pdTRUE if the memory was given by xTimerCreateStatic(), so is not freed when the timer is deleted. */
+	#endif
 } xTIMER;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* xStaticTimer has to be kept the same size as xTIMER.  configASSERT() is not
+	defined in every build, so the check is made here, where it fails to compile
+	if the sizes differ. */
+	typedef char xStaticTimerSizeCheck[ ( sizeof( xStaticTimer ) == sizeof( xTIMER ) ) ? 1 : -1 ];
+#endif
+
 /* The definition of messages that can be sent and received on the timer
 queue. */
 typedef struct tmrTimerQueueMessage
@@ -102,10 +134,25 @@ typedef struct tmrTimerQueueMessage
 /* The list in which active timers are stored.  Timers are referenced in expire
 time order, with the nearest expiry time at the front of the list.  Only the
 timer service task is allowed to access xActiveTimerList. */
-PRIVILEGED_DATA static xList xActiveTimerList1;
-PRIVILEGED_DATA static xList xActiveTimerList2;
-PRIVILEGED_DATA static xList *pxCurrentTimerList;
-PRIVILEGED_DATA static xList *pxOverflowTimerList;
+#if ( configUSE_TIMER_WHEEL == 0 )
+
+	PRIVILEGED_DATA static xList xActiveTimerList1;
+	PRIVILEGED_DATA static xList xActiveTimerList2;
+	PRIVILEGED_DATA static xList *pxCurrentTimerList;
+	PRIVILEGED_DATA static xList *pxOverflowTimerList;
+
+#else
+
+	/* With the timing wheel active timers are instead referenced from the
+	wheel slot their expiry time falls in, or from xFarTimerList when that is
+	further ahead than the wheel reaches.  Neither is kept in order.  Every slot
+	up to and including the one for xWheelTime has been processed.  Only the
+	timer service task is allowed to access any of these. */
+	PRIVILEGED_DATA static xList xTimerWheel[ tmrWHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static xList xFarTimerList;
+	PRIVILEGED_DATA static portTickType xWheelTime;
+
+#endif /* configUSE_TIMER_WHEEL */
 
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
@@ -133,10 +180,14 @@ static void	prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
 
 /*
  * Insert the timer into either xActiveTimerList1, or xActiveTimerList2,
- * depending on if the expire time causes a timer counter overflow.
+ * depending on if the expire time causes a timer counter overflow (or into the
+ * timing wheel when configUSE_TIMER_WHEEL is set).  Returns pdTRUE without
+ * inserting the timer if its expiry time has already passed.
  */
 static portBASE_TYPE prvInsertTimerInActiveList( xTIMER *pxTimer, portTickType xNextExpiryTime, portTickType xTimeNow, portTickType xCommandTime ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_TIMER_WHEEL == 0 )
+
 /*
  * An active timer has reached its expire time.  Reload the timer if it is an
  * auto reload timer, then call its callback.
@@ -169,6 +220,53 @@ static portTickType prvGetNextExpireTime( portBASE_TYPE *pxListWasEmpty ) PRIVIL
  */
 static void prvProcessTimerOrBlockTask( portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty ) PRIVILEGED_FUNCTION;
 
+#else
+
+/*
+ * Reference the timer from the wheel slot, or the far list, that xExpiryTime
+ * falls in as seen from xWheelTime.
+ */
+static void prvWheelInsert( xTIMER *pxTimer, portTickType xExpiryTime ) PRIVILEGED_FUNCTION;
+
+/*
+ * Return the number of ticks from xWheelTime to the next tick on which a
+ * wheel slot that references any timers is due to be expired or cascaded, and
+ * set *pxWheelWasEmpty to pdFALSE.  If there is no such tick because no timers
+ * are active then set *pxWheelWasEmpty to pdTRUE.
+ */
+static portTickType prvWheelTicksToNextEvent( portBASE_TYPE *pxWheelWasEmpty ) PRIVILEGED_FUNCTION;
+
+/*
+ * Move xWheelTime on to xTimeNow, processing the slots due on the way.
+ */
+static void prvWheelAdvance( portTickType xTimeNow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Insert each timer referenced from a slot (or the far list) into the wheel
+ * again, now that it is nearer its expiry time.
+ */
+static void prvWheelCascade( xList *pxSlot ) PRIVILEGED_FUNCTION;
+
+/*
+ * Expire every timer referenced from a level 0 slot.  Reload the auto reload
+ * timers, then call the callbacks.
+ */
+static void prvWheelExpireSlot( xList *pxSlot ) PRIVILEGED_FUNCTION;
+
+/*
+ * If any timers are due, process them.  Otherwise, block the timer service
+ * task until either the next wheel slot is due or a command is received.
+ */
+static void prvProcessWheelOrBlockTask( void ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_WHEEL */
+
+/*
+ * Set up the members of a timer created by xTimerCreate() or
+ * xTimerCreateStatic().
+ */
+static void prvInitialiseNewTimer( xTIMER *pxNewTimer, const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------*/
 
 portBASE_TYPE xTimerCreateTimerTask( void )
@@ -206,19 +304,13 @@ xTIMER *pxNewTimer;
 		pxNewTimer = ( xTIMER * ) pvPortMalloc( sizeof( xTIMER ) );
 		if( pxNewTimer != NULL )
 		{
-			/* Ensure the infrastructure used by the timer service task has been
-			created/initialised. */
-			prvCheckForValidListAndQueue();
-	
-			/* Initialise the timer structure members using the function parameters. */
-			pxNewTimer->pcTimerName = pcTimerName;
-			pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
-			pxNewTimer->uxAutoReload = uxAutoReload;
-			pxNewTimer->pvTimerID = pvTimerID;
-			pxNewTimer->pxCallbackFunction = pxCallbackFunction;
-			vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
-			
-			traceTIMER_CREATE( pxNewTimer );
+			prvInitialiseNewTimer( pxNewTimer, pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction );
+
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				pxNewTimer->ucStaticallyAllocated = pdFALSE;
+			}
+			#endif
 		}
 		else
 		{
@@ -230,6 +322,46 @@ xTIMER *pxNewTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimer *pxTimerBuffer )
+	{
+	xTIMER *pxNewTimer = NULL;
+
+		configASSERT( pxTimerBuffer );
+		configASSERT( ( xTimerPeriodInTicks > 0 ) );
+
+		if( xTimerPeriodInTicks != ( portTickType ) 0U )
+		{
+			pxNewTimer = ( xTIMER * ) pxTimerBuffer;
+			prvInitialiseNewTimer( pxNewTimer, pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction );
+			pxNewTimer->ucStaticallyAllocated = pdTRUE;
+		}
+
+		return ( xTimerHandle ) pxNewTimer;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewTimer( xTIMER *pxNewTimer, const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction )
+{
+	/* Ensure the infrastructure used by the timer service task has been
+	created/initialised. */
+	prvCheckForValidListAndQueue();
+
+	/* Initialise the timer structure members using the function parameters. */
+	pxNewTimer->pcTimerName = pcTimerName;
+	pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
+	pxNewTimer->uxAutoReload = uxAutoReload;
+	pxNewTimer->pvTimerID = pvTimerID;
+	pxNewTimer->pxCallbackFunction = pxCallbackFunction;
+	vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
+
+	traceTIMER_CREATE( pxNewTimer );
+}
+/*-----------------------------------------------------------*/
+
 portBASE_TYPE xTimerGenericCommand( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime )
 {
 portBASE_TYPE xReturn = pdFAIL;
@@ -267,6 +399,8 @@ xTIMER_MESSAGE xMessage;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessExpiredTimer( portTickType xNextExpireTime, portTickType xTimeNow )
 {
 xTIMER *pxTimer;
@@ -301,25 +435,39 @@ portBASE_TYPE xResult;
 	/* Call the timer callback. */
 	pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvTimerTask( void *pvParameters )
 {
-portTickType xNextExpireTime;
-portBASE_TYPE xListWasEmpty;
+#if ( configUSE_TIMER_WHEEL == 0 )
+	portTickType xNextExpireTime;
+	portBASE_TYPE xListWasEmpty;
+#endif
 
 	/* Just to avoid compiler warnings. */
 	( void ) pvParameters;
 
 	for( ;; )
 	{
-		/* Query the timers list to see if it contains any timers, and if so,
-		obtain the time at which the next timer will expire. */
-		xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
+		#if ( configUSE_TIMER_WHEEL == 0 )
+		{
+			/* Query the timers list to see if it contains any timers, and if so,
+			obtain the time at which the next timer will expire. */
+			xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
 
-		/* If a timer has expired, process it.  Otherwise, block this task
-		until either a timer does expire, or a command is received. */
-		prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+			/* If a timer has expired, process it.  Otherwise, block this task
+			until either a timer does expire, or a command is received. */
+			prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+		}
+		#else
+		{
+			/* Process every timer that is due, or block this task until either
+			one is due or a command is received. */
+			prvProcessWheelOrBlockTask();
+		}
+		#endif
 		
 		/* Empty the command queue. */
 		prvProcessReceivedCommands();		
@@ -327,6 +475,8 @@ portBASE_TYPE xListWasEmpty;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessTimerOrBlockTask( portTickType xNextExpireTime, portBASE_TYPE xListWasEmpty )
 {
 portTickType xTimeNow;
@@ -464,18 +614,255 @@ portBASE_TYPE xProcessTimerNow = pdFALSE;
 
 	return xProcessTimerNow;
 }
+
+#else /* configUSE_TIMER_WHEEL */
+
+	static portBASE_TYPE prvInsertTimerInActiveList( xTIMER *pxTimer, portTickType xNextExpiryTime, portTickType xTimeNow, portTickType xCommandTime )
+	{
+	portBASE_TYPE xProcessTimerNow = pdFALSE;
+
+		/* Has the expiry time elapsed between the command to start/reset a
+		timer was issued, and the time the command was processed?  Both times
+		are measured from the command time, which gives the right answer across
+		a tick count overflow, so the wheel needs no second list. */
+		if( ( ( portTickType ) ( xTimeNow - xCommandTime ) ) >= ( ( portTickType ) ( xNextExpiryTime - xCommandTime ) ) )
+		{
+			xProcessTimerNow = pdTRUE;
+		}
+		else
+		{
+			prvWheelInsert( pxTimer, xNextExpiryTime );
+		}
+
+		return xProcessTimerNow;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWheelInsert( xTIMER *pxTimer, portTickType xExpiryTime )
+	{
+	portTickType xTicksAhead;
+	unsigned portBASE_TYPE uxLevel;
+	xList *pxSlot = &xFarTimerList;
+
+		listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xExpiryTime );
+		listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+		/* The timer goes on the lowest level that reaches its expiry time.
+		xExpiryTime is never behind xWheelTime, so the subtraction cannot
+		wrap. */
+		xTicksAhead = ( portTickType ) ( xExpiryTime - xWheelTime );
+		for( uxLevel = 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+		{
+			if( ( xTicksAhead >> tmrWHEEL_LEVEL_SHIFT( uxLevel + 1U ) ) == ( portTickType ) 0U )
+			{
+				pxSlot = &( xTimerWheel[ uxLevel ][ ( xExpiryTime >> tmrWHEEL_LEVEL_SHIFT( uxLevel ) ) & tmrWHEEL_SLOT_MASK ] );
+				break;
+			}
+		}
+
+		vListInsertEnd( pxSlot, &( pxTimer->xTimerListItem ) );
+	}
+	/*-----------------------------------------------------------*/
+
+	static portTickType prvWheelTicksToNextEvent( portBASE_TYPE *pxWheelWasEmpty )
+	{
+	portTickType xNextEvent = portMAX_DELAY, xTicks, xSlotTicks;
+	unsigned portBASE_TYPE uxLevel, uxSlot;
+
+		/* A level 0 slot is due on the tick it stands for, and a slot on a
+		higher level is due (to be cascaded) on the first tick it stands for.
+		The first slot boundary on a level is never sooner than the first on
+		the level below, so each level only has to be searched up to the
+		nearest event already found on the levels below it. */
+		for( uxLevel = 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+		{
+			xSlotTicks = ( portTickType ) 1U << tmrWHEEL_LEVEL_SHIFT( uxLevel );
+			xTicks = xSlotTicks - ( xWheelTime & ( xSlotTicks - ( portTickType ) 1U ) );
+
+			for( uxSlot = 0U; ( uxSlot < tmrWHEEL_SLOTS ) && ( xTicks < xNextEvent ); uxSlot++ )
+			{
+				if( listLIST_IS_EMPTY( &( xTimerWheel[ uxLevel ][ ( ( portTickType ) ( xWheelTime + xTicks ) >> tmrWHEEL_LEVEL_SHIFT( uxLevel ) ) & tmrWHEEL_SLOT_MASK ] ) ) == pdFALSE )
+				{
+					xNextEvent = xTicks;
+				}
+
+				xTicks += xSlotTicks;
+			}
+		}
+
+		/* The far list is cascaded each time the top level comes round. */
+		if( listLIST_IS_EMPTY( &xFarTimerList ) == pdFALSE )
+		{
+			xSlotTicks = ( portTickType ) 1U << tmrWHEEL_SPAN_SHIFT;
+			xTicks = xSlotTicks - ( xWheelTime & ( xSlotTicks - ( portTickType ) 1U ) );
+
+			if( xTicks < xNextEvent )
+			{
+				xNextEvent = xTicks;
+			}
+		}
+
+		*pxWheelWasEmpty = ( xNextEvent == portMAX_DELAY );
+
+		return xNextEvent;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWheelAdvance( portTickType xTimeNow )
+	{
+	portTickType xTicksToEvent;
+	portBASE_TYPE xWheelWasEmpty;
+	unsigned portBASE_TYPE uxLevel;
+
+		for( ;; )
+		{
+			/* Step straight to the next tick that has anything to do, rather
+			than through every tick in between. */
+			xTicksToEvent = prvWheelTicksToNextEvent( &xWheelWasEmpty );
+			if( ( xWheelWasEmpty != pdFALSE ) || ( xTicksToEvent > ( portTickType ) ( xTimeNow - xWheelTime ) ) )
+			{
+				break;
+			}
+
+			xWheelTime += xTicksToEvent;
+
+			/* Bring down the timers of each higher level slot that starts on
+			this tick, some of which may be due on it, then expire the level 0
+			slot. */
+			if( ( xWheelTime & ( ( ( portTickType ) 1U << tmrWHEEL_SPAN_SHIFT ) - ( portTickType ) 1U ) ) == ( portTickType ) 0U )
+			{
+				prvWheelCascade( &xFarTimerList );
+			}
+
+			for( uxLevel = tmrWHEEL_LEVELS - 1U; uxLevel > 0U; uxLevel-- )
+			{
+				if( ( xWheelTime & ( ( ( portTickType ) 1U << tmrWHEEL_LEVEL_SHIFT( uxLevel ) ) - ( portTickType ) 1U ) ) == ( portTickType ) 0U )
+				{
+					prvWheelCascade( &( xTimerWheel[ uxLevel ][ ( xWheelTime >> tmrWHEEL_LEVEL_SHIFT( uxLevel ) ) & tmrWHEEL_SLOT_MASK ] ) );
+				}
+			}
+
+			prvWheelExpireSlot( &( xTimerWheel[ 0 ][ xWheelTime & tmrWHEEL_SLOT_MASK ] ) );
+		}
+
+		/* Nothing else is due by xTimeNow. */
+		xWheelTime = xTimeNow;
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWheelCascade( xList *pxSlot )
+	{
+	unsigned portBASE_TYPE uxTimers;
+	xTIMER *pxTimer;
+
+		/* Each timer lands on a lower level than the slot it came from, or back
+		at the end of the far list if it is still that far ahead.  Only the
+		timers there to start with are moved. */
+		for( uxTimers = listCURRENT_LIST_LENGTH( pxSlot ); uxTimers > ( unsigned portBASE_TYPE ) 0U; uxTimers-- )
+		{
+			pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+			vListRemove( &( pxTimer->xTimerListItem ) );
+			prvWheelInsert( pxTimer, listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvWheelExpireSlot( xList *pxSlot )
+	{
+	xTIMER *pxTimer;
+
+		/* Every timer in the slot is due on this tick, so they are all
+		processed together rather than one for each time round the timer
+		service task's loop. */
+		while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+		{
+			pxTimer = ( xTIMER * ) listGET_OWNER_OF_HEAD_ENTRY( pxSlot );
+			vListRemove( &( pxTimer->xTimerListItem ) );
+			traceTIMER_EXPIRED( pxTimer );
+
+			/* The next expiry time is a period on from when the timer was due,
+			not from now.  If that has already gone by too then
+			prvWheelAdvance() comes to it before it returns.  The period is
+			never 0, so the timer cannot go back into this slot. */
+			if( pxTimer->uxAutoReload == ( unsigned portBASE_TYPE ) pdTRUE )
+			{
+				prvWheelInsert( pxTimer, ( xWheelTime + pxTimer->xTimerPeriodInTicks ) );
+			}
+
+			/* Call the timer callback. */
+			pxTimer->pxCallbackFunction( ( xTimerHandle ) pxTimer );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvProcessWheelOrBlockTask( void )
+	{
+	portTickType xTimeNow, xTicksToEvent;
+	portBASE_TYPE xWheelWasEmpty;
+
+		vTaskSuspendAll();
+		{
+			xTimeNow = xTaskGetTickCount();
+			xTicksToEvent = prvWheelTicksToNextEvent( &xWheelWasEmpty );
+
+			if( ( xWheelWasEmpty == pdFALSE ) && ( xTicksToEvent <= ( portTickType ) ( xTimeNow - xWheelTime ) ) )
+			{
+				xTaskResumeAll();
+				prvWheelAdvance( xTimeNow );
+			}
+			else
+			{
+				/* Nothing is due yet, so the wheel can be moved on to now
+				without passing a slot that references a timer.  Block until the
+				next slot is due, or until a command is received.  If there are
+				no active timers then only a command can give this task anything
+				to do. */
+				if( xWheelWasEmpty == pdFALSE )
+				{
+					xTicksToEvent -= ( portTickType ) ( xTimeNow - xWheelTime );
+				}
+				else
+				{
+					xTicksToEvent = portMAX_DELAY;
+				}
+
+				xWheelTime = xTimeNow;
+				vQueueWaitForMessageRestricted( xTimerQueue, xTicksToEvent );
+
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					/* Yield to wait for either a command to arrive, or the block
+					time to expire. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void	prvProcessReceivedCommands( void )
 {
 xTIMER_MESSAGE xMessage;
 xTIMER *pxTimer;
-portBASE_TYPE xTimerListsWereSwitched, xResult;
+portBASE_TYPE xResult;
 portTickType xTimeNow;
 
-	/* In this case the xTimerListsWereSwitched parameter is not used, but it
-	must be present in the function call. */
-	xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+	#if ( configUSE_TIMER_WHEEL == 0 )
+	{
+	portBASE_TYPE xTimerListsWereSwitched;
+
+		/* In this case the xTimerListsWereSwitched parameter is not used, but it
+		must be present in the function call. */
+		xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+	}
+	#else
+	{
+		/* The wheel does not depend on noticing a tick count overflow. */
+		xTimeNow = xTaskGetTickCount();
+	}
+	#endif
 
 	while( xQueueReceive( xTimerQueue, &xMessage, tmrNO_DELAY ) != pdFAIL )
 	{
@@ -527,8 +914,14 @@ portTickType xTimeNow;
 
 			case tmrCOMMAND_DELETE :
 				/* The timer has already been removed from the active list,
-				just free up the memory. */
-				vPortFree( pxTimer );
+				just free up the memory (unless it belongs to the
+				application). */
+				#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+					if( pxTimer->ucStaticallyAllocated == pdFALSE )
+				#endif
+				{
+					vPortFree( pxTimer );
+				}
 				break;
 
 			default	:			
@@ -539,6 +932,8 @@ portTickType xTimeNow;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TIMER_WHEEL == 0 )
+
 static void prvSwitchTimerLists( portTickType xLastTime )
 {
 portTickType xNextExpireTime, xReloadTime;
@@ -594,10 +989,16 @@ portBASE_TYPE xResult;
 	pxCurrentTimerList = pxOverflowTimerList;
 	pxOverflowTimerList = pxTemp;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
 {
+#if ( configUSE_TIMER_WHEEL == 1 )
+	unsigned portBASE_TYPE uxLevel, uxSlot;
+#endif
+
 	/* Check that the list from which active timers are referenced, and the
 	queue used to communicate with the timer service, have been
 	initialised. */
@@ -605,10 +1006,26 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
-			vListInitialise( &xActiveTimerList1 );
-			vListInitialise( &xActiveTimerList2 );
-			pxCurrentTimerList = &xActiveTimerList1;
-			pxOverflowTimerList = &xActiveTimerList2;
+			#if ( configUSE_TIMER_WHEEL == 0 )
+			{
+				vListInitialise( &xActiveTimerList1 );
+				vListInitialise( &xActiveTimerList2 );
+				pxCurrentTimerList = &xActiveTimerList1;
+				pxOverflowTimerList = &xActiveTimerList2;
+			}
+			#else
+			{
+				for( uxLevel = 0U; uxLevel < tmrWHEEL_LEVELS; uxLevel++ )
+				{
+					for( uxSlot = 0U; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+					{
+						vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+					}
+				}
+				vListInitialise( &xFarTimerList );
+				xWheelTime = xTaskGetTickCount();
+			}
+			#endif
 			xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) );
 		}
 	}
@@ -625,8 +1042,9 @@ xTIMER *pxTimer = ( xTIMER * ) xTimer;
 	taskENTER_CRITICAL();
 	{
 		/* Checking to see if it is in the NULL list in effect checks to see if
-		it is referenced from either the current or the overflow timer lists in
-		one go, but the logic has to be reversed, hence the '!'. */
+		it is referenced from either the current or the overflow timer lists (or
+		from the timing wheel) in one go, but the logic has to be reversed,
+		hence the '!'. */
 		xTimerIsInActiveList = !( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) );
 	}
 	taskEXIT_CRITICAL();
@@ -213,6 +213,11 @@ extern "C"
 /** I2C SCL LOW duty cycle Register bit mask */
 #define I2C_I2SCLL_BITMASK			((0xFFFF))
 
+/** Highest SCL clock rate of Standard mode, above this I2C_Init() sets up Fast mode timing */
+#define I2C_STANDARD_MODE_CLOCK		(100000)
+/** Highest SCL clock rate of Fast mode */
+#define I2C_FAST_MODE_CLOCK			(400000)
+
 /* I2C status values */
 #define I2C_SETUP_STATUS_ARBF   (1<<8)	/**< Arbitration false */
 #define I2C_SETUP_STATUS_NOACKF (1<<9)	/**< No ACK returned */
@@ -229,7 +229,17 @@ static void I2C_SetClock (LPC_I2C_TypeDef *I2Cx, uint32_t target_clock)
 	}
 
 	/* Set the I2C clock value to register */
-	I2Cx->I2SCLH = (uint32_t)(temp / 2);
+	if (target_clock > I2C_STANDARD_MODE_CLOCK)
+	{
+		/* Fast mode: SCL low must be at least 1.3us and high at least 0.6us,
+		 * so a 50% duty cycle would leave SCL low too short at 400kHz.
+		 * Use 40% high / 60% low instead */
+		I2Cx->I2SCLH = (uint32_t)((temp * 2) / 5);
+	}
+	else
+	{
+		I2Cx->I2SCLH = (uint32_t)(temp / 2);
+	}
 	I2Cx->I2SCLL = (uint32_t)(temp - I2Cx->I2SCLH);
 }
 /* End of Private Functions --------------------------------------------------- */
@@ -0,0 +1,93 @@
+/******************************************************************************/
+/* LPC17xx.h: host (POSIX) stand-in for the LPC17xx device header             */
+/******************************************************************************/
+/* Declares the peripherals used by the rover sources that are compiled into  */
+/* the host build.  The register blocks live in ordinary RAM and are driven   */
+/* by the host stand-ins (hostI2C.c etc.) rather than by hardware.            */
+/******************************************************************************/
+
+#ifndef __LPC17xx_H__
+#define __LPC17xx_H__
+
+/*------------------------------------------------------------------------------
+  Interrupt Number Definition (same numbering as the target)
+ *----------------------------------------------------------------------------*/
+typedef enum IRQn
+{
+  NonMaskableInt_IRQn           = -14,
+  MemoryManagement_IRQn         = -12,
+  BusFault_IRQn                 = -11,
+  UsageFault_IRQn               = -10,
+  SVCall_IRQn                   = -5,
+  DebugMonitor_IRQn             = -4,
+  PendSV_IRQn                   = -2,
+  SysTick_IRQn                  = -1,
+
+  WDT_IRQn                      = 0,
+  TIMER0_IRQn                   = 1,
+  TIMER1_IRQn                   = 2,
+  TIMER2_IRQn                   = 3,
+  TIMER3_IRQn                   = 4,
+  UART0_IRQn                    = 5,
+  UART1_IRQn                    = 6,
+  UART2_IRQn                    = 7,
+  UART3_IRQn                    = 8,
+  PWM1_IRQn                     = 9,
+  I2C0_IRQn                     = 10,
+  I2C1_IRQn                     = 11,
+  I2C2_IRQn                     = 12,
+  SPI_IRQn                      = 13,
+  SSP0_IRQn                     = 14,
+  SSP1_IRQn                     = 15,
+  PLL0_IRQn                     = 16,
+  RTC_IRQn                      = 17,
+  EINT0_IRQn                    = 18,
+  EINT1_IRQn                    = 19,
+  EINT2_IRQn                    = 20,
+  EINT3_IRQn                    = 21,
+  ADC_IRQn                      = 22,
+  BOD_IRQn                      = 23,
+  USB_IRQn                      = 24,
+  CAN_IRQn                      = 25,
+  DMA_IRQn                      = 26,
+  I2S_IRQn                      = 27,
+  ENET_IRQn                     = 28,
+  RIT_IRQn                      = 29,
+  MCPWM_IRQn                    = 30,
+  QEI_IRQn                      = 31,
+  PLL1_IRQn                     = 32,
+} IRQn_Type;
+
+#include "core_cm3.h"
+
+/*------------------------------------------------------------------------------
+  Inter-Integrated Circuit (I2C)
+ *----------------------------------------------------------------------------*/
+typedef struct
+{
+  __IO uint32_t I2CONSET;
+  __I  uint32_t I2STAT;
+  __IO uint32_t I2DAT;
+  __IO uint32_t I2ADR0;
+  __IO uint32_t I2SCLH;
+  __IO uint32_t I2SCLL;
+  __O  uint32_t I2CONCLR;
+  __IO uint32_t MMCTRL;
+  __IO uint32_t I2ADR1;
+  __IO uint32_t I2ADR2;
+  __IO uint32_t I2ADR3;
+  __I  uint32_t I2DATA_BUFFER;
+  __IO uint32_t I2MASK0;
+  __IO uint32_t I2MASK1;
+  __IO uint32_t I2MASK2;
+  __IO uint32_t I2MASK3;
+} LPC_I2C_TypeDef;
+
+// Register blocks for the three I2C units (defined in hostI2C.c)
+extern LPC_I2C_TypeDef hostI2CRegs[3];
+
+#define LPC_I2C0              (&hostI2CRegs[0])
+#define LPC_I2C1              (&hostI2CRegs[1])
+#define LPC_I2C2              (&hostI2CRegs[2])
+
+#endif  // __LPC17xx_H__
@@ -0,0 +1,53 @@
+/******************************************************************************/
+/* core_cm3.h: host (POSIX) stand-in for the CMSIS Cortex-M3 core header      */
+/******************************************************************************/
+/* Only the parts of CMSIS that the rover sources use are provided.  The NVIC */
+/* calls are accepted and remembered, but interrupt delivery on the host is   */
+/* done by the FreeRTOS POSIX port (see vPortGenerateSimulatedInterrupt()).   */
+/******************************************************************************/
+
+#ifndef __CORE_CM3_H__
+#define __CORE_CM3_H__
+
+#include <stdint.h>
+
+#define __INLINE         inline
+
+// Host stand-ins for peripherals need to write registers that are read-only to the
+//   application, so __I does not add const here as it does on the target
+#define __I              volatile
+#define __O              volatile
+#define __IO             volatile
+
+#define __NVIC_PRIO_BITS 5
+
+// Interrupt enable and priority state, kept so host code can inspect it
+extern uint8_t  hostNVICEnabled[64];
+extern uint8_t  hostNVICPriority[64];
+
+static __INLINE void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+  if (IRQn >= 0) hostNVICEnabled[IRQn] = 1;
+}
+
+static __INLINE void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+  if (IRQn >= 0) hostNVICEnabled[IRQn] = 0;
+}
+
+static __INLINE void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+  if (IRQn >= 0) hostNVICPriority[IRQn] = (uint8_t) priority;
+}
+
+static __INLINE uint32_t NVIC_GetPriority(IRQn_Type IRQn)
+{
+  return((IRQn >= 0) ? hostNVICPriority[IRQn] : 0);
+}
+
+static __INLINE void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+  (void) IRQn;
+}
+
+#endif /* __CORE_CM3_H__ */
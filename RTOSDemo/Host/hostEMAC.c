@@ -0,0 +1,88 @@
+// Host stand-in for the uIP/EMAC web server task (webserver/uIP_Task.c)
+//
+// There is no network on the host.  The stand-in task keeps the same shape as vuIP_Task() -- it
+//   blocks for half a second at a time waiting for work -- and the "work" is web form input posted
+//   with vHostEMACPostForm().  Form input is handled just as the target's web page handler does:
+//   "LED0=1" starts the rover, anything else stops it.
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* include files. */
+#include "vtUtilities.h"
+#include "navigation.h"
+#include "hostPeripherals.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+#define hostFormQLen 4
+#define hostFormMaxLen 32
+
+static xQueueHandle formQ = NULL;
+
+// By default the operator presses "start" one second after power up
+unsigned long ulHostEMACAutoStartMs = 1000;
+// end of defs
+/* *********************************************** */
+
+void vApplicationProcessFormInput( char *pcInputString )
+{
+	char *c;
+
+	/* Process the form input sent by the IO page of the served HTML. */
+	c = strstr( pcInputString, "?" );
+	if( c )
+	{
+		if( strstr( c, "LED0=1" ) != NULL )
+		{
+			start();
+		}
+		else
+		{
+			stop();
+		}
+	}
+}
+
+void vHostEMACPostForm(const char *form)
+{
+	char msg[hostFormMaxLen];
+
+	if (formQ == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	strncpy(msg,form,hostFormMaxLen-1);
+	msg[hostFormMaxLen-1] = '\0';
+	if (xQueueSend(formQ,(void *) msg,portMAX_DELAY) != pdTRUE) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+}
+
+void vuIP_Task( void *pvParameters )
+{
+	char msg[hostFormMaxLen];
+	portTickType xStartTime;
+	int autoStarted = 0;
+
+	( void ) pvParameters;
+
+	if ((formQ = xQueueCreate(hostFormQLen,hostFormMaxLen)) == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	xStartTime = xTaskGetTickCount();
+
+	for( ;; )
+	{
+		if (xQueueReceive(formQ,(void *) msg,configTICK_RATE_HZ / 2) == pdTRUE) {
+			vApplicationProcessFormInput(msg);
+		}
+		if ((ulHostEMACAutoStartMs != 0) && !autoStarted &&
+			((xTaskGetTickCount() - xStartTime) >= ulHostEMACAutoStartMs/portTICK_RATE_MS)) {
+			autoStarted = 1;
+			vApplicationProcessFormInput("/io.shtml?LED0=1");
+		}
+	}
+}
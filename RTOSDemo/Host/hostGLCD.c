@@ -0,0 +1,257 @@
+// Host stand-in for the graphic LCD driver (vtCode/vtLCD/GLCD_SPI_LPC1700.c)
+//
+// Implements the GLCD.h API on a RAM framebuffer (320x240, RGB565, screen coordinates with the
+//   origin at the top left) using the same fonts as the target.  The text on each 16x24 line is
+//   read back from the framebuffer (by matching the font) so that the host report shows what the
+//   panel would be displaying, however it was drawn.
+#include <stdio.h>
+#include <string.h>
+
+#include "GLCD.h"
+#include "Font_6x8_h.h"
+#include "Font_16x24_h.h"
+#include "hostPeripherals.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+#define WIDTH       320                 /* Screen Width (in pixels)           */
+#define HEIGHT      240                 /* Screen Hight (in pixels)           */
+
+static unsigned short frame[HEIGHT][WIDTH];
+static unsigned short TextColor = Black, BackColor = White;
+static unsigned int winX = 0, winY = 0, winW = WIDTH, winH = HEIGHT;
+static char lineText[lcdCHAR_IN_LINE+1];
+static hostGLCDStats stats;
+// end of defs
+/* *********************************************** */
+
+static void prvFill(unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned short color)
+{
+  unsigned int i, j;
+
+  if (x >= WIDTH || y >= HEIGHT) return;
+  if (x + w > WIDTH) w = WIDTH - x;
+  if (y + h > HEIGHT) h = HEIGHT - y;
+  for (j = y; j < y + h; j++) {
+    for (i = x; i < x + w; i++) {
+      frame[j][i] = color;
+    }
+  }
+  stats.pixelsWritten += w*h;
+}
+
+// Draw a character bitmap -- rows of cw bits, least significant bit (U8) or most significant bit (U16) first
+static void prvDrawChar(unsigned int x, unsigned int y, unsigned int cw, unsigned int ch, const unsigned char *c8, const unsigned short *c16)
+{
+  unsigned int i, j, on;
+
+  if (x + cw > WIDTH || y + ch > HEIGHT) {
+    // writing past the end of the line or the bottom of the screen -- ignore it
+    return;
+  }
+  for (j = 0; j < ch; j++) {
+    for (i = 0; i < cw; i++) {
+      on = (c8 != NULL) ? (c8[j] & (1 << i)) : (c16[j] & (0x8000 >> i));
+      frame[y+j][x+i] = on ? TextColor : BackColor;
+    }
+  }
+  stats.pixelsWritten += cw*ch;
+}
+
+void GLCD_Init (void) {
+  TextColor = Black;
+  BackColor = White;
+  GLCD_WindowMax();
+}
+
+void GLCD_WindowMax (void) {
+  winX = 0; winY = 0; winW = WIDTH; winH = HEIGHT;
+}
+
+void GLCD_PutPixel (unsigned int x, unsigned int y) {
+  if (x < WIDTH && y < HEIGHT) {
+    frame[y][x] = TextColor;
+    stats.pixelsWritten++;
+  }
+}
+
+unsigned short GLCD_GetPixel (unsigned int x, unsigned int y) {
+  return (x < WIDTH && y < HEIGHT) ? frame[y][x] : 0;
+}
+
+void GLCD_GetPixelRow (unsigned int x, unsigned int y, unsigned int width, unsigned short int *buffer) {
+  unsigned int i;
+
+  for (i = 0; i < width; i++) {
+    buffer[i] = GLCD_GetPixel(x + i, y);
+  }
+}
+
+void GLCD_SetTextColor (unsigned short color) {
+  TextColor = color;
+}
+
+void GLCD_SetBackColor (unsigned short color) {
+  BackColor = color;
+}
+
+void GLCD_Clear (unsigned short color) {
+  GLCD_WindowMax();
+  prvFill(0, 0, WIDTH, HEIGHT, color);
+  stats.clears++;
+}
+
+void GLCD_ClearWindow (unsigned int x, unsigned int y, unsigned int width, unsigned int height, unsigned short color) {
+  prvFill(x, y, width, height, color);
+}
+
+void GLCD_DrawChar (unsigned int x, unsigned int y, unsigned short *c) {
+  prvDrawChar(x, y, 16, 24, NULL, c);
+}
+
+void GLCD_DisplayChar (unsigned int ln, unsigned int col, unsigned char fi, unsigned char c) {
+  c -= 32;
+  switch (fi) {
+    case 0:  /* Font 6 x 8 */
+      prvDrawChar(col *  6, ln *  8,  6,  8, &Font_6x8_h[c * 8], NULL);
+      break;
+    case 1:  /* Font 16 x 24 */
+      prvDrawChar(col * 16, ln * 24, 16, 24, NULL, &Font_16x24_h[c * 24]);
+      break;
+  }
+}
+
+void GLCD_DisplayString (unsigned int ln, unsigned int col, unsigned char fi, unsigned char *s) {
+  GLCD_WindowMax();
+  while (*s) {
+    GLCD_DisplayChar(ln, col++, fi, *s++);
+  }
+}
+
+void GLCD_ClearLn (unsigned int ln, unsigned char fi) {
+  unsigned int cHeight;
+
+  switch (fi) {
+    case 0: cHeight = 8; break;
+    case 1: cHeight = 24; break;
+    default: return;
+  }
+  if (ln * cHeight + cHeight > HEIGHT) {
+    // The specified line is out of bounds
+    return;
+  }
+  prvFill(0, ln * cHeight, WIDTH, cHeight, BackColor);
+}
+
+void GLCD_Bargraph (unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned int val) {
+  val = (val * w) >> 10;                /* Scale value                        */
+  if (val > w) val = w;
+  prvFill(x, y, val, h, TextColor);
+  prvFill(x + val, y, w - val, h, BackColor);
+}
+
+void GLCD_Bitmap (unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned char *bitmap) {
+  unsigned short *bitmap_ptr = (unsigned short *) bitmap;
+  unsigned int i, j;
+
+  for (j = 0; j < h; j++) {
+    for (i = 0; i < w; i++, bitmap_ptr++) {
+      if (x + i < WIDTH && y + j < HEIGHT) frame[y+j][x+i] = *bitmap_ptr;
+    }
+  }
+  stats.pixelsWritten += w*h;
+}
+
+void GLCD_Bmp (unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned char *bmp) {
+  // bmp files are stored bottom row first
+  unsigned short *bitmap_ptr = (unsigned short *) bmp;
+  unsigned int i, j;
+
+  for (j = 0; j < h; j++) {
+    for (i = 0; i < w; i++, bitmap_ptr++) {
+      if (x + i < WIDTH && y + h - 1 - j < HEIGHT) frame[y+h-1-j][x+i] = *bitmap_ptr;
+    }
+  }
+  stats.pixelsWritten += w*h;
+}
+
+void GLCD_BitPlane (unsigned int x, unsigned int y, unsigned int w, unsigned int h, const unsigned char *plane, unsigned int stride) {
+  unsigned int i, j;
+  const unsigned char *row;
+
+  if (w == 0 || h == 0 || x + w > WIDTH || y + h > HEIGHT) {
+    // nothing to do, or out of bounds
+    return;
+  }
+  for (j = y; j < y + h; j++) {
+    row = plane + j*stride;
+    for (i = x; i < x + w; i++) {
+      frame[j][i] = (row[i >> 3] & (0x80 >> (i & 7))) ? TextColor : BackColor;
+    }
+  }
+  stats.pixelsWritten += w*h;
+}
+
+void GLCD_ScrollVertical (unsigned int dy) {
+  // Not used in the horizontal orientation (same as the target driver)
+  (void) dy;
+}
+
+/* *********************************************** */
+// Host API
+void vHostGLCDGetStats(hostGLCDStats *out)
+{
+  *out = stats;
+}
+
+// Which 16x24 character is at (x,y) -- anything that is not BackColor counts as ink; '?' if nothing matches
+static char prvMatchChar(unsigned int x, unsigned int y)
+{
+  unsigned short bits[24];
+  unsigned int i, j, c;
+  unsigned int numChars = sizeof(Font_16x24_h) / (24 * sizeof(Font_16x24_h[0]));
+
+  for (j = 0; j < 24; j++) {
+    bits[j] = 0;
+    for (i = 0; i < 16; i++) {
+      if (frame[y+j][x+i] != BackColor) bits[j] |= 0x8000 >> i;
+    }
+  }
+  for (c = 0; c < numChars; c++) {
+    if (memcmp(bits, &Font_16x24_h[c * 24], sizeof(bits)) == 0) return (char) (c + 32);
+  }
+  return '?';
+}
+
+const char *pcHostGLCDLineText(unsigned int line)
+{
+  int col;
+
+  if (line >= lcdNUM_LINES) return "";
+  for (col = 0; col < lcdCHAR_IN_LINE; col++) {
+    lineText[col] = prvMatchChar(col * 16, line * 24);
+  }
+  lineText[lcdCHAR_IN_LINE] = '\0';
+  for (col = lcdCHAR_IN_LINE - 1; (col >= 0) && (lineText[col] == ' '); col--) {
+    lineText[col] = '\0';
+  }
+  return lineText;
+}
+
+int iHostGLCDWritePPM(const char *path)
+{
+  FILE *fp = fopen(path, "wb");
+  unsigned int i, j;
+
+  if (fp == NULL) return -1;
+  fprintf(fp, "P6\n%d %d\n255\n", WIDTH, HEIGHT);
+  for (j = 0; j < HEIGHT; j++) {
+    for (i = 0; i < WIDTH; i++) {
+      unsigned short p = frame[j][i];
+      fputc(((p >> 11) & 0x1F) << 3, fp);
+      fputc(((p >> 5) & 0x3F) << 2, fp);
+      fputc((p & 0x1F) << 3, fp);
+    }
+  }
+  return (fclose(fp) == 0) ? 0 : -1;
+}
@@ -0,0 +1,561 @@
+// Host stand-in for the NXP I2C driver (lpc17xx_i2c.c) and for the two PIC boards on the rover's I2C bus.
+//
+// vtI2C.c is compiled unmodified against this file.  Transfers started with I2C_MasterTransferData()
+//   are carried out by a bus thread that sleeps for as long as the transfer would occupy the bus at
+//   the configured clock rate, runs the slave model and then raises a simulated interrupt that calls
+//   vtI2C0Isr()/vtI2C1Isr() exactly as the NVIC would on the LPC1768.
+//
+// The slave model is a rover in a corridor, straight or with one corner (the course, see vHostRoverSetCourse()):
+//   -- the sensor PIC (0x4F) answers every read with the next sample in a round robin of
+//      IR1 (left), IR2 (front), IR3 (right), motor encoder and accelerometer messages
+//   -- it takes a sample every hostSensorReadyUs and pulses its data-ready line, which is wired to
+//      EINT2 -- this file also stands in for the NXP EXTI driver, and raises the EINT2 interrupt
+//      (vtSensorReadyIsr()) once the application has configured the line and enabled it in the NVIC
+//   -- the motor PIC (0x4D, and 0x4F for the 0x34 command) takes {0x34,count,speed,radius} commands
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* include files. */
+#include "lpc17xx_i2c.h"
+#include "lpc17xx_pinsel.h"
+#include "lpc17xx_exti.h"
+#include "I2CTaskMsgTypes.h"
+#include "hostPeripherals.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+#define hostI2CUnits 3
+
+// Rover geometry (cm)
+#define hostRoverHalfTrack 8.0
+// Range over which the Sharp IR sensors give a usable reading (cm)
+#define hostIRMinRange 8.0
+#define hostIRMaxRange 80.0
+// Longest time step used when moving the rover (s)
+#define hostMaxStep 0.1
+
+// How often the sensor PIC takes a sample and pulses its data-ready line (us)
+//   -- one sample of each of the five types every 50ms, the rate the Nav timer polls at
+#define hostSensorReadyUs 10000
+
+// Motor command opcode and the radius byte that means "straight"
+#define hostMotorCmd 0x34
+#define hostRadiusStraight 127
+
+typedef struct __hostI2CUnit {
+	uint32_t clockRate;
+	unsigned long interrupt;
+	I2C_M_SETUP_Type * volatile transfer;	// transfer handed to the bus thread
+	volatile uint32_t complete;		// reported (once) by I2C_MasterTransferComplete()
+	int started;
+	pthread_t thread;
+	sem_t start;					// posted to start a transfer -- sem_post() is safe in the (signal based) interrupt handlers
+} hostI2CUnit;
+
+LPC_I2C_TypeDef hostI2CRegs[hostI2CUnits];
+
+static hostI2CUnit units[hostI2CUnits] = {
+	{ 0, hostINTERRUPT_I2C0 },
+	{ 0, hostINTERRUPT_I2C1 },
+	{ 0, hostINTERRUPT_I2C2 },
+};
+
+// The rover model and the statistics are shared by all the bus threads
+static pthread_mutex_t roverMutex = PTHREAD_MUTEX_INITIALIZER;
+static hostI2CStats stats;
+
+// The default course is a corridor with a wall at each end
+static hostCourse course = { 300.0, 60.0, 40.0, 30.0, 0.0, 260.0, 0.0 };
+
+static struct {
+	double x, y, heading;			// cm, cm, radians (0 = +x, counter clockwise)
+	double speed, turnRate;			// cm/s, rad/s
+	double leftTravel, rightTravel;	// wheel travel since the last encoder read (cm)
+	unsigned long lastUpdateUs;
+	int blocked;					// against a wall
+	unsigned int nextSample;
+	uint8_t counts[5];
+	unsigned long lastIRSampleUs;	// when the last IR sample was served
+	int irSamplePending;			// an IR sample has been served since the last motor command
+	unsigned long lastReadyUs;		// when the sensor PIC last took a sample
+	unsigned long startUs;			// when the rover was first told to move
+} rover = { 40.0, 30.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0, 0, {0,0,0,0,0}, 0, 0, 0, 0 };
+
+// The data-ready line: set up by EXTI_Config() and delivered once the NVIC has it enabled
+static volatile int readyLineConfigured;
+static int readyThreadStarted;
+static pthread_t readyThread;
+
+// Sample types in the order the sensor PIC sends them
+static const uint8_t sampleTypes[5] = {
+	vtI2CMsgTypeIRRead1, vtI2CMsgTypeIRRead2, vtI2CMsgTypeIRRead3, vtI2CMsgTypeMotorRead, vtI2CMsgTypeAccRead
+};
+
+extern void vtI2C0Isr(void);
+extern void vtI2C1Isr(void);
+extern void vtI2C2Isr(void);
+extern void vtSensorReadyIsr(void);
+// end of defs
+/* *********************************************** */
+
+static int prvUnitNum(LPC_I2C_TypeDef *I2Cx)
+{
+	return (int) (I2Cx - hostI2CRegs);
+}
+
+// The course as one or two rectangles {x0,y0,x1,y1}: the first leg, then the second leg if it turns
+static int prvCourseRects(double r[2][4])
+{
+	r[0][0] = 0.0;
+	r[0][1] = 0.0;
+	r[0][2] = course.width;
+	r[0][3] = course.height;
+	if (course.turn == 0.0) {
+		return 1;
+	}
+	r[1][0] = course.width - course.height;
+	r[1][2] = course.width;
+	r[1][1] = (course.turn > 0) ? course.height : course.turn;
+	r[1][3] = (course.turn > 0) ? course.height + course.turn : 0.0;
+	return 2;
+}
+
+static int prvInRect(const double *r,double x,double y)
+{
+	return (x >= r[0] - 1e-6) && (x <= r[2] + 1e-6) && (y >= r[1] - 1e-6) && (y <= r[3] + 1e-6);
+}
+
+static int prvOnCourse(double x,double y)
+{
+	double r[2][4];
+	int i, n = prvCourseRects(r);
+
+	for (i=0;i<n;i++) {
+		if (prvInRect(r[i],x,y)) return 1;
+	}
+	return 0;
+}
+
+// Distance from (x,y) inside rectangle r along (dx,dy) to its edge
+static double prvRayToEdge(const double *r,double x,double y,double dx,double dy)
+{
+	double best = 1e9, t;
+
+	if (dx > 1e-9) { t = (r[2] - x)/dx; if (t < best) best = t; }
+	if (dx < -1e-9) { t = (r[0] - x)/dx; if (t < best) best = t; }
+	if (dy > 1e-9) { t = (r[3] - y)/dy; if (t < best) best = t; }
+	if (dy < -1e-9) { t = (r[1] - y)/dy; if (t < best) best = t; }
+	return (best < 0) ? 0 : best;
+}
+
+// Distance from (x,y) along heading h to the course wall
+//   A ray that leaves one leg through the opening into the other carries on in that one
+static double prvRayToWall(double x,double y,double h)
+{
+	double dx = cos(h), dy = sin(h);
+	double r[2][4];
+	double t = 0.0, step, d;
+	int i, k, n = prvCourseRects(r);
+
+	for (k=0;k<n+1;k++) {
+		step = 0.0;
+		for (i=0;i<n;i++) {
+			if (prvInRect(r[i],x + t*dx,y + t*dy)) {
+				d = prvRayToEdge(r[i],x + t*dx,y + t*dy,dx,dy);
+				if (d > step) step = d;
+			}
+		}
+		if (step < 1e-6) break;
+		t += step;
+	}
+	return t;
+}
+
+// Whether the rover is past the finish line
+static int prvPastFinish(void)
+{
+	if (course.turn == 0.0) {
+		return rover.x >= course.finishX;
+	}
+	return (course.turn > 0) ? (rover.y >= course.height + course.finishX) : (rover.y <= -course.finishX);
+}
+
+// 10-bit ADC reading that the distance task will turn back into d cm
+//   (inverse of the curve fit used in distance.c)
+static uint16_t prvIRReading(double d)
+{
+	double volts, adc;
+
+	if (d < hostIRMinRange) d = hostIRMinRange;
+	if (d > hostIRMaxRange) d = hostIRMaxRange;
+	volts = log(d/102.5149651)/log(.3091605258);
+	adc = volts*1024.0/5.0;
+	if (adc < 0) adc = 0;
+	if (adc > 1023) adc = 1023;
+	return (uint16_t) (adc + 0.5);
+}
+
+// Move the rover up to "now" -- must hold roverMutex
+static void prvRoverAdvance(unsigned long now)
+{
+	double dt = (rover.lastUpdateUs == 0) ? 0.0 : (now - rover.lastUpdateUs)/1000000.0;
+	rover.lastUpdateUs = now;
+
+	while (dt > 0) {
+		double step = (dt > hostMaxStep) ? hostMaxStep : dt;
+		double dist = rover.speed*step;
+		double nx = rover.x + dist*cos(rover.heading);
+		double ny = rover.y + dist*sin(rover.heading);
+
+		dt -= step;
+		rover.heading += rover.turnRate*step;
+		rover.leftTravel += (rover.speed - rover.turnRate*hostRoverHalfTrack)*step;
+		rover.rightTravel += (rover.speed + rover.turnRate*hostRoverHalfTrack)*step;
+		if (!prvOnCourse(nx,ny)) {
+			if (!rover.blocked) stats.collisions++;
+			rover.blocked = 1;
+		} else {
+			rover.blocked = 0;
+			rover.x = nx;
+			rover.y = ny;
+		}
+	}
+	if ((stats.lapMicroseconds == 0) && (rover.startUs != 0) && prvPastFinish()) {
+		stats.lapMicroseconds = now - rover.startUs;
+	}
+}
+
+// Apply a motor command {0x34,count,speed,radius}
+//   radius 127 is straight, 0..126 turns left (0 = spin in place), 128..255 turns right (128 = spin)
+static void prvRoverCommand(const uint8_t *cmd,unsigned long now)
+{
+	double speed = cmd[2];
+	int radius = cmd[3];
+	double r;
+
+	if ((rover.startUs == 0) && (speed > 0)) {
+		rover.startUs = now;
+	}
+	if (radius == hostRadiusStraight) {
+		rover.speed = speed;
+		rover.turnRate = 0.0;
+	} else if ((radius == 0) || (radius == 128)) {
+		rover.speed = 0.0;
+		rover.turnRate = ((radius == 0) ? 1.0 : -1.0) * speed/hostRoverHalfTrack;
+	} else {
+		r = (radius < 128) ? radius : (radius - 128);
+		rover.speed = speed;
+		rover.turnRate = ((radius < 128) ? 1.0 : -1.0) * speed/r;
+	}
+}
+
+// Fill in the next sample from the sensor PIC -- must hold roverMutex
+static void prvSensorSample(uint8_t *buf,int len,unsigned long now)
+{
+	uint8_t sample[4];
+	uint8_t type = sampleTypes[rover.nextSample];
+	uint16_t reading;
+	int i;
+
+	sample[0] = type;
+	sample[1] = rover.counts[rover.nextSample]++;
+	switch (type) {
+	case vtI2CMsgTypeIRRead1:
+	case vtI2CMsgTypeIRRead2:
+	case vtI2CMsgTypeIRRead3: {
+		double offset = (type == vtI2CMsgTypeIRRead1) ? M_PI/2 : ((type == vtI2CMsgTypeIRRead3) ? -M_PI/2 : 0.0);
+		reading = prvIRReading(prvRayToWall(rover.x,rover.y,rover.heading + offset));
+		sample[2] = reading >> 8;
+		sample[3] = reading & 0xFF;
+		rover.lastIRSampleUs = now;
+		rover.irSamplePending = 1;
+		break;
+	}
+	case vtI2CMsgTypeMotorRead: {
+		// left then right wheel travel (cm) since the last read, as mapping.c reads them -- the part of a cm
+		//   not reported is kept for the next read, as the PIC's encoder counts are
+		sample[2] = (uint8_t) (fabs(rover.leftTravel) + 0.5);
+		sample[3] = (uint8_t) (fabs(rover.rightTravel) + 0.5);
+		rover.leftTravel -= copysign(sample[2],rover.leftTravel);
+		rover.rightTravel -= copysign(sample[3],rover.rightTravel);
+		break;
+	}
+	default: {
+		sample[2] = 0;
+		sample[3] = 0;
+		break;
+	}
+	}
+	rover.nextSample = (rover.nextSample + 1) % 5;
+	for (i=0;i<len;i++) {
+		buf[i] = (i < 4) ? sample[i] : 0;
+	}
+	stats.sensorReads++;
+	// how long the sample sat in the PIC before it was read
+	if (rover.lastReadyUs != 0) {
+		unsigned long age = now - rover.lastReadyUs;
+		stats.sensorAgeTotalUs += age;
+		if (age > stats.sensorAgeMaxUs) stats.sensorAgeMaxUs = age;
+	}
+}
+
+// Run one transfer against the slave model; returns the number of bus bits it took
+static unsigned long prvRunSlaves(I2C_M_SETUP_Type *cfg)
+{
+	unsigned long now = ulPortGetMicroseconds();
+	unsigned long bits = 0;
+	const uint8_t *tx = (const uint8_t *) cfg->tx_data;
+	int known = (cfg->sl_addr7bit == hostI2CSensorAddr) || (cfg->sl_addr7bit == hostI2CMotorAddr);
+
+	cfg->tx_count = 0;
+	cfg->rx_count = 0;
+	pthread_mutex_lock(&roverMutex);
+	prvRoverAdvance(now);
+	// An unknown slave NACKs its address; the driver restarts the transfer until it runs out of retries
+	if (!known) {
+		unsigned long attempts = cfg->retransmissions_max + 1;
+		bits = attempts*(9 + 2);
+		cfg->retransmissions_count = cfg->retransmissions_max;
+		cfg->status = I2C_I2STAT_M_TX_SLAW_NACK | I2C_SETUP_STATUS_NOACKF;
+		stats.transactions++;
+		stats.bytes += attempts;
+		pthread_mutex_unlock(&roverMutex);
+		return bits;
+	}
+	if (cfg->tx_length > 0) {
+		cfg->tx_count = cfg->tx_length;
+		bits += 9*(1 + cfg->tx_length);
+		if ((cfg->tx_length >= 4) && (tx[0] == hostMotorCmd)) {
+			prvRoverCommand(tx,now);
+			stats.motorCommands++;
+			if (rover.irSamplePending) {
+				unsigned long latency = now - rover.lastIRSampleUs;
+				rover.irSamplePending = 0;
+				stats.latencySamples++;
+				stats.latencyTotalUs += latency;
+				if ((stats.latencyMinUs == 0) || (latency < stats.latencyMinUs)) stats.latencyMinUs = latency;
+				if (latency > stats.latencyMaxUs) stats.latencyMaxUs = latency;
+			}
+		}
+	}
+	if (cfg->rx_length > 0) {
+		if (cfg->sl_addr7bit == hostI2CSensorAddr) {
+			prvSensorSample((uint8_t *) cfg->rx_data,cfg->rx_length,now);
+		} else {
+			memset(cfg->rx_data,0,cfg->rx_length);
+		}
+		cfg->rx_count = cfg->rx_length;
+		bits += 9*(1 + cfg->rx_length);
+	}
+	// start and stop conditions
+	bits += 2;
+	cfg->status = I2C_I2STAT_M_RX_DAT_NACK | I2C_SETUP_STATUS_DONE;
+	stats.transactions++;
+	stats.bytes += (bits - 2)/9;
+	pthread_mutex_unlock(&roverMutex);
+	return bits;
+}
+
+// Hold the bus for the time the transfer takes on the wire
+static void prvBusDelay(hostI2CUnit *unit,unsigned long bits)
+{
+	unsigned long us = (bits*1000000UL)/unit->clockRate;
+
+	vPortSleepMicroseconds(us);
+	pthread_mutex_lock(&roverMutex);
+	stats.busMicroseconds += us;
+	pthread_mutex_unlock(&roverMutex);
+}
+
+static void prvTransfer(hostI2CUnit *unit,I2C_M_SETUP_Type *cfg)
+{
+	prvBusDelay(unit,prvRunSlaves(cfg));
+}
+
+// One thread per bus plays the part of the I2C state machine
+static void *prvBusThread(void *arg)
+{
+	hostI2CUnit *unit = (hostI2CUnit *) arg;
+	I2C_M_SETUP_Type *cfg;
+
+	for (;;) {
+		vPortHostThreadWait();
+		while (sem_wait(&unit->start) != 0);
+		cfg = unit->transfer;
+
+		prvTransfer(unit,cfg);
+
+		__sync_fetch_and_or(&unit->complete,1);
+		vPortGenerateSimulatedInterrupt(unit->interrupt);
+	}
+	return NULL;
+}
+
+// The sensor PIC's sampling clock -- pulses the data-ready line after each sample
+static void *prvReadyThread(void *arg)
+{
+	unsigned long next, now;
+
+	(void) arg;
+	next = ulPortGetMicroseconds();
+	for (;;) {
+		// keep to the sample clock even if a sleep runs long
+		next += hostSensorReadyUs;
+		now = ulPortGetMicroseconds();
+		if ((long) (next - now) > 0) {
+			vPortSleepMicroseconds(next - now);
+		}
+		pthread_mutex_lock(&roverMutex);
+		rover.lastReadyUs = ulPortGetMicroseconds();
+		pthread_mutex_unlock(&roverMutex);
+		if (readyLineConfigured && hostNVICEnabled[EINT2_IRQn]) {
+			vPortGenerateSimulatedInterrupt(hostINTERRUPT_EINT2);
+		}
+	}
+	return NULL;
+}
+
+// Start a thread with the simulated interrupts blocked, as they must only be taken by the task threads
+static void prvStartThread(pthread_t *thread,void *(*fn)(void *),void *arg,const char *name)
+{
+	sigset_t all, saved;
+
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK,&all,&saved);
+	vPortHostThreadWake();
+	if (pthread_create(thread,NULL,fn,arg) != 0) {
+		fprintf(stderr,"%s: cannot create thread\n",name);
+		abort();
+	}
+	pthread_sigmask(SIG_SETMASK,&saved,NULL);
+}
+
+// Simulated interrupt handlers -- the vt handlers do their own portEND_SWITCHING_ISR()
+static unsigned long prvI2C0Interrupt(void) { vtI2C0Isr(); return pdFALSE; }
+static unsigned long prvI2C1Interrupt(void) { vtI2C1Isr(); return pdFALSE; }
+static unsigned long prvI2C2Interrupt(void) { vtI2C2Isr(); return pdFALSE; }
+static unsigned long prvEINT2Interrupt(void) { vtSensorReadyIsr(); return pdFALSE; }
+
+/* *********************************************** */
+// NXP driver API used by vtI2C.c
+void I2C_Init(LPC_I2C_TypeDef *I2Cx, uint32_t clockrate)
+{
+	static unsigned long (* const handlers[hostI2CUnits])(void) = { prvI2C0Interrupt, prvI2C1Interrupt, prvI2C2Interrupt };
+	int num = prvUnitNum(I2Cx);
+	hostI2CUnit *unit = &units[num];
+
+	unit->clockRate = clockrate;
+	vPortSetInterruptHandler(unit->interrupt,handlers[num]);
+	if (!unit->started) {
+		sem_init(&unit->start,0,0);
+		prvStartThread(&unit->thread,prvBusThread,unit,"I2C bus");
+		unit->started = 1;
+	}
+	// The sensor PIC starts sampling when it is powered, whether or not anyone listens to data-ready
+	if (!readyThreadStarted) {
+		prvStartThread(&readyThread,prvReadyThread,NULL,"sensor PIC");
+		readyThreadStarted = 1;
+	}
+}
+
+void I2C_Cmd(LPC_I2C_TypeDef* I2Cx, FunctionalState NewState)
+{
+	if (NewState == ENABLE) {
+		I2Cx->I2CONSET = I2C_I2CONSET_I2EN;
+	} else {
+		I2Cx->I2CONCLR = I2C_I2CONCLR_I2ENC;
+	}
+}
+
+Status I2C_MasterTransferData(LPC_I2C_TypeDef *I2Cx, I2C_M_SETUP_Type *TransferCfg, I2C_TRANSFER_OPT_Type Opt)
+{
+	hostI2CUnit *unit = &units[prvUnitNum(I2Cx)];
+
+	if (Opt == I2C_TRANSFER_POLLING) {
+		prvTransfer(unit,TransferCfg);
+		return (TransferCfg->status & I2C_SETUP_STATUS_DONE) ? SUCCESS : ERROR;
+	}
+	// May be called from the interrupt handler to start the next transfer of a batch
+	unit->transfer = TransferCfg;
+	__sync_synchronize();
+	vPortHostThreadWake();
+	sem_post(&unit->start);
+	// With virtual time the slaves answer before the clock can move on
+	vPortWaitForHostThreads();
+	return SUCCESS;
+}
+
+void I2C_MasterHandler(LPC_I2C_TypeDef *I2Cx)
+{
+	// The bus thread has already moved all of the data
+	I2Cx->I2STAT = I2C_I2STAT_NO_INF;
+}
+
+uint32_t I2C_MasterTransferComplete(LPC_I2C_TypeDef *I2Cx)
+{
+	return __sync_fetch_and_and(&units[prvUnitNum(I2Cx)].complete,0);
+}
+
+void PINSEL_ConfigPin(PINSEL_CFG_Type *PinCfg)
+{
+	(void) PinCfg;
+}
+
+/* *********************************************** */
+// NXP EXTI driver API -- only EINT2 (the data-ready line) is connected to anything
+void EXTI_Init(void)
+{
+	readyLineConfigured = 0;
+}
+
+void EXTI_Config(EXTI_InitTypeDef *EXTICfg)
+{
+	if (EXTICfg->EXTI_Line == EXTI_EINT2) {
+		vPortSetInterruptHandler(hostINTERRUPT_EINT2,prvEINT2Interrupt);
+		readyLineConfigured = (EXTICfg->EXTI_Mode == EXTI_MODE_EDGE_SENSITIVE);
+	}
+}
+
+void EXTI_ClearEXTIFlag(EXTI_LINE_ENUM EXTILine)
+{
+	(void) EXTILine;
+}
+
+/* *********************************************** */
+// Host API
+void vHostI2CGetStats(hostI2CStats *out)
+{
+	pthread_mutex_lock(&roverMutex);
+	*out = stats;
+	pthread_mutex_unlock(&roverMutex);
+}
+
+void vHostRoverSetCourse(const hostCourse *c)
+{
+	pthread_mutex_lock(&roverMutex);
+	course = *c;
+	rover.x = c->startX;
+	rover.y = c->startY;
+	rover.heading = c->startHeading*M_PI/180.0;
+	pthread_mutex_unlock(&roverMutex);
+}
+
+void vHostRoverGetPose(float *x,float *y,float *headingDeg)
+{
+	pthread_mutex_lock(&roverMutex);
+	*x = (float) rover.x;
+	*y = (float) rover.y;
+	*headingDeg = (float) (fmod(rover.heading*180.0/M_PI,360.0));
+	pthread_mutex_unlock(&roverMutex);
+}
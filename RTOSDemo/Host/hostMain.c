@@ -0,0 +1,685 @@
+// Host (POSIX) entry point for the rover application
+//
+// Starts the same task graph as MainFiles/main.c (with USE_NAV set) on the FreeRTOS POSIX port,
+//   with the I2C, LCD and network hardware replaced by the stand-ins in this directory.  After the
+//   requested run time the scheduler is stopped and a report is printed: I2C bus traffic, the
+//   sensor-to-motor-command latency, the CPU time used by each task and the LCD contents.
+//
+// Usage: rover_host [-t seconds] [-b i2c_hz] [-s start_ms] [-o lcd.ppm] [-T trace.bin] [-p] [-x scale]
+//        rover_host -B params [-n courses | -c courses] [-j jobs] [-t seconds] [-b i2c_hz] [-p]
+//   -t  how long to run (default 10 seconds; in a batch, the longest a run may take, default 60)
+//   -b  I2C bus clock (default 100000, up to 400000 for Fast-mode)
+//   -s  when the operator presses "start" on the web page (default 1000 ms, 0 = never)
+//   -o  write the final LCD contents to a PPM image
+//   -T  write the kernel event trace (the last vtTraceLen events, see vtTrace.h) to a file for trace_decode
+//   -p  poll the sensors from the Nav timer instead of reading on the data-ready interrupt
+//       (main.c with USE_SENSOR_READY set to 0)
+//   -x  run the clock this many times faster than real time (see vPortSetTimeScale())
+//
+// Batch mode (any of -B, -n or -c) runs every navigation parameter set on every course, without the
+//   LCD task, and prints a summary of lap time, collisions and motor commands for each parameter set:
+//   -B  parameter sets, one to a line, as key=value pairs changing the defaults.  The keys are the vtNavParams
+//       fields: safeZone, frontSafeZone, frontHysteresis, driveSpeed, pivotSpeed, steerKp and steerKd, e.g.
+//         safeZone=20 frontSafeZone=25 driveSpeed=18 steerKp=24576
+//       (a line with nothing on it but a comment is skipped; without -B only the defaults are run)
+//   -n  generate this many courses (default 8): straight corridors, and every second one with a corner
+//       at the far end, turning left and right in turn
+//   -c  read the courses from a file instead, one to a line: width height startX startY heading finishX [turn]
+//       (see hostCourse; a turn of 0, or none, is a straight corridor -- e.g. "300 60 40 30 0 110 150" turns
+//       left into a 150 cm second leg and finishes 110 cm into it)
+//   -j  how many runs at a time (default the number of processors)
+//   Each run is a child process, as the scheduler cannot be started twice.  A run is over when the
+//   rover crosses the finish line or after -t seconds.  The runs are on virtual time (see
+//   vPortSetVirtualTime()): the clock moves on whenever every task is blocked, so a run takes as long
+//   as the host needs to compute it, and the same parameter set on the same course always gives the
+//   same lap.
+//
+// Exits with status 1 if no sensor samples or motor commands made it through the task graph (in a
+//   batch, if no run finished its lap).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* include files. */
+#include "vtUtilities.h"
+#include "lcdTask.h"
+#include "navigation.h"
+#include "mapping.h"
+#include "mapGrid.h"
+#include "vtI2C.h"
+#include "myTimers.h"
+#include "conductor.h"
+#include "sensorBus.h"
+#include "sensorReady.h"
+#include "motor.h"
+#include "distance.h"
+#include "testing.h"
+#include "GLCD.h"
+#include "hostPeripherals.h"
+#include "vtTrace.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+// Same priorities as main.c
+#define mainUIP_TASK_PRIORITY				( tskIDLE_PRIORITY)
+#define mainLCD_TASK_PRIORITY				( tskIDLE_PRIORITY)
+#define mainI2CMONITOR_TASK_PRIORITY		( tskIDLE_PRIORITY)
+#define mainNAV_TASK_PRIORITY				( tskIDLE_PRIORITY)
+#define mainMAP_TASK_PRIORITY				( tskIDLE_PRIORITY)
+#define mainDISTANCE_TASK_PRIORITY			( tskIDLE_PRIORITY)
+#define mainSENSOR_READY_TASK_PRIORITY		( tskIDLE_PRIORITY + 1)
+// Ahead of the tasks that ask for motor commands, so a command goes out as soon as it is asked for
+#define mainMOTOR_TASK_PRIORITY				( tskIDLE_PRIORITY + 1)
+#define mainBASIC_WEB_STACK_SIZE            ( configMINIMAL_STACK_SIZE * 4 )
+
+// The report task has to get in ahead of everything else to stop the run on time
+#define hostREPORT_TASK_PRIORITY			( configMAX_PRIORITIES - 1 )
+#define hostRunTimeStatsLen 1024
+// How often a batch run checks for the end of the lap
+#define hostLapPollMs 100
+#define hostBatchRunSeconds 60
+#define hostBatchCourses 8
+#define hostBatchMaxLine 256
+
+extern void vuIP_Task( void *pvParameters );
+
+static vtI2CStruct vtI2C0;
+static vtNavStruct navData;
+static vtMapStruct mapData;
+static vtConductorStruct conductorData;
+static vtTestStruct vtTestData;
+static vtLCDStruct vtLCDdata;
+static vtDistanceStruct distanceData;
+static vtSensorReadyStruct sensorReadyData;
+static vtMotorStruct motorData;
+
+static unsigned long runSeconds = 10;
+static const char *ppmPath = NULL;
+static const char *tracePath = NULL;
+static uint32_t i2cSpeed = vtI2CStandardMode;
+static int pollSensors = 0;
+static unsigned long timeScale = 1;
+
+// Batch mode: the parameter sets, the courses and what each run came to
+typedef struct __hostBatchResult {
+	unsigned long lapMicroseconds;	// 0 if the lap was not finished
+	unsigned long collisions;
+	unsigned long motorCommands;
+} hostBatchResult;
+
+static int batchMode = 0;
+static int runSecondsSet = 0;
+static vtNavParams *paramSets = NULL;
+static int numParamSets = 0;
+static hostCourse *courses = NULL;
+static int numCourses = 0;
+
+// Captured by the report task before the scheduler is stopped
+static signed char runTimeStats[hostRunTimeStatsLen];
+static hostI2CStats i2cStats;
+static vtI2CStats i2c0Stats;
+static vtI2CSlaveStats i2c0Slaves[vtI2CMaxSlaves];
+static int i2c0NumSlaves;
+static vtMotorStats motorStats;
+// Sensor bus samples each task missed because its queue was full
+static unsigned long mapDropped, navDropped, distanceDropped, motorDropped;
+static vtMapGridStats gridStats;
+static vtMapGridPose gridPose;
+static int gridFreeAhead;
+static hostGLCDStats lcdStats;
+static portTickType ticksRun;
+static unsigned long runTimeBase;
+// TIM0 is stopped until the scheduler starts it, so events traced before then are at 0
+static int runTimeStarted = 0;
+// end of defs
+/* *********************************************** */
+
+static void prvReportTask( void *pvParameters )
+{
+	portTickType xStartTime;
+
+	( void ) pvParameters;
+
+	if( batchMode )
+	{
+		// A batch run ends early once the lap is over
+		xStartTime = xTaskGetTickCount();
+		do
+		{
+			vTaskDelay( hostLapPollMs / portTICK_RATE_MS );
+			vHostI2CGetStats( &i2cStats );
+		} while( ( i2cStats.lapMicroseconds == 0 ) &&
+				 ( ( xTaskGetTickCount() - xStartTime ) < ( runSeconds * 1000UL ) / portTICK_RATE_MS ) );
+	}
+	else
+	{
+		vTaskDelay( ( runSeconds * 1000UL ) / portTICK_RATE_MS );
+	}
+	ticksRun = xTaskGetTickCount();
+	vTaskGetRunTimeStats( runTimeStats );
+	vHostI2CGetStats( &i2cStats );
+	vtI2CGetStats( &vtI2C0, &i2c0Stats );
+	i2c0NumSlaves = vtI2CGetSlaveStats( &vtI2C0, i2c0Slaves, vtI2CMaxSlaves );
+	vtMotorGetStats( &motorData, &motorStats );
+	mapDropped = vtSensorDropped( &mapData );
+	navDropped = vtSensorDropped( &navData );
+	distanceDropped = vtSensorDropped( &distanceData );
+	motorDropped = vtSensorDropped( &motorData );
+	vtMapGridGetStats( &gridStats );
+	vtMapGridGetPose( &gridPose );
+	gridFreeAhead = vtMapGridFreeAhead();
+	vHostGLCDGetStats( &lcdStats );
+	vtTraceStop();
+	vTaskEndScheduler();
+}
+
+static void prvPrintReport( void )
+{
+	float x, y, heading;
+	unsigned int i;
+
+	printf( "Ran for %lu ticks (%lu ms per tick)\n", ( unsigned long ) ticksRun, ( unsigned long ) portTICK_RATE_MS );
+	printf( "\nI2C bus\n" );
+	printf( "  transactions      %lu\n", i2cStats.transactions );
+	printf( "  bytes             %lu\n", i2cStats.bytes );
+	printf( "  bus busy          %lu us (%.1f%%)\n", i2cStats.busMicroseconds,
+			( ticksRun > 0 ) ? ( 100.0 * i2cStats.busMicroseconds ) / ( ticksRun * portTICK_RATE_MS * 1000.0 ) : 0.0 );
+	printf( "  sensor samples    %lu\n", i2cStats.sensorReads );
+	printf( "  motor commands    %lu\n", i2cStats.motorCommands );
+	if( i2cStats.latencySamples > 0 )
+	{
+		printf( "  sensor->motor     min %lu us  avg %lu us  max %lu us  (%lu samples)\n", i2cStats.latencyMinUs,
+				i2cStats.latencyTotalUs / i2cStats.latencySamples, i2cStats.latencyMaxUs, i2cStats.latencySamples );
+	}
+	if( i2cStats.sensorReads > 0 )
+	{
+		printf( "  sample age        avg %lu us  max %lu us  (%s)\n", i2cStats.sensorAgeTotalUs / i2cStats.sensorReads,
+				i2cStats.sensorAgeMaxUs, pollSensors ? "Nav timer poll" : "data-ready interrupt" );
+	}
+	printf( "  I2C0 at %lu Hz  (vtI2C counters)\n", ( unsigned long ) i2cSpeed );
+	printf( "    transactions    %lu\n", i2c0Stats.transactions );
+	printf( "    bytes           %lu\n", i2c0Stats.bytes );
+	printf( "    NACKs           %lu\n", i2c0Stats.nacks );
+	printf( "    retransmissions %lu\n", i2c0Stats.retransmissions );
+	printf( "    bus busy        %lu us\n", i2c0Stats.busyMicroseconds );
+	printf( "    dropped         %lu\n", i2c0Stats.dropped );
+	for( i = 0; i < ( unsigned int ) i2c0NumSlaves; i++ )
+	{
+		printf( "    slave 0x%02x      %lu transactions  %lu bytes  %lu NACKs  %lu retransmissions  %lu us busy  %lu dropped\n",
+				i2c0Slaves[ i ].slvAddr, i2c0Slaves[ i ].stats.transactions, i2c0Slaves[ i ].stats.bytes,
+				i2c0Slaves[ i ].stats.nacks, i2c0Slaves[ i ].stats.retransmissions,
+				i2c0Slaves[ i ].stats.busyMicroseconds, i2c0Slaves[ i ].stats.dropped );
+	}
+	printf( "  sensor bus drops  map %lu  nav %lu  distance %lu  motor %lu\n", mapDropped, navDropped, distanceDropped,
+			motorDropped );
+	printf( "  motor task        %lu requests  %lu sent  %lu repeats dropped  %lu replaced\n", motorStats.requests,
+			motorStats.sent, motorStats.repeats, motorStats.replaced );
+	printf( "                    %lu written  %lu failed  %lu resent  worst request->written %lu ms\n",
+			motorStats.written, motorStats.failed, motorStats.resent,
+			( unsigned long ) ( motorStats.maxLatency * portTICK_RATE_MS ) );
+	vHostRoverGetPose( &x, &y, &heading );
+	printf( "  rover at          (%.1f, %.1f) cm heading %.0f deg, %lu collisions\n", x, y, heading, i2cStats.collisions );
+
+	printf( "\nOccupancy grid\n" );
+	printf( "  pose              (%.1f, %.1f) cm from the start, heading %.0f deg\n", gridPose.x/256.0, gridPose.y/256.0,
+			gridPose.heading*360.0/65536.0 );
+	printf( "  rays              %lu  (%lu cells, %lu clipped) from %lu moves\n", gridStats.rays, gridStats.cellsTraced,
+			gridStats.clipped, gridStats.moves );
+	printf( "  cells             %lu free  %lu maybe  %lu wall  %lu unknown\n", gridStats.cells[vtMapGridFree],
+			gridStats.cells[vtMapGridMaybe], gridStats.cells[vtMapGridWall], gridStats.cells[vtMapGridUnknown] );
+	printf( "  free ahead        %d cm\n", gridFreeAhead );
+
+	printf( "\nLCD\n" );
+	printf( "  pixels written    %lu\n", lcdStats.pixelsWritten );
+	for( i = 0; i < lcdNUM_LINES; i++ )
+	{
+		printf( "  %2u |%-*s|\n", i, lcdCHAR_IN_LINE, pcHostGLCDLineText( i ) );
+	}
+
+	printf( "\nTask            Abs time (us)     %% time\n%s", ( char * ) runTimeStats );
+}
+
+static void prvUsage( const char *name )
+{
+	fprintf( stderr, "usage: %s [-t seconds] [-b i2c_hz] [-s start_ms] [-o lcd.ppm] [-T trace.bin] [-p] [-x scale]\n", name );
+	fprintf( stderr, "       %s -B params [-n courses | -c courses] [-j jobs] [-t seconds] [-b i2c_hz] [-p]\n", name );
+	exit( 2 );
+}
+
+// Create the same tasks as main.c; without an LCD the LCD task is left out
+static void prvStartTasks( vtLCDStruct *lcd, const vtNavParams *tuning )
+{
+	vtInitLED();
+	vtTraceStart();
+
+	/* Create the uIP task.  The WEB server runs in this task. */
+	xTaskCreate( vuIP_Task, ( signed char * ) "uIP", mainBASIC_WEB_STACK_SIZE, ( void * ) NULL, mainUIP_TASK_PRIORITY, NULL );
+
+	if (lcd != NULL) {
+		StartLCDTask(lcd,mainLCD_TASK_PRIORITY);
+	}
+
+	// Initialize I2C0 for I2C0 at the requested I2C clock speed (100KHz unless -b is given)
+	if (vtI2CInit(&vtI2C0,0,mainI2CMONITOR_TASK_PRIORITY,i2cSpeed,lcd) != vtI2CInitSuccess) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	vStartMotorTask(&motorData,mainMOTOR_TASK_PRIORITY,&vtI2C0,lcd,&vtTestData);
+	vStartNavTask(&navData,mainNAV_TASK_PRIORITY,&vtI2C0,lcd,&mapData,&vtTestData,&motorData);
+	if (tuning != NULL) {
+		vNavSetParams(&navData,tuning);
+	}
+	if (pollSensors) {
+		startTimerForNav(&navData);
+	} else {
+		vStartSensorReadyTask(&sensorReadyData,mainSENSOR_READY_TASK_PRIORITY,&vtI2C0);
+	}
+	vStartMapTask(&mapData,mainMAP_TASK_PRIORITY,&vtI2C0,lcd);
+	vStartDistanceTask(&distanceData,mainDISTANCE_TASK_PRIORITY,&vtI2C0,lcd);
+	vStartConductorTask(&conductorData,&vtI2C0,&navData,&mapData,&distanceData,&motorData);
+
+	xTaskCreate( prvReportTask, ( signed char * ) "Report", configMINIMAL_STACK_SIZE, NULL, hostREPORT_TASK_PRIORITY, NULL );
+}
+
+// Set one vtNavParams field from "key=value"; returns 0 if there is no such key
+static int prvSetParam( vtNavParams *tuning, const char *key, long value )
+{
+	if( strcmp( key, "safeZone" ) == 0 ) tuning->safeZone = value;
+	else if( strcmp( key, "frontSafeZone" ) == 0 ) tuning->frontSafeZone = value;
+	else if( strcmp( key, "frontHysteresis" ) == 0 ) tuning->frontHysteresis = value;
+	else if( strcmp( key, "driveSpeed" ) == 0 ) tuning->driveSpeed = value;
+	else if( strcmp( key, "pivotSpeed" ) == 0 ) tuning->pivotSpeed = value;
+	else if( strcmp( key, "steerKp" ) == 0 ) tuning->steerKp = value;
+	else if( strcmp( key, "steerKd" ) == 0 ) tuning->steerKd = value;
+	else return 0;
+	return 1;
+}
+
+static void prvReadParamSets( const char *path )
+{
+	char line[ hostBatchMaxLine ], *tok, *eq;
+	FILE *f;
+	vtNavParams tuning;
+	int lineNo = 0;
+
+	if( ( f = fopen( path, "r" ) ) == NULL )
+	{
+		perror( path );
+		exit( 2 );
+	}
+	while( fgets( line, sizeof( line ), f ) != NULL )
+	{
+		lineNo++;
+		if( ( tok = strchr( line, '#' ) ) != NULL )
+		{
+			*tok = '\0';
+		}
+		if( ( tok = strtok( line, " \t\r\n" ) ) == NULL )
+		{
+			continue;
+		}
+		vNavGetDefaultParams( &tuning );
+		for( ; tok != NULL; tok = strtok( NULL, " \t\r\n" ) )
+		{
+			if( ( ( eq = strchr( tok, '=' ) ) == NULL ) || ( *eq = '\0', !prvSetParam( &tuning, tok, strtol( eq + 1, NULL, 0 ) ) ) )
+			{
+				fprintf( stderr, "%s:%d: unknown parameter %s\n", path, lineNo, tok );
+				exit( 2 );
+			}
+		}
+		if( ( paramSets = realloc( paramSets, ( numParamSets + 1 ) * sizeof( vtNavParams ) ) ) == NULL )
+		{
+			VT_HANDLE_FATAL_ERROR(0);
+		}
+		paramSets[ numParamSets++ ] = tuning;
+	}
+	fclose( f );
+}
+
+static void prvReadCourses( const char *path )
+{
+	char line[ hostBatchMaxLine ];
+	FILE *f;
+	hostCourse c;
+	int lineNo = 0;
+
+	if( ( f = fopen( path, "r" ) ) == NULL )
+	{
+		perror( path );
+		exit( 2 );
+	}
+	while( fgets( line, sizeof( line ), f ) != NULL )
+	{
+		lineNo++;
+		if( ( line[ strspn( line, " \t\r\n" ) ] == '\0' ) || ( line[ strspn( line, " \t" ) ] == '#' ) )
+		{
+			continue;
+		}
+		c.turn = 0.0;
+		if( sscanf( line, "%lf %lf %lf %lf %lf %lf %lf", &c.width, &c.height, &c.startX, &c.startY, &c.startHeading, &c.finishX, &c.turn ) < 6 )
+		{
+			fprintf( stderr, "%s:%d: expected width height startX startY heading finishX [turn]\n", path, lineNo );
+			exit( 2 );
+		}
+		if( ( courses = realloc( courses, ( numCourses + 1 ) * sizeof( hostCourse ) ) ) == NULL )
+		{
+			VT_HANDLE_FATAL_ERROR(0);
+		}
+		courses[ numCourses++ ] = c;
+	}
+	fclose( f );
+}
+
+// Corridors of different lengths and widths, with the rover set down a little off the middle and
+//   a little crooked.  Every second one turns a corner at the far end (left, then right, and so on), so
+//   that the front sensor and the pivot get used.  Course i is the same every time.
+static void prvGenerateCourses( int n )
+{
+	unsigned int seed;
+	int i;
+
+	if( ( courses = calloc( n, sizeof( hostCourse ) ) ) == NULL )
+	{
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	for( i = 0; i < n; i++ )
+	{
+		seed = i + 1;
+		courses[ i ].width = 200.0 + rand_r( &seed ) % 201;
+		courses[ i ].height = 40.0 + rand_r( &seed ) % 41;
+		courses[ i ].startX = 40.0;
+		courses[ i ].startY = courses[ i ].height / 2.0 + ( ( rand_r( &seed ) % 21 ) - 10 ) * courses[ i ].height / 60.0;
+		courses[ i ].startHeading = ( rand_r( &seed ) % 21 ) - 10;
+		courses[ i ].finishX = courses[ i ].width - 40.0;
+		if( i % 2 )
+		{
+			courses[ i ].turn = 120.0 + rand_r( &seed ) % 81;
+			courses[ i ].finishX = courses[ i ].turn - 40.0;
+			if( i % 4 == 3 )
+			{
+				courses[ i ].turn = -courses[ i ].turn;
+			}
+		}
+	}
+	numCourses = n;
+}
+
+// One run of the batch, in a child process: the result goes back down the pipe
+static void prvBatchRun( const vtNavParams *tuning, const hostCourse *course, int fd )
+{
+	hostBatchResult result;
+
+	vHostRoverSetCourse( course );
+	prvStartTasks( NULL, tuning );
+	vTaskStartScheduler();
+
+	result.lapMicroseconds = i2cStats.lapMicroseconds;
+	result.collisions = i2cStats.collisions;
+	result.motorCommands = i2cStats.motorCommands;
+	if( write( fd, &result, sizeof( result ) ) != sizeof( result ) )
+	{
+		_exit( 1 );
+	}
+	_exit( 0 );
+}
+
+static int prvRunBatch( int jobs )
+{
+	hostBatchResult *results;
+	pid_t *pids;
+	int *fds, *failed;
+	int runs = numParamSets * numCourses, next = 0, running = 0, finished = 0;
+	int i, p, c, status, fd[ 2 ], laps, failures;
+	unsigned long best, total, collisions, commands;
+	pid_t pid;
+
+	results = calloc( runs, sizeof( hostBatchResult ) );
+	pids = calloc( runs, sizeof( pid_t ) );
+	fds = calloc( runs, sizeof( int ) );
+	failed = calloc( runs, sizeof( int ) );
+	if( ( results == NULL ) || ( pids == NULL ) || ( fds == NULL ) || ( failed == NULL ) )
+	{
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	fflush( stdout );
+	while( finished < runs )
+	{
+		// Keep jobs runs going
+		while( ( next < runs ) && ( running < jobs ) )
+		{
+			if( pipe( fd ) != 0 )
+			{
+				perror( "pipe" );
+				exit( 2 );
+			}
+			if( ( pid = fork() ) < 0 )
+			{
+				perror( "fork" );
+				exit( 2 );
+			}
+			if( pid == 0 )
+			{
+				close( fd[ 0 ] );
+				prvBatchRun( &paramSets[ next / numCourses ], &courses[ next % numCourses ], fd[ 1 ] );
+			}
+			close( fd[ 1 ] );
+			pids[ next ] = pid;
+			fds[ next ] = fd[ 0 ];
+			next++;
+			running++;
+		}
+		// and collect whichever ends first
+		if( ( pid = wait( &status ) ) < 0 )
+		{
+			if( errno == EINTR )
+			{
+				continue;
+			}
+			perror( "wait" );
+			exit( 2 );
+		}
+		for( i = 0; ( i < next ) && ( pids[ i ] != pid ); i++ );
+		if( i == next )
+		{
+			continue;
+		}
+		if( !WIFEXITED( status ) || ( WEXITSTATUS( status ) != 0 ) ||
+			( read( fds[ i ], &results[ i ], sizeof( hostBatchResult ) ) != sizeof( hostBatchResult ) ) )
+		{
+			failed[ i ] = 1;
+		}
+		close( fds[ i ] );
+		pids[ i ] = 0;
+		running--;
+		finished++;
+	}
+
+	printf( "%d parameter sets x %d courses, %d at a time, %lu s per run at most\n\n", numParamSets, numCourses,
+			jobs, runSeconds );
+	printf( "set  laps     mean lap  best lap  collisions  commands/run  failed\n" );
+	laps = 0;
+	for( p = 0; p < numParamSets; p++ )
+	{
+		int setLaps = 0;
+
+		best = 0;
+		total = collisions = commands = 0;
+		failures = 0;
+		for( c = 0; c < numCourses; c++ )
+		{
+			hostBatchResult *r = &results[ p * numCourses + c ];
+
+			if( failed[ p * numCourses + c ] )
+			{
+				failures++;
+				continue;
+			}
+			collisions += r->collisions;
+			commands += r->motorCommands;
+			if( r->lapMicroseconds != 0 )
+			{
+				setLaps++;
+				total += r->lapMicroseconds / 1000UL;
+				if( ( best == 0 ) || ( r->lapMicroseconds < best ) )
+				{
+					best = r->lapMicroseconds;
+				}
+			}
+		}
+		printf( "%3d  %4d/%-3d ", p, setLaps, numCourses );
+		if( setLaps > 0 )
+		{
+			printf( "%7.2f s %7.2f s", ( total / ( double ) setLaps ) / 1000.0, best / 1000000.0 );
+		}
+		else
+		{
+			printf( "%9s %9s", "-", "-" );
+		}
+		printf( "  %10lu  %12lu  %6d\n", collisions,
+				( numCourses > failures ) ? commands / ( numCourses - failures ) : 0UL, failures );
+		laps += setLaps;
+	}
+	printf( "\nset  safeZone frontSafeZone frontHysteresis driveSpeed pivotSpeed steerKp steerKd\n" );
+	for( p = 0; p < numParamSets; p++ )
+	{
+		printf( "%3d  %8d %13d %15d %10u %10u %7ld %7ld\n", p, paramSets[ p ].safeZone, paramSets[ p ].frontSafeZone,
+				paramSets[ p ].frontHysteresis, paramSets[ p ].driveSpeed, paramSets[ p ].pivotSpeed,
+				( long ) paramSets[ p ].steerKp, ( long ) paramSets[ p ].steerKd );
+	}
+	free( results );
+	free( pids );
+	free( fds );
+	free( failed );
+	return ( laps > 0 ) ? 0 : 1;
+}
+
+int main( int argc, char *argv[] )
+{
+	int opt;
+	int jobs = 0, generate = 0;
+	const char *paramPath = NULL, *coursePath = NULL;
+
+	while( ( opt = getopt( argc, argv, "t:b:s:o:T:px:B:n:c:j:" ) ) != -1 )
+	{
+		switch( opt )
+		{
+			case 't': runSeconds = strtoul( optarg, NULL, 0 ); runSecondsSet = 1; break;
+			case 'b': i2cSpeed = strtoul( optarg, NULL, 0 ); break;
+			case 's': ulHostEMACAutoStartMs = strtoul( optarg, NULL, 0 ); break;
+			case 'o': ppmPath = optarg; break;
+			case 'T': tracePath = optarg; break;
+			case 'p': pollSensors = 1; break;
+			case 'x': timeScale = strtoul( optarg, NULL, 0 ); break;
+			case 'B': paramPath = optarg; batchMode = 1; break;
+			case 'n': generate = atoi( optarg ); batchMode = 1; break;
+			case 'c': coursePath = optarg; batchMode = 1; break;
+			case 'j': jobs = atoi( optarg ); break;
+			default: prvUsage( argv[ 0 ] );
+		}
+	}
+	if( batchMode )
+	{
+		vPortSetVirtualTime();
+		if( paramPath != NULL )
+		{
+			prvReadParamSets( paramPath );
+		}
+		if( numParamSets == 0 )
+		{
+			if( ( paramSets = malloc( sizeof( vtNavParams ) ) ) == NULL )
+			{
+				VT_HANDLE_FATAL_ERROR(0);
+			}
+			vNavGetDefaultParams( &paramSets[ 0 ] );
+			numParamSets = 1;
+		}
+		if( coursePath != NULL )
+		{
+			prvReadCourses( coursePath );
+		}
+		else
+		{
+			prvGenerateCourses( ( generate > 0 ) ? generate : hostBatchCourses );
+		}
+		if( numCourses == 0 )
+		{
+			fprintf( stderr, "no courses\n" );
+			exit( 2 );
+		}
+		if( !runSecondsSet )
+		{
+			runSeconds = hostBatchRunSeconds;
+		}
+		if( jobs <= 0 )
+		{
+			jobs = ( int ) sysconf( _SC_NPROCESSORS_ONLN );
+		}
+		return prvRunBatch( ( jobs > 0 ) ? jobs : 1 );
+	}
+	if( timeScale > 1 )
+	{
+		vPortSetTimeScale( timeScale );
+	}
+
+	prvStartTasks( &vtLCDdata, NULL );
+
+	/* Start the scheduler -- returns once the report task has stopped it. */
+	vTaskStartScheduler();
+
+	prvPrintReport();
+	if( ( ppmPath != NULL ) && ( iHostGLCDWritePPM( ppmPath ) != 0 ) )
+	{
+		fprintf( stderr, "cannot write %s\n", ppmPath );
+	}
+	if( tracePath != NULL )
+	{
+		FILE *f = fopen( tracePath, "wb" );
+
+		if( ( f == NULL ) || ( fwrite( &vtTraceData, sizeof( vtTraceData ), 1, f ) != 1 ) || ( fclose( f ) != 0 ) )
+		{
+			fprintf( stderr, "cannot write %s\n", tracePath );
+		}
+	}
+	return ( ( i2cStats.sensorReads > 0 ) && ( ( ulHostEMACAutoStartMs == 0 ) || ( i2cStats.motorCommands > 0 ) ) ) ? 0 : 1;
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationTickHook( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationIdleHook( void )
+{
+	// Host equivalent of __WFI(): sleep until the next (simulated) interrupt
+	vPortWaitForInterrupt();
+}
+/*-----------------------------------------------------------*/
+
+void vApplicationStackOverflowHook( xTaskHandle *pxTask, signed char *pcTaskName )
+{
+	( void ) pxTask;
+	( void ) pcTaskName;
+
+	VT_HANDLE_FATAL_ERROR(0);
+}
+/*-----------------------------------------------------------*/
+
+// 1MHz run time stats clock, as TIM0 is set up on the target
+void vConfigureTimerForRunTimeStats( void )
+{
+	runTimeBase = ulPortGetMicroseconds();
+	runTimeStarted = 1;
+}
+
+unsigned long ulGetRunTimeCounterValue( void )
+{
+	return runTimeStarted ? ( ulPortGetMicroseconds() - runTimeBase ) : 0UL;
+}
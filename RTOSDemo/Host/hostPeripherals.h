@@ -0,0 +1,81 @@
+#ifndef HOST_PERIPHERALS_H
+#define HOST_PERIPHERALS_H
+#include <stdint.h>
+
+// Host (POSIX) stand-ins for the peripherals that the rover code talks to.
+//
+// The real drivers (vtI2C.c, the NXP drivers, the GLCD driver, the uIP/EMAC code) are replaced
+//   by the files in this directory so that the unmodified task code in MainFiles can be run and
+//   measured on a workstation.  Nothing here is compiled for the LPC1768.
+
+// Simulated interrupt numbers used with vPortGenerateSimulatedInterrupt()
+//   (0 and 1 are taken by the port for yield and tick)
+#define hostINTERRUPT_I2C0 2
+#define hostINTERRUPT_I2C1 3
+#define hostINTERRUPT_I2C2 4
+#define hostINTERRUPT_EINT2 5
+
+// Slave addresses of the two PIC boards on the rover's I2C bus
+#define hostI2CSensorAddr 0x4F
+#define hostI2CMotorAddr  0x4D
+
+/* ************************************************ */
+// I2C bus and rover model (hostI2C.c)
+typedef struct __hostI2CStats {
+	unsigned long transactions;		// completed transfers on all buses
+	unsigned long bytes;			// address + data bytes moved
+	unsigned long busMicroseconds;	// time the bus was busy (at the configured clock rate)
+	unsigned long sensorReads;		// sensor samples served by the sensor PIC stand-in
+	unsigned long motorCommands;	// motor commands accepted by the motor PIC stand-in
+	unsigned long latencySamples;	// motor commands that could be matched to a sensor sample
+	unsigned long latencyTotalUs;	// sensor sample served -> motor command received
+	unsigned long latencyMinUs;
+	unsigned long latencyMaxUs;
+	unsigned long collisions;		// times the simulated rover ran into a wall
+	unsigned long sensorAgeTotalUs;	// sensor PIC sample taken -> read over the bus
+	unsigned long sensorAgeMaxUs;
+	unsigned long lapMicroseconds;	// first motor command that moves the rover -> past the finish line (0 if not yet)
+} hostI2CStats;
+
+// The rover's course: a corridor with the rover starting near one end and a finish line across it near
+//   the other.  The corridor can turn a corner: the far end of the first leg then opens into a second leg
+//   of the same width running along +y (a left turn) or -y (a right turn), and the finish line is across
+//   the second leg.
+typedef struct __hostCourse {
+	double width, height;		// first leg size (cm)
+	double startX, startY;		// where the rover starts (cm, from the corner)
+	double startHeading;		// degrees, counter clockwise from +x
+	double finishX;				// straight: the lap is over once the rover is past this x (cm)
+								// with a turn: once it is this far into the second leg (cm past the first leg)
+	double turn;				// 0 for a straight corridor, else the length of the second leg (cm): > 0 turns
+								//   left, < 0 turns right
+} hostCourse;
+
+// Copy out the bus statistics
+void vHostI2CGetStats(hostI2CStats *stats);
+// Put the rover on a different course (before the scheduler is started)
+void vHostRoverSetCourse(const hostCourse *course);
+// Current simulated rover pose (cm, cm, degrees)
+void vHostRoverGetPose(float *x,float *y,float *headingDeg);
+
+/* ************************************************ */
+// LCD framebuffer (hostGLCD.c)
+typedef struct __hostGLCDStats {
+	unsigned long pixelsWritten;	// pixels sent to the panel
+	unsigned long clears;			// full screen clears
+} hostGLCDStats;
+
+void vHostGLCDGetStats(hostGLCDStats *stats);
+// Text most recently written to a line with GLCD_DisplayString() (empty if cleared)
+const char *pcHostGLCDLineText(unsigned int line);
+// Write the framebuffer out as a binary PPM image; returns 0 on success
+int iHostGLCDWritePPM(const char *path);
+
+/* ************************************************ */
+// Network stand-in (hostEMAC.c)
+// Post a web form to the stand-in uIP task (as the browser would), e.g. "LED0=1"
+void vHostEMACPostForm(const char *form);
+// Delay (in ms) before the stand-in posts "LED0=1" on its own; 0 means never
+extern unsigned long ulHostEMACAutoStartMs;
+
+#endif
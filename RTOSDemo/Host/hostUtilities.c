@@ -0,0 +1,48 @@
+// Host versions of the routines in vtCode/vtUtilities.c
+//
+// printf()/sprintf() come from the C library on the host, so only the LED and fatal error routines
+//   (and the heap selection) are provided here.
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "vtUtilities.h"
+
+// NVIC state used by the host core_cm3.h
+uint8_t hostNVICEnabled[64];
+uint8_t hostNVICPriority[64];
+
+// The LEDs are just remembered
+static uint8_t ledState = 0;
+
+void vtInitLED()
+{
+	ledState = 0;
+}
+
+void vtLEDOn(uint8_t mask)
+{
+	ledState |= mask;
+}
+
+void vtLEDOff(uint8_t mask)
+{
+	ledState &= ~mask;
+}
+
+void vtHandleFatalError(int code,int line,char file[]) {
+	// On the target this stops everything and flashes the LEDs; here we say where and stop the process
+	taskDISABLE_INTERRUPTS();
+	fprintf(stderr,"Fatal error %d at %s:%d\n",code,file,line);
+	fflush(stderr);
+	abort();
+}
+
+#if MALLOC_VERSION==1
+#include "heap_3.c"
+#elif MALLOC_VERSION==2
+#include "heap_tlsf.c"
+#endif
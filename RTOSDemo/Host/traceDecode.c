@@ -0,0 +1,382 @@
+// Decoder for the binary kernel event trace (vtCode/vtTrace)
+//
+// Reads a copy of vtTraceData -- saved from the target with the debugger, or written by "rover_host -T" --
+//   and prints, for the events still in the ring:
+//   -- per task: how often and how long it ran, and the latency from being made ready to running
+//   -- per task: what it blocked on (a delay, a queue/semaphore/mutex or a notification) and for how long
+//   -- per interrupt: how often it ran and for how long
+//   -- per queue and timer: the traffic
+//   -- with -t, every event in order
+//
+// Usage: trace_decode [-t] trace.bin
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+// Only the layout is wanted from vtTrace.h, not the kernel hooks
+#define configUSE_VT_TRACE 0
+#include "vtTrace.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+#define decodeMaxIsrs 8
+#define decodeDelay 0		// what a task blocked on: decodeDelay or a queue number with one of these
+#define decodeSend 0x100
+#define decodeReceive 0x200
+#define decodeNotify 0x400
+
+typedef struct __decodeSpan {
+	unsigned long count;
+	uint64_t total;
+	uint64_t max;
+} decodeSpan;
+
+typedef struct __decodeTask {
+	int seen;
+	unsigned int priority;
+	decodeSpan run;			// time switched in
+	decodeSpan latency;		// made ready -> switched in
+	int readyPending;
+	uint64_t readyAt;
+	int blocked;			// blocked on blockedOn since blockedAt
+	int blockedOn;
+	uint64_t blockedAt;
+	decodeSpan delay;
+	decodeSpan notifyWait;
+	decodeSpan sendWait[vtTraceMaxQueues];
+	decodeSpan receiveWait[vtTraceMaxQueues];
+} decodeTask;
+
+typedef struct __decodeQueue {
+	unsigned long sends, receives, sendsFromIsr, receivesFromIsr, sendFails, receiveFails;
+} decodeQueue;
+
+static vtTraceRecorder trace;
+static decodeTask tasks[vtTraceMaxTasks];
+static decodeQueue queues[vtTraceMaxQueues];
+static decodeSpan isrs[decodeMaxIsrs];
+static uint64_t isrEnteredAt[decodeMaxIsrs];
+static unsigned long timerExpiries[vtTraceMaxTimers+1];
+static const char *isrNames[decodeMaxIsrs] = { "?", "I2C0", "I2C1", "I2C2", "SSP0", "SSP1", "EINT2", "DMA" };
+// end of defs
+/* *********************************************** */
+
+static void decodeAdd(decodeSpan *s,uint64_t t)
+{
+	s->count++;
+	s->total += t;
+	if (t > s->max) {
+		s->max = t;
+	}
+}
+
+// Clock counts to microseconds
+static double decodeUs(uint64_t t)
+{
+	return((t*1000000.0)/trace.clockHz);
+}
+
+static const char *decodeTaskName(unsigned int n)
+{
+	static char buf[vtTraceMaxTasks][16];
+
+	if ((n < vtTraceMaxTasks) && (trace.taskNames[n][0] != '\0')) {
+		return(trace.taskNames[n]);
+	}
+	snprintf(buf[n % vtTraceMaxTasks],sizeof(buf[0]),"task%u",n);
+	return(buf[n % vtTraceMaxTasks]);
+}
+
+static const char *decodeQueueName(unsigned int n)
+{
+	static char buf[4][16];
+	static int next = 0;
+	char *b = buf[next++ & 3];
+
+	snprintf(b,sizeof(buf[0]),"%s%u",((n < vtTraceMaxQueues) && (trace.queueKinds[n] == vtTraceQueueKindMutex)) ? "M" : "Q",n);
+	return(b);
+}
+
+static const char *decodeTimerName(unsigned int n)
+{
+	if ((n >= 1) && (n <= vtTraceMaxTimers) && (trace.timerNames[n-1][0] != '\0')) {
+		return(trace.timerNames[n-1]);
+	}
+	return("timer?");
+}
+
+static void decodeTimeline(uint64_t now,int isrDepth,unsigned int isr,unsigned int cur,const vtTraceEvent *e)
+{
+	char context[20];
+
+	// what was running: a task, or an interrupt handler (or not known yet, before the first switch in the ring)
+	if (isrDepth) {
+		snprintf(context,sizeof(context),"isr %s",isrNames[isr % decodeMaxIsrs]);
+	} else if (cur >= vtTraceMaxTasks) {
+		snprintf(context,sizeof(context),"?");
+	} else {
+		snprintf(context,sizeof(context),"%s",decodeTaskName(cur));
+	}
+	printf("%12.1f  %-12s  ",decodeUs(now),context);
+	switch (e->type) {
+	case vtTraceEvtTaskCreate: printf("create %s at priority %u\n",decodeTaskName(e->obj),e->arg); break;
+	case vtTraceEvtSwitchIn: printf("switch to %s\n",decodeTaskName(e->obj)); break;
+	case vtTraceEvtReady: printf("ready %s\n",decodeTaskName(e->obj)); break;
+	case vtTraceEvtDelay: printf("delay\n"); break;
+	case vtTraceEvtQueueCreate: printf("create %s\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtQueueSend: printf("send %s\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtQueueReceive: printf("receive %s\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtBlockSend: printf("block sending to %s\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtBlockReceive: printf("block receiving from %s\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtSendFailed: printf("send to %s failed\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtReceiveFailed: printf("receive from %s failed\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtSendFromIsr: printf("send %s\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtReceiveFromIsr: printf("receive %s\n",decodeQueueName(e->obj)); break;
+	case vtTraceEvtIsrEnter: printf("enter %s\n",isrNames[e->obj % decodeMaxIsrs]); break;
+	case vtTraceEvtIsrExit: printf("exit %s\n",isrNames[e->obj % decodeMaxIsrs]); break;
+	case vtTraceEvtTimerExpired: printf("timer %s\n",decodeTimerName(e->obj)); break;
+	case vtTraceEvtBlockNotify: printf("block until notified\n"); break;
+	case vtTraceEvtNotifyFromIsr: printf("notify %s\n",decodeTaskName(e->obj)); break;
+	default: printf("event %u (%u,%u)\n",e->type,e->obj,e->arg); break;
+	}
+}
+
+static void decodeSpanPrint(const decodeSpan *s)
+{
+	printf("%8lu %10.0f %9.0f %9.0f",s->count,decodeUs(s->total),s->count ? decodeUs(s->total/s->count) : 0.0,decodeUs(s->max));
+}
+
+static void decodeReport(uint64_t span,unsigned long events)
+{
+	unsigned int i, q;
+
+	printf("%lu events over %.3f ms (%lu written, clock %lu Hz)\n",events,decodeUs(span)/1000.0,(unsigned long) trace.head,
+		(unsigned long) trace.clockHz);
+
+	printf("\nTask          pri     runs    run us    avg us    max us |  ready->running: n    avg us    max us\n");
+	for (i=0;i<vtTraceMaxTasks;i++) {
+		if (!tasks[i].seen) {
+			continue;
+		}
+		printf("%-12s %4u ",decodeTaskName(i),tasks[i].priority);
+		decodeSpanPrint(&tasks[i].run);
+		printf(" | %17lu %9.0f %9.0f\n",tasks[i].latency.count,
+			tasks[i].latency.count ? decodeUs(tasks[i].latency.total/tasks[i].latency.count) : 0.0,decodeUs(tasks[i].latency.max));
+	}
+
+	printf("\nBlocked       on                 times   total us    avg us    max us\n");
+	for (i=0;i<vtTraceMaxTasks;i++) {
+		if (!tasks[i].seen) {
+			continue;
+		}
+		if (tasks[i].delay.count) {
+			printf("%-12s  %-16s ",decodeTaskName(i),"delay");
+			decodeSpanPrint(&tasks[i].delay);
+			printf("\n");
+		}
+		if (tasks[i].notifyWait.count) {
+			printf("%-12s  %-16s ",decodeTaskName(i),"notification");
+			decodeSpanPrint(&tasks[i].notifyWait);
+			printf("\n");
+		}
+		for (q=0;q<vtTraceMaxQueues;q++) {
+			char on[32];
+
+			if (tasks[i].receiveWait[q].count) {
+				snprintf(on,sizeof(on),"receive %s",decodeQueueName(q));
+				printf("%-12s  %-16s ",decodeTaskName(i),on);
+				decodeSpanPrint(&tasks[i].receiveWait[q]);
+				printf("\n");
+			}
+			if (tasks[i].sendWait[q].count) {
+				snprintf(on,sizeof(on),"send %s",decodeQueueName(q));
+				printf("%-12s  %-16s ",decodeTaskName(i),on);
+				decodeSpanPrint(&tasks[i].sendWait[q]);
+				printf("\n");
+			}
+		}
+	}
+
+	printf("\nInterrupt        runs   total us    avg us    max us\n");
+	for (i=0;i<decodeMaxIsrs;i++) {
+		if (isrs[i].count) {
+			printf("%-6s   ",isrNames[i]);
+			decodeSpanPrint(&isrs[i]);
+			printf("\n");
+		}
+	}
+
+	printf("\nQueue     sends  receives  isr sends  isr receives  send fails  receive fails\n");
+	for (q=0;q<vtTraceMaxQueues;q++) {
+		decodeQueue *d = &queues[q];
+
+		if (d->sends + d->receives + d->sendsFromIsr + d->receivesFromIsr + d->sendFails + d->receiveFails) {
+			printf("%-6s %8lu %9lu %10lu %13lu %11lu %14lu\n",decodeQueueName(q),d->sends,d->receives,d->sendsFromIsr,
+				d->receivesFromIsr,d->sendFails,d->receiveFails);
+		}
+	}
+
+	printf("\nTimer         expiries\n");
+	for (i=0;i<=vtTraceMaxTimers;i++) {
+		if (timerExpiries[i]) {
+			printf("%-12s %9lu\n",i ? decodeTimerName(i) : "(others)",timerExpiries[i]);
+		}
+	}
+}
+
+int main(int argc,char *argv[])
+{
+	FILE *f;
+	int opt, timeline = 0, isrDepth = 0;
+	uint32_t n, first, k, lastTime = 0;
+	uint64_t now = 0, switchedAt = 0;
+	unsigned int cur = 0, isr = 0;
+	int haveCur = 0;
+
+	while ((opt = getopt(argc,argv,"t")) != -1) {
+		switch (opt) {
+		case 't': timeline = 1; break;
+		default:
+			fprintf(stderr,"usage: %s [-t] trace.bin\n",argv[0]);
+			return(2);
+		}
+	}
+	if (optind != argc-1) {
+		fprintf(stderr,"usage: %s [-t] trace.bin\n",argv[0]);
+		return(2);
+	}
+	if ((f = fopen(argv[optind],"rb")) == NULL) {
+		perror(argv[optind]);
+		return(2);
+	}
+	if (fread(&trace,sizeof(trace),1,f) != 1) {
+		fprintf(stderr,"%s: too short for a trace (%lu bytes)\n",argv[optind],(unsigned long) sizeof(trace));
+		return(2);
+	}
+	fclose(f);
+	if ((trace.magic != vtTraceMagic) || (trace.version != vtTraceVersion) || (trace.eventSize != sizeof(vtTraceEvent)) ||
+		(trace.length != vtTraceLen) || (trace.clockHz == 0)) {
+		fprintf(stderr,"%s: not a version %d trace of %d events\n",argv[optind],vtTraceVersion,vtTraceLen);
+		return(2);
+	}
+
+	// The oldest event still in the ring comes first
+	n = (trace.head < trace.length) ? trace.head : trace.length;
+	first = trace.head - n;
+	for (k=0;k<n;k++) {
+		const vtTraceEvent *e = &trace.events[(first + k) & (vtTraceLen-1)];
+		int32_t step = (k == 0) ? 0 : (int32_t) (e->time - lastTime);
+
+		// 32-bit timestamps wrap; an interrupt can leave one a little out of order
+		if ((step < 0) && ((uint64_t) -step > now)) {
+			step = 0;
+		}
+		now += step;
+		lastTime = e->time;
+		if (timeline) {
+			decodeTimeline(now,isrDepth,isr,haveCur ? cur : vtTraceMaxTasks,e);
+		}
+		switch (e->type) {
+		case vtTraceEvtTaskCreate:
+			if (e->obj < vtTraceMaxTasks) {
+				tasks[e->obj].seen = 1;
+				tasks[e->obj].priority = e->arg;
+			}
+			break;
+		case vtTraceEvtSwitchIn:
+			if (haveCur && (cur < vtTraceMaxTasks)) {
+				decodeAdd(&tasks[cur].run,now - switchedAt);
+			}
+			cur = e->obj;
+			haveCur = 1;
+			switchedAt = now;
+			if (cur < vtTraceMaxTasks) {
+				decodeTask *t = &tasks[cur];
+
+				t->seen = 1;
+				if (t->readyPending) {
+					decodeAdd(&t->latency,now - t->readyAt);
+					t->readyPending = 0;
+				}
+			}
+			break;
+		case vtTraceEvtReady:
+			if (e->obj < vtTraceMaxTasks) {
+				decodeTask *t = &tasks[e->obj];
+
+				t->seen = 1;
+				if (t->blocked) {
+					uint64_t d = now - t->blockedAt;
+
+					if (t->blockedOn == decodeDelay) {
+						decodeAdd(&t->delay,d);
+					} else if (t->blockedOn == decodeNotify) {
+						decodeAdd(&t->notifyWait,d);
+					} else if (t->blockedOn & decodeSend) {
+						decodeAdd(&t->sendWait[t->blockedOn & 0xFF],d);
+					} else {
+						decodeAdd(&t->receiveWait[t->blockedOn & 0xFF],d);
+					}
+					t->blocked = 0;
+				}
+				// the first time it is made ready since it last ran
+				if (!t->readyPending && !(haveCur && (cur == e->obj))) {
+					t->readyPending = 1;
+					t->readyAt = now;
+				}
+			}
+			break;
+		case vtTraceEvtDelay:
+		case vtTraceEvtBlockNotify:
+		case vtTraceEvtBlockSend:
+		case vtTraceEvtBlockReceive: {
+			int byTask = (e->type == vtTraceEvtDelay) || (e->type == vtTraceEvtBlockNotify);
+			// a queue block names the queue, not the task, so it is dropped until a switch says who is running
+			unsigned int who = byTask ? e->obj : (haveCur ? cur : vtTraceMaxTasks);
+
+			if (who < vtTraceMaxTasks) {
+				decodeTask *t = &tasks[who];
+
+				t->blocked = 1;
+				t->blockedAt = now;
+				if (byTask) {
+					t->blockedOn = (e->type == vtTraceEvtDelay) ? decodeDelay : decodeNotify;
+				} else {
+					t->blockedOn = ((e->type == vtTraceEvtBlockSend) ? decodeSend : decodeReceive) | (e->obj % vtTraceMaxQueues);
+				}
+			}
+			break;
+		}
+		case vtTraceEvtQueueSend: queues[e->obj % vtTraceMaxQueues].sends++; break;
+		case vtTraceEvtQueueReceive: queues[e->obj % vtTraceMaxQueues].receives++; break;
+		case vtTraceEvtSendFailed: queues[e->obj % vtTraceMaxQueues].sendFails++; break;
+		case vtTraceEvtReceiveFailed: queues[e->obj % vtTraceMaxQueues].receiveFails++; break;
+		case vtTraceEvtSendFromIsr: queues[e->obj % vtTraceMaxQueues].sendsFromIsr++; break;
+		case vtTraceEvtReceiveFromIsr: queues[e->obj % vtTraceMaxQueues].receivesFromIsr++; break;
+		case vtTraceEvtIsrEnter:
+			isr = e->obj % decodeMaxIsrs;
+			isrEnteredAt[isr] = now;
+			isrDepth++;
+			break;
+		case vtTraceEvtIsrExit:
+			// an exit whose entry fell off the start of the ring is not counted
+			if (isrDepth > 0) {
+				decodeAdd(&isrs[e->obj % decodeMaxIsrs],now - isrEnteredAt[e->obj % decodeMaxIsrs]);
+				isrDepth--;
+			}
+			break;
+		case vtTraceEvtTimerExpired:
+			timerExpiries[(e->obj <= vtTraceMaxTimers) ? e->obj : 0]++;
+			break;
+		default:
+			break;
+		}
+	}
+	if (timeline) {
+		printf("\n");
+	}
+	decodeReport(now,n);
+	return(0);
+}
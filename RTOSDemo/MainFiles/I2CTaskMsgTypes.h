@@ -36,4 +36,12 @@
 #define PrintMap 16
 #define UpdateRunMap 17
 
+// sensor read started by the PIC's data-ready line (see sensorReady.c)
+#define SensorMsgTypeReady 18
+
+// requests to the motor task (see motor.c)
+#define MotorMsgTypeDrive 19
+#define MotorMsgTypeHalt 20
+#define MotorMsgTypeSpeed 21
+
 #endif
\ No newline at end of file
@@ -9,7 +9,7 @@
 /* include files. */
 #include "GLCD.h"
 #include "vtUtilities.h"
-#include "LCDtask.h"
+#include "lcdTask.h"
 #include "string.h"
 
 // I have set this to a larger stack size because of (a) using printf() and (b) the depth of function calls
@@ -49,6 +49,8 @@
 #define LCDMsgTypePixelBuff 10
 // a message saying set up graph
 #define LCDMsgTypeGraph 11
+// a message saying there are lines waiting in the print mailbox
+#define LCDMsgTypeMailbox 12
 // actual data structure that is sent in a message
 typedef struct __vtLCDMsg {
 	uint8_t msgType;
@@ -61,6 +63,30 @@ typedef struct __vtLCDMsg {
 	int *ya; // array of y pixels for block
 
 } vtLCDMsg;
+
+// If LCD_SHADOW=1, messages are drawn into a copy of the screen in RAM and only the parts that changed are
+//   written to the panel, at most every lcdFLUSH_PERIOD (see the shadow routines below)
+// If LCD_SHADOW=0, every message is drawn on the panel as soon as it arrives
+#define LCD_SHADOW 1
+// How long a change may sit in the shadow before it is written to the panel
+#define lcdFLUSH_PERIOD ( ( portTickType ) 100 / portTICK_RATE_MS )
+// Screen size and the size of the 16x24 font characters
+#define lcdWIDTH 320
+#define lcdHEIGHT 240
+#define lcdCHAR_WIDTH 16
+#define lcdCHAR_HEIGHT 24
+// Characters in the 16x24 font (anything else is drawn as a space)
+#define lcdFONT_FIRST 0x20
+#define lcdFONT_LAST 0x8F
+// Most dirty rectangles kept before they are merged regardless of how far apart they are
+#define lcdMAX_DIRTY 8
+// Longest a line can sit in the print mailbox if its wake-up message did not fit on the queue
+#define lcdMAILBOX_RETRY ( ( portTickType ) 100 / portTICK_RATE_MS )
+// Memory for the task and its queue
+static portSTACK_TYPE lcdStack[lcdSTACK_SIZE];
+static xStaticTask lcdTCB;
+static xStaticQueue lcdQueue;
+static uint8_t lcdQueueStorage[vtLCDQLen*sizeof(vtLCDMsg)];
 // end of defs
 
 /* definition for the LCD task. */
@@ -75,12 +101,16 @@ void StartLCDTask(vtLCDStruct *ptr, unsigned portBASE_TYPE uxPriority)
 	}
 
 	// Create the queue that will be used to talk to this task
-	if ((ptr->inQ = xQueueCreate(vtLCDQLen,sizeof(vtLCDMsg))) == NULL) {
+	if ((ptr->inQ = xQueueCreateStatic(vtLCDQLen,sizeof(vtLCDMsg),lcdQueueStorage,&lcdQueue)) == NULL) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
+	ptr->linesPending = 0;
+	ptr->wakeQueued = 0;
+	ptr->clearsSent = 0;
+	ptr->clearsDone = 0;
 	/* Start the task */
 	portBASE_TYPE retval;
-	if ((retval = xTaskCreate( vLCDUpdateTask, ( signed char * ) "LCD", lcdSTACK_SIZE, (void*)ptr, uxPriority, ( xTaskHandle * ) NULL )) != pdPASS) {
+	if ((retval = xTaskCreateStatic( vLCDUpdateTask, ( signed char * ) "LCD", lcdSTACK_SIZE, (void*)ptr, uxPriority, ( xTaskHandle * ) NULL, lcdStack, &lcdTCB )) != pdPASS) {
 		VT_HANDLE_FATAL_ERROR(retval);
 	}
 }
@@ -134,6 +164,19 @@ portBASE_TYPE SendLCDGraph(vtLCDStruct *lcdData, portTickType ticksToBlock)
 	lcdBuffer.msgType = LCDMsgTypeGraph;
 	return(xQueueSend(lcdData->inQ,(void *) (&lcdBuffer),ticksToBlock));
 }
+// Queue a clear and count it, so that mailbox lines written from here on wait until it is done
+static portBASE_TYPE sendClear(vtLCDStruct *lcdData,vtLCDMsg *lcdBuffer,portTickType ticksToBlock)
+{
+	portBASE_TYPE retval;
+
+	if ((retval = xQueueSend(lcdData->inQ,(void *) lcdBuffer,ticksToBlock)) == pdTRUE) {
+		portENTER_CRITICAL();
+		lcdData->clearsSent++;
+		portEXIT_CRITICAL();
+	}
+	return(retval);
+}
+
 portBASE_TYPE SendLCDPrintMsg(vtLCDStruct *lcdData,int length,char *pString, int l, portTickType ticksToBlock)
 {
 	if (lcdData == NULL) {
@@ -141,15 +184,37 @@ portBASE_TYPE SendLCDPrintMsg(vtLCDStruct *lcdData,int length,char *pString, int
 	}
 	vtLCDMsg lcdBuffer;
 
+	int needWake;
+	portBASE_TYPE retval = pdTRUE;
+
 	if (length > vtLCDMaxLen) {
 		// no room for this message
-		VT_HANDLE_FATAL_ERROR(lcdBuffer.length);
+		VT_HANDLE_FATAL_ERROR(length);
 	}
-	lcdBuffer.y = l;
-	lcdBuffer.length = strnlen(pString,vtLCDMaxLen);
-	lcdBuffer.msgType = LCDMsgTypePrint;
-	strncpy((char *)lcdBuffer.buf,pString,vtLCDMaxLen);
-	return(xQueueSend(lcdData->inQ,(void *) (&lcdBuffer),ticksToBlock));
+	if ((l < 0) || (l >= vtLCDNumLines)) {
+		VT_HANDLE_FATAL_ERROR(l);
+	}
+	// Replace whatever is waiting for this line, and note which clears were sent ahead of it
+	portENTER_CRITICAL();
+	strncpy(lcdData->lineText[l],pString,vtLCDMaxLen);
+	lcdData->lineText[l][vtLCDMaxLen] = '\0';
+	lcdData->lineClears[l] = lcdData->clearsSent;
+	lcdData->linesPending |= (1 << l);
+	needWake = !lcdData->wakeQueued;
+	lcdData->wakeQueued = 1;
+	portEXIT_CRITICAL();
+	if (needWake) {
+		// Only one wake-up is ever on the queue.  If it does not fit the task is busy anyway and will
+		//   pick the line up after its next message
+		lcdBuffer.msgType = LCDMsgTypeMailbox;
+		lcdBuffer.length = 0;
+		if ((retval = xQueueSend(lcdData->inQ,(void *) (&lcdBuffer),ticksToBlock)) != pdTRUE) {
+			portENTER_CRITICAL();
+			lcdData->wakeQueued = 0;
+			portEXIT_CRITICAL();
+		}
+	}
+	return(retval);
 }
 
 portBASE_TYPE SendLCDPrintMsgVert(vtLCDStruct *lcdData,int length,char *pString, int l, portTickType ticksToBlock)
@@ -208,7 +273,7 @@ portBASE_TYPE ClearLCDBlock(vtLCDStruct *lcdData,int Xs, int Ys, int Xf, int Yf,
 	lcdBuffer.xf = Xf;
 	lcdBuffer.yf = Yf;
 	lcdBuffer.msgType = LCDMsgTypeClearBlock;
-	return(xQueueSend(lcdData->inQ,(void *) (&lcdBuffer),ticksToBlock));
+	return(sendClear(lcdData,&lcdBuffer,ticksToBlock));
 }
 
 portBASE_TYPE ClearLCDTextLine(vtLCDStruct *lcdData,int l, portTickType ticksToBlock)
@@ -220,7 +285,7 @@ portBASE_TYPE ClearLCDTextLine(vtLCDStruct *lcdData,int l, portTickType ticksToB
 	
 	lcdBuffer.y = l;
 	lcdBuffer.msgType = LCDMsgTypeClearLine;
-	return(xQueueSend(lcdData->inQ,(void *) (&lcdBuffer),ticksToBlock)); 
+	return(sendClear(lcdData,&lcdBuffer,ticksToBlock));
 }
 
 portBASE_TYPE ClearLCD(vtLCDStruct *lcdData, portTickType ticksToBlock)
@@ -231,7 +296,7 @@ portBASE_TYPE ClearLCD(vtLCDStruct *lcdData, portTickType ticksToBlock)
 	vtLCDMsg lcdBuffer;
 	
 	lcdBuffer.msgType = LCDMsgTypeClear;
-	return(xQueueSend(lcdData->inQ,(void *) (&lcdBuffer),ticksToBlock)); 
+	return(sendClear(lcdData,&lcdBuffer,ticksToBlock));
 }
 // Private routines used to unpack the message buffers
 //   I do not want to access the message buffer data structures outside of these routines
@@ -270,13 +335,258 @@ int getMsgLength(vtLCDMsg *lcdBuffer)
 	return(lcdBuffer->msgType);
 }
 
+// target must have room for targetMaxLen characters and the terminating nul
 void copyMsgString(char *target,vtLCDMsg *lcdBuffer,int targetMaxLen)
 {
-	strncpy(target,(char *)(lcdBuffer->buf),targetMaxLen);
+	size_t len = strnlen((char *)(lcdBuffer->buf),targetMaxLen);
+
+	memcpy(target,lcdBuffer->buf,len);
+	target[len] = '\0';
 }
 
 // End of private routines for message buffers
 
+// Drawing routines used by the task
+//   With LCD_SHADOW=1 these draw into the shadow; with LCD_SHADOW=0 they go straight to the panel
+#if LCD_SHADOW==1
+// The shadow is one bit per pixel -- set is the text color, clear is the screen color -- which is all that the
+//   messages to this task ever draw with.  It costs lcdWIDTH*lcdHEIGHT/8 = 9600 bytes of RAM.
+// A pixel, or a byte of a text row, only counts as changed if it really is different, so rewriting a line with
+//   the same text costs nothing at all, and a line rewritten many times between flushes is written once.
+#define lcdSTRIDE (lcdWIDTH/8)
+static uint8_t shadowPlane[lcdHEIGHT][lcdSTRIDE];
+
+// The parts of the shadow that differ from the panel, as rectangles [x0,x1) x [y0,y1)
+typedef struct __lcdRect {
+	int16_t x0, y0, x1, y1;
+} lcdRect;
+static lcdRect dirty[lcdMAX_DIRTY];
+static int numDirty = 0;
+// When the oldest change that is not on the panel yet was made
+static portTickType dirtySince;
+
+static int rectArea(int x0,int y0,int x1,int y1)
+{
+	return((x1-x0)*(y1-y0));
+}
+
+// Add a changed area; overlapping or touching rectangles are merged, and when the list is full the new area is
+//   merged into whichever rectangle grows the least
+static void shadowMarkDirty(int x0,int y0,int x1,int y1)
+{
+	int i, best, growth, bestGrowth;
+	int ux0, uy0, ux1, uy1;
+
+	if (numDirty == 0) {
+		dirtySince = xTaskGetTickCount();
+	}
+	best = -1;
+	bestGrowth = 0;
+	for (i=0;i<numDirty;i++) {
+		ux0 = (x0 < dirty[i].x0) ? x0 : dirty[i].x0;
+		uy0 = (y0 < dirty[i].y0) ? y0 : dirty[i].y0;
+		ux1 = (x1 > dirty[i].x1) ? x1 : dirty[i].x1;
+		uy1 = (y1 > dirty[i].y1) ? y1 : dirty[i].y1;
+		if ((x0 <= dirty[i].x1) && (dirty[i].x0 <= x1) && (y0 <= dirty[i].y1) && (dirty[i].y0 <= y1)) {
+			growth = 0;
+		} else {
+			growth = rectArea(ux0,uy0,ux1,uy1) - rectArea(dirty[i].x0,dirty[i].y0,dirty[i].x1,dirty[i].y1);
+		}
+		if ((best < 0) || (growth < bestGrowth)) {
+			best = i;
+			bestGrowth = growth;
+		}
+	}
+	if ((best < 0) || ((bestGrowth > 0) && (numDirty < lcdMAX_DIRTY))) {
+		dirty[numDirty].x0 = x0;
+		dirty[numDirty].y0 = y0;
+		dirty[numDirty].x1 = x1;
+		dirty[numDirty].y1 = y1;
+		numDirty++;
+		return;
+	}
+	if (x0 < dirty[best].x0) dirty[best].x0 = x0;
+	if (y0 < dirty[best].y0) dirty[best].y0 = y0;
+	if (x1 > dirty[best].x1) dirty[best].x1 = x1;
+	if (y1 > dirty[best].y1) dirty[best].y1 = y1;
+}
+
+// Set (on != 0) or clear a block of the shadow
+static void shadowFill(int x,int y,int w,int h,int on)
+{
+	int j, b, b0, b1;
+	int x0 = lcdSTRIDE, x1 = 0, y0 = lcdHEIGHT, y1 = 0;
+	uint8_t mask, newByte;
+
+	// clip to the screen
+	if (x < 0) { w += x; x = 0; }
+	if (y < 0) { h += y; y = 0; }
+	if (x+w > lcdWIDTH) w = lcdWIDTH-x;
+	if (y+h > lcdHEIGHT) h = lcdHEIGHT-y;
+	if ((w <= 0) || (h <= 0)) {
+		return;
+	}
+	// work a byte (8 pixels) at a time, masking the partial bytes at each end
+	b0 = x >> 3;
+	b1 = (x+w-1) >> 3;
+	for (j=y;j<y+h;j++) {
+		for (b=b0;b<=b1;b++) {
+			mask = 0xFF;
+			if (b == b0) mask &= 0xFF >> (x & 7);
+			if (b == b1) mask &= 0xFF << (7 - ((x+w-1) & 7));
+			newByte = on ? (shadowPlane[j][b] | mask) : (shadowPlane[j][b] & ~mask);
+			if (newByte != shadowPlane[j][b]) {
+				shadowPlane[j][b] = newByte;
+				if (b < x0) x0 = b;
+				if (b >= x1) x1 = b+1;
+				if (j < y0) y0 = j;
+				y1 = j+1;
+			}
+		}
+	}
+	if (x1 > x0) {
+		shadowMarkDirty(x0*8,y0,x1*8,y1);
+	}
+}
+
+// Draw a string in the 16x24 font, starting at character position (line,col) -- characters that do not fit are ignored
+static void shadowText(int line,int col,const char *s)
+{
+	int j, b, bx0, bx1;
+	int byteCol, numBytes;
+	int y0 = lcdHEIGHT, y1 = 0;
+	int x0 = lcdSTRIDE, x1 = 0;
+	const char *c;
+	const unsigned short *glyph;
+	unsigned char ch;
+	uint8_t rowBytes[lcdSTRIDE];
+
+	if ((line < 0) || ((line+1)*lcdCHAR_HEIGHT > lcdHEIGHT) || (col < 0)) {
+		return;
+	}
+	// Characters are two bytes wide and start on a byte boundary, so each pixel row of the text is a run of bytes
+	byteCol = col*(lcdCHAR_WIDTH/8);
+	numBytes = 0;
+	for (c=s;(*c != '\0') && (byteCol+numBytes+2 <= lcdSTRIDE);c++) {
+		numBytes += 2;
+	}
+	if (numBytes == 0) {
+		return;
+	}
+	for (j=0;j<lcdCHAR_HEIGHT;j++) {
+		for (b=0,c=s;b<numBytes;b+=2,c++) {
+			ch = (unsigned char) *c;
+			if ((ch < lcdFONT_FIRST) || (ch > lcdFONT_LAST)) ch = ' ';
+			glyph = &Font_16x24_h[(ch - lcdFONT_FIRST)*lcdCHAR_HEIGHT];
+			rowBytes[b] = glyph[j] >> 8;
+			rowBytes[b+1] = glyph[j] & 0xFF;
+		}
+		uint8_t *dst = &(shadowPlane[line*lcdCHAR_HEIGHT+j][byteCol]);
+		if (memcmp(dst,rowBytes,numBytes) != 0) {
+			for (bx0=0;dst[bx0] == rowBytes[bx0];bx0++);
+			for (bx1=numBytes;dst[bx1-1] == rowBytes[bx1-1];bx1--);
+			memcpy(dst+bx0,rowBytes+bx0,bx1-bx0);
+			if (byteCol+bx0 < x0) x0 = byteCol+bx0;
+			if (byteCol+bx1 > x1) x1 = byteCol+bx1;
+			if (j < y0) y0 = j;
+			y1 = j+1;
+		}
+	}
+	if (x1 > x0) {
+		shadowMarkDirty(x0*8,line*lcdCHAR_HEIGHT+y0,x1*8,line*lcdCHAR_HEIGHT+y1);
+	}
+}
+
+// Write the changed parts of the shadow to the panel
+static void shadowFlush(void)
+{
+	int i;
+
+	for (i=0;i<numDirty;i++) {
+		GLCD_BitPlane(dirty[i].x0,dirty[i].y0,dirty[i].x1-dirty[i].x0,dirty[i].y1-dirty[i].y0,&(shadowPlane[0][0]),lcdSTRIDE);
+	}
+	numDirty = 0;
+}
+
+// How long the task can wait for a message before the shadow has to be written to the panel
+static portTickType shadowWait(void)
+{
+	portTickType elapsed;
+
+	if (numDirty == 0) {
+		return(portMAX_DELAY);
+	}
+	elapsed = xTaskGetTickCount() - dirtySince;
+	return((elapsed >= lcdFLUSH_PERIOD) ? 0 : (lcdFLUSH_PERIOD - elapsed));
+}
+
+// Replace a whole line of text -- the text is padded out with spaces rather than clearing the line first,
+//   so that only the characters that change are marked dirty
+static void lcdPrintLine(int line,char *s)
+{
+	char lineBuffer[lcdCHAR_IN_LINE+1];
+	int len = strnlen(s,lcdCHAR_IN_LINE);
+
+	memcpy(lineBuffer,s,len);
+	memset(lineBuffer+len,' ',lcdCHAR_IN_LINE-len);
+	lineBuffer[lcdCHAR_IN_LINE] = '\0';
+	shadowText(line,0,lineBuffer);
+}
+static void lcdString(int line,int col,char *s) { shadowText(line,col,s); }
+static void lcdChar(int line,int col,char c) { char s[2] = { c, '\0' }; shadowText(line,col,s); }
+static void lcdClearLine(int line) { shadowFill(0,line*lcdCHAR_HEIGHT,lcdWIDTH,lcdCHAR_HEIGHT,0); }
+static void lcdPixel(int x,int y) { shadowFill(x,y,1,1,1); }
+static void lcdClearWindow(int x,int y,int w,int h,unsigned short color) { (void) color; shadowFill(x,y,w,h,0); }
+static void lcdClear(unsigned short color) { (void) color; shadowFill(0,0,lcdWIDTH,lcdHEIGHT,0); }
+#else
+static void lcdPrintLine(int line,char *s) { GLCD_ClearLn(line,1); GLCD_DisplayString(line,0,1,(unsigned char *)s); }
+static void lcdString(int line,int col,char *s) { GLCD_DisplayString(line,col,1,(unsigned char *)s); }
+static void lcdChar(int line,int col,char c) { GLCD_DisplayChar(line,col,1,c); }
+static void lcdClearLine(int line) { GLCD_ClearLn(line,1); }
+static void lcdPixel(int x,int y) { GLCD_PutPixel(x,y); }
+static void lcdClearWindow(int x,int y,int w,int h,unsigned short color) { GLCD_ClearWindow(x,y,w,h,color); }
+static void lcdClear(unsigned short color) { GLCD_Clear(color); }
+#endif
+
+// Print everything waiting in the mailbox filled in by SendLCDPrintMsg()
+//   A line written after a clear that the task has not reached yet stays put until that clear is done
+static void mailboxPrint(vtLCDStruct *lcdPtr)
+{
+	char lineBuffer[vtLCDMaxLen+1];
+	int line;
+
+	for (line=0;line<vtLCDNumLines;line++) {
+		portENTER_CRITICAL();
+		if (((lcdPtr->linesPending & (1 << line)) == 0) || ((int16_t) (lcdPtr->lineClears[line] - lcdPtr->clearsDone) > 0)) {
+			portEXIT_CRITICAL();
+			continue;
+		}
+		memcpy(lineBuffer,lcdPtr->lineText[line],sizeof(lineBuffer));
+		lcdPtr->linesPending &= ~(1 << line);
+		portEXIT_CRITICAL();
+		lcdPrintLine(line,lineBuffer);
+	}
+}
+
+// Called for each clear taken off the queue: lines written before it go out first, then it counts as done
+static void mailboxClear(vtLCDStruct *lcdPtr)
+{
+	mailboxPrint(lcdPtr);
+	portENTER_CRITICAL();
+	lcdPtr->clearsDone++;
+	portEXIT_CRITICAL();
+}
+
+// How long the task can wait for a message -- if a mailbox wake-up could not be queued, the pending lines
+//   are printed within lcdMAILBOX_RETRY
+static portTickType mailboxWait(vtLCDStruct *lcdPtr,portTickType wait)
+{
+	if ((lcdPtr->linesPending != 0) && !lcdPtr->wakeQueued && (wait > lcdMAILBOX_RETRY)) {
+		return(lcdMAILBOX_RETRY);
+	}
+	return(wait);
+}
+
 // If LCD_EXAMPLE_OP=0, then accept messages that may be timer or print requests and respond accordingly
 // If LCD_EXAMPLE_OP=1, then do a rotating ARM bitmap display
 #define LCD_EXAMPLE_OP 0
@@ -293,7 +603,6 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 	unsigned short screenColor = 0;
 	unsigned short tscr;
 	unsigned char curLine;
-	unsigned int x;
 	#elif LCD_EXAMPLE_OP==1
 	unsigned char picIndex = 0;
 	#else
@@ -347,10 +656,20 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 		#endif
 
 		#if LCD_EXAMPLE_OP==0
+		#if LCD_SHADOW==1
+		// Wait for a message -- or until the oldest change in the shadow is due to go out to the panel
+		if (xQueueReceive(lcdPtr->inQ,(void *) &msgBuffer,mailboxWait(lcdPtr,shadowWait())) != pdTRUE) {
+			mailboxPrint(lcdPtr);
+			shadowFlush();
+			continue;
+		}
+		#else
 		// Wait for a message
-		if (xQueueReceive(lcdPtr->inQ,(void *) &msgBuffer,portMAX_DELAY) != pdTRUE) {
-			VT_HANDLE_FATAL_ERROR(0);
+		if (xQueueReceive(lcdPtr->inQ,(void *) &msgBuffer,mailboxWait(lcdPtr,portMAX_DELAY)) != pdTRUE) {
+			mailboxPrint(lcdPtr);
+			continue;
 		}
+		#endif
 		
 		//Log that we are processing a message -- more explanation of logging is given later on
 		vtITMu8(vtITMPortLCDMsg,getMsgType(&msgBuffer));
@@ -358,15 +677,21 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 
 		// Take a different action depending on the type of the message that we received
 		switch(getMsgType(&msgBuffer)) {
+		case LCDMsgTypeMailbox: {
+			// Clear the flag before printing so that a line sent while we print queues another wake-up
+			portENTER_CRITICAL();
+			lcdPtr->wakeQueued = 0;
+			portEXIT_CRITICAL();
+			mailboxPrint(lcdPtr);
+			break;
+		}
 		case LCDMsgTypePrint: {
 			// This will result in the text printing in the last five lines of the screen
 			char   lineBuffer[lcdCHAR_IN_LINE+1];
 			copyMsgString(lineBuffer,&msgBuffer,lcdCHAR_IN_LINE);
 			curLine = getMsgY(&msgBuffer);
-			// clear the line
-			GLCD_ClearLn(curLine,1);
-			// show the text
-			GLCD_DisplayString(curLine,0,1,(unsigned char *)lineBuffer);
+			// clear the line and show the text
+			lcdPrintLine(curLine,lineBuffer);
 			break;
 		}
 		case LCDMsgTypePrintVert: {	//fixme
@@ -380,7 +705,7 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 			int iter = 0;
 			for(;;)
 			{
-				GLCD_DisplayChar(iter,curLine,1,(char)((unsigned char *)lineBuffer)[iter]);
+				lcdChar(iter,curLine,lineBuffer[iter]);
 				iter++;
 				if(iter == strnlen(lineBuffer,vtLCDMaxLen))
 				{
@@ -395,13 +720,12 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 			int xf = getMsgXf(&msgBuffer);
 			int yf = getMsgYf(&msgBuffer);
 			int i = 0;
-			x = xs;
 			if(xf == xs)
 			{
 				for(;;)
 				{
 					//GLCD_ClearWindow(xs,0,xs,200,screenColor);
-					GLCD_PutPixel(xs,(ys+i));
+					lcdPixel(xs,(ys+i));
 					i++;
 					if(i>(yf-ys))
 					{
@@ -414,7 +738,7 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 				for(;;)
 				{
 					//GLCD_ClearWindow((xs+i),0,(xs+i),200,screenColor);
-					GLCD_PutPixel((xs+i),ys);
+					lcdPixel((xs+i),ys);
 					i++;
 					if(i>(xf-xs))
 					{
@@ -428,7 +752,7 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 				for(;;)
 				{
 					//GLCD_ClearWindow((xs+i),0,(xs+i),200,screenColor);
-					GLCD_PutPixel((xs+i),(ys+lrint(slope*i)));
+					lcdPixel((xs+i),(ys+lrint(slope*i)));
 					i++;
 					if(i>=(xf-xs))
 					{
@@ -443,7 +767,7 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 			int y = getMsgY(&msgBuffer);
 
 			//GLCD_ClearWindow(x,0,1,200,screenColor);
-			GLCD_PutPixel(x,y);
+			lcdPixel(x,y);
 			
 			break;
 		}
@@ -454,8 +778,8 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 			for(;;)
 			{
 				y  = getMsgYa(&msgBuffer,i);
-				GLCD_ClearWindow(x,0,1,200,screenColor);
-				GLCD_PutPixel(x,y);
+				lcdClearWindow(x,0,1,200,screenColor);
+				lcdPixel(x,y);
 				x++;
 				if(x > 320)
 				{
@@ -473,13 +797,13 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 		} 
 		case LCDMsgTypeGraph: {
 			//horizontal string
-			GLCD_DisplayString(curLine,0,1,(unsigned char *)("     Time"));
+			lcdString(curLine,0,"     Time");
 			//vertical string
 			char *vString = "  Voltage";
 			int iter = 0;
 			for(;;)
 			{
-				GLCD_DisplayChar(iter,curLine,1,(char)((unsigned char *)vString)[iter]);
+				lcdChar(iter,curLine,vString[iter]);
 				iter++;
 				if(iter == 9)
 				{
@@ -493,7 +817,7 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 			int c = 0;
 			for(;;)
 			{
-				GLCD_PutPixel(xLine,yLine + c);
+				lcdPixel(xLine,yLine + c);
 				c++;
 				if(c>(210))
 				{
@@ -505,7 +829,7 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 			yLine = 210;
 			for(;;)
 			{
-				GLCD_PutPixel(xLine + c,yLine);
+				lcdPixel(xLine + c,yLine);
 				c++;
 				if(c>290)
 				{
@@ -523,16 +847,19 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 			int ys = getMsgY(&msgBuffer);
 			int xf = getMsgXf(&msgBuffer);
 			int yf = getMsgYf(&msgBuffer);
-			GLCD_ClearWindow(xs,ys,(xf-xs),(yf-ys),screenColor);
+			mailboxClear(lcdPtr);
+			lcdClearWindow(xs,ys,(xf-xs),(yf-ys),screenColor);
 			break;
 		}
 		case LCDMsgTypeClearLine: {
 			int l = getMsgY(&msgBuffer);
-			GLCD_ClearLn(l,1);
+			mailboxClear(lcdPtr);
+			lcdClearLine(l);
 			break;
 		}
 		case LCDMsgTypeClear: {
-			GLCD_Clear(screenColor);
+			mailboxClear(lcdPtr);
+			lcdClear(screenColor);
 			break;
 		}
 		case LCDMsgTypeTimer: {
@@ -545,6 +872,18 @@ static portTASK_FUNCTION( vLCDUpdateTask, pvParameters )
 		}
 		} // end of switch()
 
+		// A mailbox wake-up that did not fit on the queue is covered here while the queue stays busy
+		if ((lcdPtr->linesPending != 0) && !lcdPtr->wakeQueued) {
+			mailboxPrint(lcdPtr);
+		}
+
+		#if LCD_SHADOW==1
+		// Messages can keep the queue busy for longer than the flush period, so check here as well
+		if (shadowWait() == 0) {
+			shadowFlush();
+		}
+		#endif
+
 		// Here is a way to do debugging output via the built-in hardware -- it requires the ULINK cable and the
 		//   debugger in the Keil tools to be connected.  You can view PORT0 output in the "Debug(printf) Viewer"
 		//   under "View->Serial Windows".  You have to enable "Trace" and "Port0" in the Debug setup options.  This
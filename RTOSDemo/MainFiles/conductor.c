@@ -15,117 +15,89 @@
 #include "navigation.h"
 #include "mapping.h"
 #include "distance.h"
+#include "motor.h"
 #include "I2CTaskMsgTypes.h"
+#include "sensorBus.h"
 #include "conductor.h"
 
 /* *********************************************** */
 // definitions and data structures that are private to this file
 
-// I have set this to a large stack size because of (a) using printf() and (b) the depth of function calls
-//   for some of the i2c operations	-- almost certainly too large, see LCDTask.c for details on how to check the size
-#define INSPECT_STACK 1
-#define baseStack 2
-#if PRINTF_VERSION == 1
-#define conSTACK_SIZE		((baseStack+5)*configMINIMAL_STACK_SIZE)
-#else
-#define conSTACK_SIZE		(baseStack*configMINIMAL_STACK_SIZE)
-#endif
+// The conductor used to be a task that read every I2C result and re-sent it to the right task.  The routing is
+//   now a set of sensor bus subscriptions, and the I2C thread publishes each result itself.
+
+// Delivery functions for the sensor bus -- each puts the sample on the subscriber's queue just as the conductor
+//   task used to, but only waits as long as the publisher allows
+static portBASE_TYPE deliverToMap(void *subscriber,const vtSensorSample *sample,portTickType ticksToBlock)
+{
+	return(SendMapSample((vtMapStruct *) subscriber,sample->msgType,sample->count,sample->value1,sample->value2,sample->status,ticksToBlock));
+}
+
+static portBASE_TYPE deliverToNav(void *subscriber,const vtSensorSample *sample,portTickType ticksToBlock)
+{
+	return(SendNavMsg((vtNavStruct *) subscriber,sample->msgType,sample->count,sample->value1,sample->value2,ticksToBlock));
+}
+
+static portBASE_TYPE deliverToDistance(void *subscriber,const vtSensorSample *sample,portTickType ticksToBlock)
+{
+	return(SendDistanceMsg((vtDistanceStruct *) subscriber,sample->msgType,sample->count,sample->value1,sample->value2,ticksToBlock));
+}
+
+// The motor task only wants the echoes of its commands, with the status so that it can send a failed one again
+static portBASE_TYPE deliverToMotor(void *subscriber,const vtSensorSample *sample,portTickType ticksToBlock)
+{
+	return(SendMotorWritten((vtMotorStruct *) subscriber,sample->count,sample->status,ticksToBlock));
+}
+
+// Called by the I2C thread with each result: buf[0] is the command echo, the sample follows it
+//   The I2C thread must never wait on a subscriber -- a task blocked in vtI2CEnQ() on an empty descriptor pool
+//   would never get to empty its queue -- so a subscriber whose queue is full misses the sample (see vtSensorDropped())
+static void publishI2CResult(void *arg,const vtI2CMsg *msgPtr)
+{
+	vtSensorSample sample;
+
+	(void) arg;
+	sample.msgType = msgPtr->msgType;
+	sample.count = msgPtr->buf[1];
+	sample.value1 = msgPtr->buf[2];
+	sample.value2 = msgPtr->buf[3];
+	sample.status = msgPtr->status;
+	// samples with no subscriber are dropped, as the conductor task did
+	vtSensorPublish(&sample,0);
+}
 // end of defs
 /* *********************************************** */
 
-/* The navigation task. */
-static portTASK_FUNCTION_PROTO( vConductorUpdateTask, pvParameters );
-
 /*-----------------------------------------------------------*/
 // Public API
-void vStartConductorTask(vtConductorStruct *params,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtNavStruct *navigation, vtMapStruct *mapping, vtDistanceStruct *distance)
+void vStartConductorTask(vtConductorStruct *params,vtI2CStruct *i2c,vtNavStruct *navigation, vtMapStruct *mapping, vtDistanceStruct *distance, vtMotorStruct *motor)
 {
-	/* Start the task */
-	portBASE_TYPE retval;
 	params->dev = i2c;
 	params->navData = navigation;
 	params->mapData = mapping;
 	params->distanceData = distance;
-	if ((retval = xTaskCreate( vConductorUpdateTask, ( signed char * ) "Conductor", conSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL )) != pdPASS) {
-		VT_HANDLE_FATAL_ERROR(retval);
-	}
-}
-
-// End of Public API
-/*-----------------------------------------------------------*/
-
-// This is the actual task that is run
-static portTASK_FUNCTION( vConductorUpdateTask, pvParameters )
-{
-	uint8_t rxLen, status;
-	uint8_t Buffer[vtI2CMLen];
-	uint8_t *msgPtr = &(Buffer[0]);
-	uint8_t *countPtr = &(Buffer[1]);
-	uint8_t *val1Ptr = &(Buffer[2]);
-	uint8_t *val2Ptr = &(Buffer[3]);
-	int timer;
-	// Get the parameters
-	vtConductorStruct *param = (vtConductorStruct *) pvParameters;
-	// Get the I2C device pointer
-	vtI2CStruct *devPtr = param->dev;
-	// Get the nav information pointer
-	vtNavStruct *navData = param->navData;
-	// Get the map information pointer
-	vtMapStruct *mapData = param->mapData;
-	// Get the distance information pointer
-	vtDistanceStruct *distanceData = param->distanceData;
+	params->motorData = motor;
 
-	uint8_t recvMsgType;
+	// Who gets which messages
+	vtSensorSubscribe(vtI2CMsgTypeMotorRead,deliverToMap,mapping);
+	// the occupancy grid is built from the IR distances and the motor commands as well as the encoders
+	vtSensorSubscribe(DistanceMsg,deliverToMap,mapping);
+	vtSensorSubscribe(FrontValMsg,deliverToMap,mapping);
+	vtSensorSubscribe(vtI2CMsgTypeMotorSend,deliverToMap,mapping);
+	vtSensorSubscribe(vtI2CMsgTypeAccRead,deliverToNav,navigation);
+	vtSensorSubscribe(vtI2CMsgTypeIRRead1,deliverToDistance,distance);
+	vtSensorSubscribe(vtI2CMsgTypeIRRead2,deliverToDistance,distance);
+	vtSensorSubscribe(vtI2CMsgTypeIRRead3,deliverToDistance,distance);
+	vtSensorSubscribe(DistanceMsg,deliverToNav,navigation);
+	vtSensorSubscribe(FrontValMsg,deliverToNav,navigation);
+	// speed changes from the second-run speed plan (see mapping.c)
+	vtSensorSubscribe(UpdateSpeed,deliverToNav,navigation);
+	// the motor task watches for its commands coming back from the I2C thread
+	vtSensorSubscribe(vtI2CMsgTypeMotorSend,deliverToMotor,motor);
 
-	// Like all good tasks, this should never exit
-	for(;;)
-	{
-		// Wait for a message from an I2C operation
-		if (vtI2CDeQ(devPtr,vtI2CMLen,Buffer,&rxLen,&recvMsgType,&status) != pdTRUE) {
-			VT_HANDLE_FATAL_ERROR(0);
-		}
-		// Decide where to send the message 
-		// This isn't a state machine, it is just acting as a router for messages
-		switch(recvMsgType) {
-		case vtI2CMsgTypeMotorRead: {
-			SendMapMsg(mapData,recvMsgType,(*countPtr),(*val1Ptr),(*val2Ptr),portMAX_DELAY);
-			break;
-		}
-		/*case vtI2CMsgTypeMotorRead: {
-			SendNavMsg(navData,recvMsgType,(*countPtr),(*val1Ptr),(*val2Ptr),portMAX_DELAY);
-			break;
-		}*/
-		case vtI2CMsgTypeAccRead: {
-			SendNavMsg(navData,recvMsgType,(*countPtr),(*val1Ptr),(*val2Ptr),portMAX_DELAY);
-			break;
-		}
-		case vtI2CMsgTypeIRRead1: {
-			SendDistanceMsg(distanceData,recvMsgType,(*countPtr),(*val1Ptr),(*val2Ptr),portMAX_DELAY);
-			break;
-		}
-		case vtI2CMsgTypeIRRead2: {
-			SendDistanceMsg(distanceData,recvMsgType,(*countPtr),(*val1Ptr),(*val2Ptr),portMAX_DELAY);
-			break;
-		}
-		case vtI2CMsgTypeIRRead3: {
-			SendDistanceMsg(distanceData,recvMsgType,(*countPtr),(*val1Ptr),(*val2Ptr),portMAX_DELAY);
-			break;
-		}
-		case DistanceMsg: {
-			 SendNavMsg(navData,recvMsgType,(*countPtr),(*val1Ptr),(*val2Ptr),portMAX_DELAY);
-			break;
-		}
-		case FrontValMsg: {
-			 SendNavMsg(navData,recvMsgType,(*countPtr),(*val1Ptr),(*val2Ptr),portMAX_DELAY);
-			break;
-		}
-		default: {
-			//VT_HANDLE_FATAL_ERROR(recvMsgType);
-			break;
-		}
-		}
-	    timer++;
-		timer = timer -1;
-	}
+	// and have the I2C thread publish its results directly
+	vtI2CSetResultHandler(i2c,publishI2CResult,NULL);
 }
 
+// End of Public API
+/*-----------------------------------------------------------*/
@@ -4,6 +4,7 @@
 #include "navigation.h"
 #include "mapping.h"
 #include "distance.h"
+#include "motor.h"
 // Structure used to pass parameters to the task
 // Do not touch...
 typedef struct __ConductorStruct {
@@ -11,18 +12,22 @@ typedef struct __ConductorStruct {
 	vtNavStruct *navData;
 	vtMapStruct *mapData;
 	vtDistanceStruct *distanceData;
+	vtMotorStruct *motorData;
 } vtConductorStruct;
 
 // Public API
 //
-// The job of this task is to read from the message queue that is output by the I2C thread and to distribute the messages to the right
-//   threads.  Right now, they are only going to one thread, but it should be clear from the structure of this task how that would be done.
-// Start the task
+// The job of the conductor is to distribute the messages that come out of the I2C thread to the right threads.
+//   It is no longer a task of its own: it subscribes each thread to its messages on the sensor bus (see sensorBus.h)
+//   and has the I2C thread publish its results there, so a sample goes straight to the threads that want it.
+//   Other threads can subscribe to the same messages without any change here.
+// Set up the routing (call after the I2C, navigation, mapping, distance and motor tasks have been started)
 // Args:
-//   conductorData: Data structure used by the task
-//   uxPriority -- the priority you want this task to be run at
+//   conductorData: Data structure used by the conductor
 //   i2c: pointer to the data structure for an i2c task
 //   navigation: pointer to the data structure for an navigation task
 //	 mapping: pointer to the data structure for a mapping task
-void vStartConductorTask(vtConductorStruct *conductorData,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtNavStruct *navigation, vtMapStruct *mapping, vtDistanceStruct *distance);
+//   distance: pointer to the data structure for a distance task
+//   motor: pointer to the data structure for the motor task
+void vStartConductorTask(vtConductorStruct *conductorData,vtI2CStruct *i2c,vtNavStruct *navigation, vtMapStruct *mapping, vtDistanceStruct *distance, vtMotorStruct *motor);
 #endif
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include <stdlib.h>
 #include <stdio.h>
-#include <math.h>
 #include <string.h>
 
 /* Scheduler include files. */
@@ -12,8 +11,9 @@
 /* include files. */
 #include "vtUtilities.h"
 #include "vtI2C.h"
-#include "LCDtask.h"
+#include "lcdTask.h"
 #include "I2CTaskMsgTypes.h"
+#include "sensorBus.h"
 #include "distance.h"
 
 /* *********************************************** */
@@ -48,7 +48,22 @@ typedef struct __vtDistanceI2CMsg {
 
 #define PRINTGRAPH 0
 
-
+// Built from 102.5149651 * 0.3091605258^(code*5/1024) -- the curve fitted to our IR sensors -- in 1/16 cm,
+//   so that no floating point is needed to convert a sample (there is no FPU)
+const vtIRCalibration vtIRCalDefault = { {
+	1640, 1497, 1365, 1246, 1137, 1037,  946,  863,  788,  719,  656,  598,  546,  498,  454,  414,
+	 378,  345,  315,  287,  262,  239,  218,  199,  182,  166,  151,  138,  126,  115,  105,   96,
+	  87,   80,   73,   66,   60,   55,   50,   46,   42,   38,   35,   32,   29,   26,   24,   22,
+	  20,   18,   17,   15,   14,   13,   12,   11,   10,    9,    8,    7,    7,    6,    6,    5,
+	   5
+} };
+
+
+// Memory for the task and its queue
+static portSTACK_TYPE distanceStack[distanceSTACK_SIZE];
+static xStaticTask distanceTCB;
+static xStaticQueue distanceQueue;
+static uint8_t distanceQueueStorage[vtDistanceQLen*sizeof(vtDistanceI2CMsg)];
 // end of defs
 /* *********************************************** */
 
@@ -60,18 +75,46 @@ static portTASK_FUNCTION_PROTO( vDistanceUpdateTask, pvParameters );
 void vStartDistanceTask(vtDistanceStruct *params,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtLCDStruct *lcd)
 {
 	// Create the queue that will be used to talk to this task
-	if ((params->inQ = xQueueCreate(vtDistanceQLen,sizeof(vtDistanceI2CMsg))) == NULL) {
+	if ((params->inQ = xQueueCreateStatic(vtDistanceQLen,sizeof(vtDistanceI2CMsg),distanceQueueStorage,&distanceQueue)) == NULL) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
 	/* Start the task */
 	portBASE_TYPE retval;
 	params->dev = i2c;
 	params->lcdData = lcd;
-	if ((retval = xTaskCreate( vDistanceUpdateTask, ( signed char * ) "Distance", distanceSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL )) != pdPASS) {
+	int i;
+	for (i=0;i<vtDistanceNumIR;i++) {
+		params->irCal[i] = &vtIRCalDefault;
+	}
+	if ((retval = xTaskCreateStatic( vDistanceUpdateTask, ( signed char * ) "Distance", distanceSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL, distanceStack, &distanceTCB )) != pdPASS) {
 		VT_HANDLE_FATAL_ERROR(retval);
 	}
 }
 
+void vDistanceSetIRCalibration(vtDistanceStruct *distanceData,int sensor,const vtIRCalibration *cal)
+{
+	if ((distanceData == NULL) || (cal == NULL) || (sensor < 0) || (sensor >= vtDistanceNumIR)) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	distanceData->irCal[sensor] = cal;
+}
+
+// Convert a 10-bit IR sample to cm using a calibration table
+static int irDistance(const vtIRCalibration *cal,int code)
+{
+	int k = code >> vtIRCalShift;
+	int frac = code & ((1 << vtIRCalShift) - 1);
+	int cm16;
+
+	if (k >= vtIRCalPoints-1) {
+		// past the top of the 10-bit range
+		k = vtIRCalPoints-2; frac = (1 << vtIRCalShift);
+	}
+	// interpolate between the two points either side of the sample and round to the nearest cm
+	cm16 = cal->cm16[k] + (((cal->cm16[k+1] - cal->cm16[k]) * frac) >> vtIRCalShift);
+	return((cm16 + 8) >> 4);
+}
+
 /*
 portBASE_TYPE SendDistanceTimerMsg(vtDistanceStruct *distanceData,portTickType ticksElapsed,portTickType ticksToBlock)
 {
@@ -163,8 +206,6 @@ static portTASK_FUNCTION( vDistanceUpdateTask, pvParameters )
 
 	// Get the parameters
 	vtDistanceStruct *param = (vtDistanceStruct *) pvParameters;
-	// Get the I2C device pointer
-	vtI2CStruct *devPtr = param->dev;
 	// Get the LCD information pointer
 	vtLCDStruct *lcdData = param->lcdData;
 
@@ -200,13 +241,10 @@ static portTASK_FUNCTION( vDistanceUpdateTask, pvParameters )
 			// val2 = 8765 4321
 			//if so the below undoes it and puts it back together
 			//piece together 10 bit value
-		    double val = val1* 256 + val2;
+		    int val = val1*256 + val2;
 			if(val == 0)
 				break;
-			//normally would be -0.45 but to round i added 0.5
-			val = val*5.0/1024.0;
-			//int value = (int)(25.50958/(val - 0.08825) + 0.05);
-			int value = (int)(102.5149651*pow((.3091605258),val) + 0.5);			
+			int value = irDistance(param->irCal[0],val);
 
 			if(countStartIR1 == 0)
 			{
@@ -256,7 +294,7 @@ static portTASK_FUNCTION( vDistanceUpdateTask, pvParameters )
 			{
 				i2cCmdDistance[2] = i2cCmdDistance[2]/leftM;
 				i2cCmdDistance[3] = i2cCmdDistance[3]/rightM;
-				if (vtI2CConQ(devPtr,DistanceMsg,0x4F,sizeof(i2cCmdDistance),i2cCmdDistance,sizeof(i2cCmdDistance)) != pdTRUE) {
+				if (vtSensorPublishValues(DistanceMsg,i2cCmdDistance[1],i2cCmdDistance[2],i2cCmdDistance[3],portMAX_DELAY) != pdTRUE) {
 					VT_HANDLE_FATAL_ERROR(0);
 				}
 				leftM = 0;
@@ -277,14 +315,10 @@ static portTASK_FUNCTION( vDistanceUpdateTask, pvParameters )
 			// val2 = 8765 4321
 			//if so the below undoes it and puts it back together
 			//piece together 10 bit value
-			double val = val1* 256 + val2;
+			int val = val1*256 + val2;
 			if(val==0)
 				break;
-			//normally would be -0.45 but to round i added 0.5
-			val = val*5.0/1024.0;
-			//int value = 27/val;
-			//int value = (int)(25.50958/(val - 0.08825) + 0.05);
-			int value = (int)(102.5149651*pow((.3091605258),val) + 0.5);
+			int value = irDistance(param->irCal[1],val);
 
 			if(countStartIR2 == 0)
 			{
@@ -329,7 +363,7 @@ static portTASK_FUNCTION( vDistanceUpdateTask, pvParameters )
 			if(centerM >= 1)
 			{
 				i2cCmdFrontVal[3] = i2cCmdFrontVal[3]/centerM;
-				if (vtI2CConQ(devPtr,FrontValMsg,0x4F,sizeof(i2cCmdFrontVal),i2cCmdFrontVal,sizeof(i2cCmdFrontVal)) != pdTRUE) {
+				if (vtSensorPublishValues(FrontValMsg,i2cCmdFrontVal[1],i2cCmdFrontVal[2],i2cCmdFrontVal[3],portMAX_DELAY) != pdTRUE) {
 					VT_HANDLE_FATAL_ERROR(0);
 				}
 				centerM = 0;
@@ -347,14 +381,10 @@ static portTASK_FUNCTION( vDistanceUpdateTask, pvParameters )
 			// val2 = 8765 4321
 			//if so the below undoes it and puts it back together
 			//piece together 10 bit value
-			double val = val1* 256 + val2;
-			//normally would be -0.45 but to round i added 0.5
+			int val = val1*256 + val2;
 			if (val==0)
 				break;
-			val = val*5.0/1024.0;
-			//int value = (int)(25.50958/(val - 0.08825) + 0.05);
-			int value = (int)(102.5149651*pow((.3091605258),val) + 0.5);
-			//int value = 27/val;
+			int value = irDistance(param->irCal[2],val);
 
 			if(countStartIR3 == 0)
 			{
@@ -401,7 +431,7 @@ static portTASK_FUNCTION( vDistanceUpdateTask, pvParameters )
 			{
 				i2cCmdDistance[2] = i2cCmdDistance[2]/leftM;
 				i2cCmdDistance[3] = i2cCmdDistance[3]/rightM;
-				if (vtI2CConQ(devPtr,DistanceMsg,0x4F,sizeof(i2cCmdDistance),i2cCmdDistance,sizeof(i2cCmdDistance)) != pdTRUE) {
+				if (vtSensorPublishValues(DistanceMsg,i2cCmdDistance[1],i2cCmdDistance[2],i2cCmdDistance[3],portMAX_DELAY) != pdTRUE) {
 					VT_HANDLE_FATAL_ERROR(0);
 				}
 				leftM = 0;
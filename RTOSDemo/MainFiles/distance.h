@@ -2,12 +2,26 @@
 #define DISTANCE_TASK_H
 #include "vtI2C.h"
 #include "lcdTask.h"
+// Calibration for an IR range sensor: the distance (in 1/16 cm) at every 16th 10-bit ADC code,
+//   cm16[k] being for code k*16 (the last point is for code 1024, one past the top of the range)
+//   Codes in between are interpolated
+#define vtIRCalShift 4
+#define vtIRCalPoints ((1024 >> vtIRCalShift) + 1)
+typedef struct __vtIRCalibration {
+	uint16_t cm16[vtIRCalPoints];
+} vtIRCalibration;
+// The calibration each sensor starts with: 102.5149651 * 0.3091605258^volts (0-5V over the 10-bit range)
+extern const vtIRCalibration vtIRCalDefault;
+// The IR sensors handled by this task
+#define vtDistanceNumIR 3
+
 // Structure used to pass parameters to the task
 // Do not touch...
 typedef struct __DistanceStruct {
 	vtI2CStruct *dev;
 	vtLCDStruct *lcdData;
 	xQueueHandle inQ;
+	const vtIRCalibration *irCal[vtDistanceNumIR];
 } vtDistanceStruct;
 // Maximum length of a message that can be received by this task
 #define vtDistanceMaxLen   (sizeof(portTickType))
@@ -23,6 +37,15 @@ typedef struct __DistanceStruct {
 //   lcd: pointer to the data structure for an LCD task (may be NULL)
 void vStartDistanceTask(vtDistanceStruct *distanceData,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtLCDStruct *lcd);
 
+//
+// Use a different calibration for one of the IR sensors (call after vStartDistanceTask() and before
+//   the scheduler is started)
+// Args:
+//   distanceData: Data structure used by the task
+//   sensor: which sensor (0-2 for IR1-IR3)
+//   cal: the calibration to use -- *must* not be de-allocated
+void vDistanceSetIRCalibration(vtDistanceStruct *distanceData,int sensor,const vtIRCalibration *cal);
+
 /*//
 // Send a timer message to the Distance task
 // Args:
@@ -11,13 +11,23 @@
 // Define a data structure that is used to pass and hold parameters for this task
 // Functions that use the API should not directly access this structure, but rather simply
 //   pass the structure as an argument to the API calls
-typedef struct __vtLCDStruct {
-	xQueueHandle inQ;					   	// Queue used to send messages from other tasks to the LCD task to print
-} vtLCDStruct;
-
 // Structure used to define the messages that are sent to the LCD thread
 //   the maximum length of a message to be printed is the size of the "buf" field below
 #define vtLCDMaxLen 20
+// Number of text lines on the screen
+#define vtLCDNumLines 10
+
+typedef struct __vtLCDStruct {
+	xQueueHandle inQ;					   	// Queue used to send messages from other tasks to the LCD task to print
+	// Mailbox for SendLCDPrintMsg(): the latest text for each line that the task has not printed yet
+	char lineText[vtLCDNumLines][vtLCDMaxLen+1];
+	uint16_t linesPending;					// Bit n set if lineText[n] has not been printed
+	uint8_t wakeQueued;						// A message to print the pending lines is already on inQ
+	// Clears are counted so that a mailbox line is printed in order with the clears on inQ
+	uint16_t lineClears[vtLCDNumLines];		// clearsSent when lineText[n] was written
+	uint16_t clearsSent;					// Clear messages put on inQ
+	uint16_t clearsDone;					// Clear messages carried out by the task
+} vtLCDStruct;
 
 /* ********************************************************************* */
 // The following are the public API calls that other tasks should use to work with the LCD task
@@ -63,14 +73,18 @@ portBASE_TYPE SendLCDPixelBuff(vtLCDStruct *lcdData,int x, int* y, portTickType
 portBASE_TYPE SendLCDGraph(vtLCDStruct *lcdData, portTickType ticksToBlock);
 //
 // Send a string message to the LCD task for it to print
+//   The string replaces any earlier string for the same line that has not been printed yet, so a line that is
+//   updated faster than the LCD can keep up shows the latest value and the rest are dropped.  It keeps its
+//   place against clears: a clear sent after it does not get wiped by it, a clear sent before it does not wipe it
 // Args:
 //   lcdData -- a pointer to a variable of type vtLCDStruct
 //   length -- number of characters in the string -- the call will result in a fatal error if you exceed the maximum length
 //   pString -- string to print to the LCD
 //   line -- line that the string should be printed on (0-9)
-//   ticksToBlock -- how long the routine should wait if the queue is full
+//   ticksToBlock -- how long to wait for room on the queue for the message that wakes the task
 // Return:
-//   Result of the call to xQueueSend()
+//   pdTRUE if the wake-up is on the queue; errQUEUE_FULL if it did not fit in ticksToBlock (the string is
+//   kept all the same and the task picks it up shortly)
 portBASE_TYPE SendLCDPrintMsg(vtLCDStruct *lcdData,int length,char *pString,int line, portTickType ticksToBlock);
 //
 // Send a string message to the LCD task for it to print vertically
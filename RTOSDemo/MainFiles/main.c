@@ -95,6 +95,8 @@
 #define USE_MTJ_USE_USB 0
 // Define to use Navigation data
 #define USE_NAV 1
+// Define to start the sensor reads from the sensor PIC's data-ready line (0 to poll from the Nav timer)
+#define USE_SENSOR_READY 1
 
 #if USE_FREERTOS_DEMO == 1
 /* Demo app includes. */
@@ -114,12 +116,15 @@
 
 // Include file for MTJ's LCD & i2cTemp tasks
 #include "vtUtilities.h"
+#include "vtTrace.h"
 #include "lcdTask.h"
 #include "navigation.h"
 #include "mapping.h"
 #include "vtI2C.h"
 #include "myTimers.h"
 #include "conductor.h"
+#include "sensorReady.h"
+#include "motor.h"
 #include "testing.h"
 
 /* syscalls initialization -- *must* occur first */
@@ -145,10 +150,13 @@ tick hook). */
 #define mainI2CTEMP_TASK_PRIORITY			( tskIDLE_PRIORITY)
 #define mainUSB_TASK_PRIORITY				( tskIDLE_PRIORITY)
 #define mainI2CMONITOR_TASK_PRIORITY		( tskIDLE_PRIORITY)
-#define mainCONDUCTOR_TASK_PRIORITY			( tskIDLE_PRIORITY)
 #define mainNAV_TASK_PRIORITY				( tskIDLE_PRIORITY)
 #define mainMAP_TASK_PRIORITY				( tskIDLE_PRIORITY)
 #define mainDISTANCE_TASK_PRIORITY				( tskIDLE_PRIORITY)
+// Only starts I2C reads, so it goes ahead of the tasks that use them
+#define mainSENSOR_READY_TASK_PRIORITY		( tskIDLE_PRIORITY + 1)
+// Ahead of the tasks that ask for motor commands, so a command goes out as soon as it is asked for
+#define mainMOTOR_TASK_PRIORITY				( tskIDLE_PRIORITY + 1)
 
 /* The WEB server has a larger stack as it utilises stack hungry string
 handling library calls. */
@@ -199,6 +207,12 @@ static vtNavStruct navData;
 static vtMapStruct mapData;
 // data structure required for conductor task
 static vtConductorStruct conductorData;
+// data structure required for the motor task
+static vtMotorStruct motorData;
+#if USE_SENSOR_READY == 1
+// data structure required for the sensor data-ready task
+static vtSensorReadyStruct sensorReadyData;
+#endif
 #endif
 
 //#if TESTING == 1
@@ -225,6 +239,9 @@ int main( void )
 	/* Configure the hardware for use by this demo. */
 	prvSetupHardware();
 
+	// Start the kernel event trace before anything is created, so the task and queue names are in it
+	vtTraceStart();
+
 	#if USE_FREERTOS_DEMO == 1
 	/* Start the standard demo tasks.  These are just here to exercise the
 	kernel port and provide examples of how the FreeRTOS API can be used. */
@@ -266,20 +283,27 @@ int main( void )
 	 // MTJ: My i2cTemp demonstration task
 	// First, start up an I2C task and associate it with the I2C0 hardware on the ARM (there are 3 I2C devices, we need this one)
 	// See vtI2C.h & vtI2C.c for more details on this task and the API to access the task
-	// Initialize I2C0 for I2C0 at an I2C clock speed of 100KHz
-	if (vtI2CInit(&vtI2C0,0,mainI2CMONITOR_TASK_PRIORITY,100000,&vtLCDdata) != vtI2CInitSuccess) {
+	// Initialize I2C0 for I2C0 at an I2C clock speed of 100KHz (vtI2CFastMode selects 400KHz)
+	if (vtI2CInit(&vtI2C0,0,mainI2CMONITOR_TASK_PRIORITY,vtI2CStandardMode,&vtLCDdata) != vtI2CInitSuccess) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
+	// the motor task is the only one that sends commands to the motor PIC
+	vStartMotorTask(&motorData,mainMOTOR_TASK_PRIORITY,&vtI2C0,&vtLCDdata,&vtTestData);
 	//Start up the task that is going to handle the navigation
-	vStartNavTask(&navData,mainNAV_TASK_PRIORITY,&vtI2C0,&vtLCDdata,&mapData,&vtTestData);
+	vStartNavTask(&navData,mainNAV_TASK_PRIORITY,&vtI2C0,&vtLCDdata,&mapData,&vtTestData,&motorData);
+	#if USE_SENSOR_READY == 1
+	// the sensor PIC says when it has a sample and the read is started from its interrupt
+	vStartSensorReadyTask(&sensorReadyData,mainSENSOR_READY_TASK_PRIORITY,&vtI2C0);
+	#else
 	// starts a navigation timer that will send messages to the Navigation task. The timer will determine how often the data is sampled.
 	startTimerForNav(&navData);
+	#endif
 	//starts the mapping task
 	vStartMapTask(&mapData,mainMAP_TASK_PRIORITY,&vtI2C0,&vtLCDdata);
 	//starts the distance task
 	vStartDistanceTask(&distanceData,mainDISTANCE_TASK_PRIORITY,&vtI2C0,&vtLCDdata);
-	// start up a "conductor" task that will move messages around
-	vStartConductorTask(&conductorData,mainCONDUCTOR_TASK_PRIORITY,&vtI2C0,&navData,&mapData,&distanceData);
+	// set up the "conductor" routing that moves the I2C results to the tasks that want them
+	vStartConductorTask(&conductorData,&vtI2C0,&navData,&mapData,&distanceData,&motorData);
 	#endif
 
 	#if TESTING == 1
@@ -414,9 +438,9 @@ const unsigned long TCR_COUNT_RESET = 2, CTCR_CTM_TIMER = 0x00, TCR_COUNT_ENABLE
 	/* Just count up. */
 	TIM0->CTCR = CTCR_CTM_TIMER;
 
-	/* Prescale to a frequency that is good enough to get a decent resolution,
-	but not too fast so as to overflow all the time. */
-	TIM0->PR =  ( configCPU_CLOCK_HZ / 10000UL ) - 1UL;
+	/* Prescale to 1MHz: fine enough to time the kernel events in the trace
+	(vtTrace.h), and the count only wraps every 71 minutes. */
+	TIM0->PR =  ( configCPU_CLOCK_HZ / vtTraceClockHz ) - 1UL;
 
 	/* Start the counter. */
 	TIM0->TCR = TCR_COUNT_ENABLE;
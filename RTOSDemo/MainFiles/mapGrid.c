@@ -0,0 +1,265 @@
+#include <stdlib.h>
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* include files. */
+#include "vtUtilities.h"
+#include "mapGrid.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+// Heading change for one cm of difference between the wheels: 65536/(2*pi*vtMapGridTrackCm)
+#define mapGridTURN_PER_CM 652
+// The Sharp sensors read flat past this, so a reading this long has not hit anything (cm)
+#define mapGridIR_RANGE_CM 75
+// Fixed point: pose in 1/256 cm, sines in 1/16384
+#define mapGridPOSE_SHIFT 8
+#define mapGridSIN_SHIFT 14
+// Direction each sensor looks in, relative to the heading
+static const uint16_t irDirection[3] = { 0x4000, 0x0000, 0xC000 };
+
+// sin() over the first quarter turn in 64 steps, in 1/16384
+static const int16_t sinQuarter[65] = {
+	    0,   402,   804,  1205,  1606,  2006,  2404,  2801,  3196,  3590,  3981,  4370,  4756,
+	 5139,  5520,  5897,  6270,  6639,  7005,  7366,  7723,  8076,  8423,  8765,  9102,  9434,
+	 9760, 10080, 10394, 10702, 11003, 11297, 11585, 11866, 12140, 12406, 12665, 12916, 13160,
+	13395, 13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978, 15137, 15286, 15426, 15557,
+	15679, 15791, 15893, 15986, 16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379, 16384,
+};
+
+// Four cells to a byte, row by row
+static uint8_t grid[(vtMapGridWidth*vtMapGridHeight)/4] vtMapGridSection;
+static vtMapGridPose pose;
+static vtMapGridStats stats;
+// Result of the last measurement ahead (cm)
+static volatile int freeAhead = 0;
+
+// A Bresenham line between two cells
+typedef struct __mapGridLine {
+	int x, y;			// the cell it is at
+	int x1, y1;			// the cell it ends at
+	int dx, dy, sx, sy, err;
+} mapGridLine;
+// end of defs
+/* *********************************************** */
+
+static int gridSin(uint16_t angle)
+{
+	int i = ((angle + 0x80) >> 8) & 0xFF;
+
+	switch (i >> 6) {
+	case 0: return(sinQuarter[i]);
+	case 1: return(sinQuarter[128-i]);
+	case 2: return(-sinQuarter[i-128]);
+	default: return(-sinQuarter[256-i]);
+	}
+}
+
+static int gridCos(uint16_t angle)
+{
+	return(gridSin(angle + 0x4000));
+}
+
+// Cell holding a point given in 1/256 cm
+static int gridCellX(int32_t x)
+{
+	return((x >> (mapGridPOSE_SHIFT + vtMapGridCellShift)) + vtMapGridWidth/2);
+}
+
+static int gridCellY(int32_t y)
+{
+	return((y >> (mapGridPOSE_SHIFT + vtMapGridCellShift)) + vtMapGridHeight/2);
+}
+
+static int gridOnGrid(int cx,int cy)
+{
+	return((cx >= 0) && (cx < vtMapGridWidth) && (cy >= 0) && (cy < vtMapGridHeight));
+}
+
+static int gridGet(int cx,int cy)
+{
+	int i = cy*vtMapGridWidth + cx;
+
+	return((grid[i >> 2] >> ((i & 3) << 1)) & 3);
+}
+
+static void gridSet(int cx,int cy,int value)
+{
+	int i = cy*vtMapGridWidth + cx;
+	int shift = (i & 3) << 1;
+
+	stats.cells[(grid[i >> 2] >> shift) & 3]--;
+	stats.cells[value]++;
+	grid[i >> 2] = (grid[i >> 2] & ~(3 << shift)) | (value << shift);
+}
+
+// A ray went through the cell
+static void gridMiss(int cx,int cy)
+{
+	int cell = gridGet(cx,cy);
+
+	if (cell != vtMapGridFree) {
+		gridSet(cx,cy,(cell == vtMapGridWall) ? vtMapGridMaybe : vtMapGridFree);
+	}
+}
+
+// A ray ended in the cell
+static void gridHit(int cx,int cy)
+{
+	int cell = gridGet(cx,cy);
+
+	if (cell != vtMapGridWall) {
+		gridSet(cx,cy,(cell == vtMapGridMaybe) ? vtMapGridWall : vtMapGridMaybe);
+	}
+}
+
+static void lineStart(mapGridLine *line,int x0,int y0,int x1,int y1)
+{
+	line->x = x0;
+	line->y = y0;
+	line->x1 = x1;
+	line->y1 = y1;
+	line->dx = abs(x1 - x0);
+	line->dy = -abs(y1 - y0);
+	line->sx = (x0 < x1) ? 1 : -1;
+	line->sy = (y0 < y1) ? 1 : -1;
+	line->err = line->dx + line->dy;
+}
+
+// Move on to the next cell; returns 0 if it was already at the end
+static int lineStep(mapGridLine *line)
+{
+	int e2 = 2*line->err;
+
+	if ((line->x == line->x1) && (line->y == line->y1)) {
+		return(0);
+	}
+	if (e2 >= line->dy) {
+		line->err += line->dy;
+		line->x += line->sx;
+	}
+	if (e2 <= line->dx) {
+		line->err += line->dx;
+		line->y += line->sy;
+	}
+	return(1);
+}
+
+// Walk straight ahead through the free cells and keep how far that got
+static void gridMeasureAhead(void)
+{
+	mapGridLine line;
+	int32_t reach = ((int32_t) vtMapGridMaxRay*vtMapGridCellCm) << mapGridPOSE_SHIFT;
+	int c = gridCos(pose.heading), s = gridSin(pose.heading);
+	int x0 = gridCellX(pose.x), y0 = gridCellY(pose.y);
+	int lastX = x0, lastY = y0;
+
+	lineStart(&line,x0,y0,gridCellX(pose.x + ((reach*c) >> mapGridSIN_SHIFT)),gridCellY(pose.y + ((reach*s) >> mapGridSIN_SHIFT)));
+	while (lineStep(&line) && gridOnGrid(line.x,line.y) && (gridGet(line.x,line.y) == vtMapGridFree)) {
+		lastX = line.x;
+		lastY = line.y;
+	}
+	// distance to the far side of the last free cell, along the heading
+	freeAhead = ((((lastX - x0)*c + (lastY - y0)*s) >> mapGridSIN_SHIFT) << vtMapGridCellShift);
+	if (freeAhead < 0) {
+		freeAhead = 0;
+	}
+}
+
+/*-----------------------------------------------------------*/
+// Public API
+void vtMapGridInit(void)
+{
+	memset(grid,0,sizeof(grid));
+	memset(&pose,0,sizeof(pose));
+	memset(&stats,0,sizeof(stats));
+	stats.cells[vtMapGridUnknown] = vtMapGridWidth*vtMapGridHeight;
+	freeAhead = 0;
+}
+
+void vtMapGridMove(int leftCm,int rightCm)
+{
+	// half of the sum of the wheels, in 1/256 cm
+	int32_t d = (int32_t) (leftCm + rightCm) << (mapGridPOSE_SHIFT - 1);
+	int32_t turn = (int32_t) (rightCm - leftCm)*mapGridTURN_PER_CM;
+	// go along the chord, which points half way between the old and new headings
+	uint16_t mid = pose.heading + (uint16_t) (turn/2);
+
+	stats.moves++;
+	portENTER_CRITICAL();
+	pose.x += (d*gridCos(mid)) >> mapGridSIN_SHIFT;
+	pose.y += (d*gridSin(mid)) >> mapGridSIN_SHIFT;
+	pose.heading += (uint16_t) turn;
+	portEXIT_CRITICAL();
+	gridMeasureAhead();
+}
+
+void vtMapGridRange(int sensor,int cm)
+{
+	mapGridLine line;
+	uint16_t dir;
+	int32_t r;
+	int n;
+
+	if ((sensor < vtMapGridIRLeft) || (sensor > vtMapGridIRRight)) {
+		VT_HANDLE_FATAL_ERROR(sensor);
+	}
+	stats.rays++;
+	dir = pose.heading + irDirection[sensor];
+	r = (int32_t) cm << mapGridPOSE_SHIFT;
+	lineStart(&line,gridCellX(pose.x),gridCellY(pose.y),
+		gridCellX(pose.x + ((r*gridCos(dir)) >> mapGridSIN_SHIFT)),gridCellY(pose.y + ((r*gridSin(dir)) >> mapGridSIN_SHIFT)));
+	// every cell up to the end is free
+	for (n=0;(line.x != line.x1) || (line.y != line.y1);n++) {
+		if ((n >= vtMapGridMaxRay) || !gridOnGrid(line.x,line.y)) {
+			stats.clipped++;
+			gridMeasureAhead();
+			return;
+		}
+		gridMiss(line.x,line.y);
+		stats.cellsTraced++;
+		lineStep(&line);
+	}
+	// and the end holds whatever the sensor saw
+	if (gridOnGrid(line.x,line.y)) {
+		if (cm < mapGridIR_RANGE_CM) {
+			gridHit(line.x,line.y);
+		} else {
+			gridMiss(line.x,line.y);
+		}
+		stats.cellsTraced++;
+	}
+	gridMeasureAhead();
+}
+
+int vtMapGridFreeAhead(void)
+{
+	return(freeAhead);
+}
+
+int vtMapGridGetCell(int cx,int cy)
+{
+	if (!gridOnGrid(cx,cy)) {
+		return(vtMapGridUnknown);
+	}
+	return(gridGet(cx,cy));
+}
+
+void vtMapGridGetPose(vtMapGridPose *p)
+{
+	portENTER_CRITICAL();
+	*p = pose;
+	portEXIT_CRITICAL();
+}
+
+void vtMapGridGetStats(vtMapGridStats *s)
+{
+	portENTER_CRITICAL();
+	*s = stats;
+	portEXIT_CRITICAL();
+}
+// End of Public API
+/*-----------------------------------------------------------*/
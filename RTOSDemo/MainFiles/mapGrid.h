@@ -0,0 +1,91 @@
+#ifndef MAP_GRID_H
+#define MAP_GRID_H
+#include "FreeRTOS.h"
+
+// Occupancy grid of the course, built by the mapping task from the wheel travel and the three IR distances.
+//
+// The grid is vtMapGridWidth x vtMapGridHeight cells of vtMapGridCellCm cm, two bits a cell, with the rover
+//   starting in the middle of it facing +x.  It is 8KB and lives in the second AHB SRAM bank (0x20080000, see
+//   the .usb_ram section in ldscript_rom_gnu.ld), which nothing but the spill-over heap in syscalls.c uses.
+//
+// All of the arithmetic is fixed point:
+//   -- the pose is kept in 1/256 cm with the heading as a 16-bit binary angle (65536 = 360 degrees)
+//   -- each wheel travel sample moves the pose along the arc between the two wheels
+//   -- each IR distance is traced from the pose to the point it hit with Bresenham's line, marking the cells
+//      it passed through as free and the last one as occupied; a ray is never more than vtMapGridMaxRay cells
+//   -- after each update the free space straight ahead is measured again, so vtMapGridFreeAhead() just reads it
+//
+// Only the mapping task updates the grid.  The query functions may be called from any task.
+
+#define vtMapGridCellShift 2
+#define vtMapGridCellCm (1 << vtMapGridCellShift)
+#define vtMapGridWidth 256
+#define vtMapGridHeight 128
+// Distance between the wheels (cm) -- on a turn tighter than half of this the inside wheel goes backwards
+#define vtMapGridTrackCm 16
+// Longest ray traced for one reading (cells)
+#define vtMapGridMaxRay 24
+
+// What a cell holds: a cell reported occupied once is "maybe", twice is a wall, and it takes a ray passing
+//   through a wall twice to make it free again
+#define vtMapGridUnknown 0
+#define vtMapGridFree 1
+#define vtMapGridMaybe 2
+#define vtMapGridWall 3
+
+// The IR sensors, by the direction they look
+#define vtMapGridIRLeft 0
+#define vtMapGridIRFront 1
+#define vtMapGridIRRight 2
+
+// The grid is placed by the linker on the target -- the host build defines this as nothing
+#ifndef vtMapGridSection
+#define vtMapGridSection __attribute__ ((section ("USB_RAM")))
+#endif
+
+// Where the mapping task thinks the rover is
+typedef struct __vtMapGridPose {
+	int32_t x;			// 1/256 cm from the middle of the grid
+	int32_t y;
+	uint16_t heading;	// 65536 = 360 degrees, counter clockwise from +x
+} vtMapGridPose;
+
+// Counters kept by the grid (see vtMapGridGetStats())
+typedef struct __vtMapGridStats {
+	unsigned long moves;			// wheel travel samples
+	unsigned long rays;				// IR distances traced
+	unsigned long cellsTraced;		// cells visited by the rays
+	unsigned long clipped;			// rays cut short by the edge of the grid or vtMapGridMaxRay
+	unsigned long cells[4];			// cells holding each of vtMapGridUnknown..vtMapGridWall
+} vtMapGridStats;
+
+// Public API
+//
+// Clear the grid and put the rover back in the middle of it (the grid is not cleared at reset)
+void vtMapGridInit(void);
+//
+// Move the rover by one wheel travel sample
+// Args:
+//   leftCm, rightCm -- distance each wheel has moved (negative for backwards)
+void vtMapGridMove(int leftCm,int rightCm);
+//
+// Add one IR distance to the grid
+// Args:
+//   sensor -- vtMapGridIRLeft, vtMapGridIRFront or vtMapGridIRRight
+//   cm -- the distance (readings at or past the sensor's range only clear cells)
+void vtMapGridRange(int sensor,int cm);
+//
+// How far ahead of the rover (cm) the cells are known to be free
+int vtMapGridFreeAhead(void);
+//
+// Look up a cell
+// Args:
+//   cx, cy -- the cell, with (0,0) in the corner and the rover starting at (vtMapGridWidth/2,vtMapGridHeight/2)
+// Return:
+//   vtMapGridUnknown..vtMapGridWall (vtMapGridUnknown off the grid)
+int vtMapGridGetCell(int cx,int cy);
+//
+// Copy out the pose and the counters
+void vtMapGridGetPose(vtMapGridPose *pose);
+void vtMapGridGetStats(vtMapGridStats *stats);
+#endif
@@ -12,10 +12,13 @@
 /* include files. */
 #include "vtUtilities.h"
 #include "vtI2C.h"
-#include "LCDtask.h"
+#include "lcdTask.h"
 #include "navigation.h"
 #include "mapping.h"
 #include "I2CTaskMsgTypes.h"
+#include "sensorBus.h"
+#include "motor.h"
+#include "mapGrid.h"
 
 /* *********************************************** */
 // definitions and data structures that are private to this file
@@ -27,6 +30,7 @@ typedef struct __vtMapMsg {
 	uint8_t count;	 // raidus / wall byte depending on the message type
 	uint8_t rightDistance;	 //distance since last change
 	uint8_t leftDistance;	 //distance since last change 
+	uint8_t status;	 // I2C status of a sample from the bus (SUCCESS for everything else)
 } vtMapMsg;
 
 // I have set this to a large stack size because of (a) using printf() and (b) the depth of function calls
@@ -48,8 +52,41 @@ typedef struct __vtMapMsg {
 #define CHANGETOTURN 5  			//cm before change to a turn to update speed
 #define MINWIDEDIST 11				//minimum radius to be counted as a wide turn
 
+// Most segments (straights, turns and haults) that can be recorded on the first run -- enough for any
+//   course that fits in the arena.  Segments past this are not recorded and the second run drives them
+//   at whatever speed it is going.
+#define mapMAX_SEGMENTS 128
+// brakeAt value for a segment that is not followed by a turn
+#define mapNO_BRAKE 0xFFFF
+
+// Definitions of the states for the FSM below
+#define fsmStateStraight 0
+#define fsmStateTurnLeft 1
+#define fsmStateTurnRight 2
+#define fsmStateHault 3
+
+// One segment of the course, as recorded on the first run and then compiled into the speed plan for the second
+typedef struct __mapSegment {
+	uint8_t state;			// fsmState... the rover was in
+	uint8_t radius;			// turn radius (127 for straight)
+	uint16_t length;		// cm -- average of the two wheels on a straight, the inside wheel on a turn
+	// the speed plan (see mapCompilePlan())
+	uint8_t entrySpeed;		// speed to change to on entering the segment (0 to keep the current one)
+	uint8_t brakeSpeed;		// speed for the turn that follows
+	uint16_t brakeAt;		// change to brakeSpeed once the two wheels have gone this far in total (cm), or mapNO_BRAKE
+} mapSegment;
+
+// Segment k is the one entered at the k-th change of state (segment 0 is the state before the first change)
+static mapSegment segments[mapMAX_SEGMENTS];
+static int numSegments = 0;
+
 uint8_t FIRST = 1;
 uint8_t curCount = 0;
+// Memory for the task and its queue
+static portSTACK_TYPE mapStack[i2cSTACK_SIZE];
+static xStaticTask mapTCB;
+static xStaticQueue mapQueue;
+static uint8_t mapQueueStorage[vtMapQLen*sizeof(vtMapMsg)];
 // end of defs
 /* *********************************************** */
 
@@ -61,19 +98,25 @@ static portTASK_FUNCTION_PROTO( vMapUpdateTask, pvParameters );
 void vStartMapTask(vtMapStruct *params,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtLCDStruct *lcd)
 {
 	// Create the queue that will be used to talk to this task
-	if ((params->inQ = xQueueCreate(vtMapQLen,sizeof(vtMapMsg))) == NULL) {
+	if ((params->inQ = xQueueCreateStatic(vtMapQLen,sizeof(vtMapMsg),mapQueueStorage,&mapQueue)) == NULL) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
 	/* Start the task */
 	portBASE_TYPE retval;
 	params->dev = i2c;
 	params->lcdData = lcd;
-	if ((retval = xTaskCreate( vMapUpdateTask, ( signed char * ) "Mapping", i2cSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL )) != pdPASS) {
+	vtMapGridInit();
+	if ((retval = xTaskCreateStatic( vMapUpdateTask, ( signed char * ) "Mapping", i2cSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL, mapStack, &mapTCB )) != pdPASS) {
 		VT_HANDLE_FATAL_ERROR(retval);
 	}
 }
 
 portBASE_TYPE SendMapMsg(vtMapStruct *mapData,uint8_t msgType,uint8_t count,uint8_t leftDistance,uint8_t rightDistance,portTickType ticksToBlock)
+{
+	return(SendMapSample(mapData,msgType,count,leftDistance,rightDistance,SUCCESS,ticksToBlock));
+}
+
+portBASE_TYPE SendMapSample(vtMapStruct *mapData,uint8_t msgType,uint8_t count,uint8_t leftDistance,uint8_t rightDistance,uint8_t status,portTickType ticksToBlock)
 {
 	vtMapMsg mapBuffer;
 
@@ -84,6 +127,7 @@ portBASE_TYPE SendMapMsg(vtMapStruct *mapData,uint8_t msgType,uint8_t count,uint
 	mapBuffer.count = count;
 	mapBuffer.rightDistance = rightDistance;
 	mapBuffer.leftDistance = leftDistance;
+	mapBuffer.status = status;
 	return(xQueueSend(mapData->inQ,(void *) (&mapBuffer),ticksToBlock));
 }
 
@@ -108,6 +152,10 @@ uint8_t getLeftDistance(vtMapMsg *Buffer)
 	uint8_t ld = (uint8_t) Buffer->leftDistance;
 	return(ld);
 }
+uint8_t getStatus(vtMapMsg *Buffer)
+{
+	return(Buffer->status);
+}
 
 /* I2C commands for the temperature sensor
 	const uint8_t i2cCmdInit[]= {0xAC,0x00};
@@ -118,51 +166,85 @@ uint8_t getLeftDistance(vtMapMsg *Buffer)
 	const uint8_t i2cCmdReadSlope[]= {0xA9};
 // end of I2C command definitions */
 
+// Record the segment that has just ended (first run only)
+static void mapRecord(uint8_t state,uint8_t radius,int DL,int DR)
+{
+	mapSegment *seg;
+
+	if (numSegments >= mapMAX_SEGMENTS) {
+		return;
+	}
+	seg = &segments[numSegments++];
+	seg->state = state;
+	seg->radius = radius;
+	if (state == fsmStateStraight) {
+		// average of the distance travelled
+		seg->length = (DL + DR + 1)/2;
+	} else if (state == fsmStateTurnLeft) {
+		// inside track distance
+		seg->length = DL;
+	} else if (state == fsmStateTurnRight) {
+		seg->length = DR;
+	} else {
+		seg->length = 0;
+	}
+}
+
+// Work out, once, what the second run does in each segment: speed up on a long enough straight, and slow down
+//   CHANGETOTURN cm before a turn (more for a sharp one)
+static void mapCompilePlan(void)
+{
+	int i;
+	mapSegment *seg, *next;
+
+	for (i=0;i<numSegments;i++) {
+		seg = &segments[i];
+		next = (i+1 < numSegments) ? &segments[i+1] : NULL;
+		seg->entrySpeed = ((seg->state == fsmStateStraight) && (seg->length > MINSTRAIGHT)) ? MAXSTRAIGHT : 0;
+		seg->brakeAt = mapNO_BRAKE;
+		seg->brakeSpeed = 0;
+		if ((next != NULL) && ((next->state == fsmStateTurnLeft) || (next->state == fsmStateTurnRight))) {
+			// in wheel travel summed over both wheels, so the second run does not have to average them
+			seg->brakeAt = (seg->length > CHANGETOTURN) ? 2*(seg->length - CHANGETOTURN) : 0;
+			seg->brakeSpeed = (next->radius > MINWIDEDIST) ? MAXWIDETURN : MAXSHARPTURN;
+		}
+	}
+}
+
+// Tell the navigation task to change speed
+static void mapSendSpeed(uint8_t speed)
+{
+	if (vtSensorPublishValues(UpdateSpeed,0,0,speed,portMAX_DELAY) != pdTRUE) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+}
+
 // This is the actual task that is run
 static portTASK_FUNCTION( vMapUpdateTask, pvParameters )
 {
-	// Define local constants here
-	uint8_t i2cCmdSpeed[] = {0x05,0x00,0x00,0x00};
 	// Get the parameters
 	vtMapStruct *param = (vtMapStruct *) pvParameters;
-	// Get the I2C device pointer
-	vtI2CStruct *devPtr = param->dev;
-	// Get the LCD information pointer
-	vtLCDStruct *lcdData = param->lcdData;
-
-	// String buffer for printing
-	char lcdBuffer[vtLCDMaxLen+1];
-	
+
 	// Buffer for receiving messages
 	vtMapMsg msgBuffer;
 
-	// Definitions of the states for the FSM below
-	const uint8_t fsmStateStraight = 0;
-	const uint8_t fsmStateTurnLeft = 1;
-	const uint8_t fsmStateTurnRight = 2;	  
-	const uint8_t fsmStateHault = 3;
-
 	uint8_t currentState = fsmStateHault;
 	uint8_t curRaid = 255;
 	//ints for storing distance traveled in a current state
 	int DL = 0;
 	int DR = 0;
 
-	//used to store the map
-	int map[20][3];
-	//map[i][0] = state
-	//map[i][1] = distance
-	//map[i][2] = radius
-	
-	//int to know the current state
-	int stateCount = 0;
-
-
-	//bool to determine if an update speed has been sent or not before a turn
+	// The segment the second run is in (NULL once it is past the end of the plan)
+	const mapSegment *seg = NULL;
+	// whether the speed has been dropped for the turn at the end of the segment yet
 	uint8_t notSent = 1;
 
 	int speed = MAXSHARPTURN;
 
+	// radius byte of the last command written to the motor PIC -- the encoders only count distance, so this
+	//   is how the grid knows that one wheel is going backwards
+	uint8_t motorRadius = vtMotorRadiusStraight;
+
 	int time[2];
 	//0 for first run
 	//1 for second run
@@ -188,6 +270,20 @@ static portTASK_FUNCTION( vMapUpdateTask, pvParameters )
 			DL = DL + leftD;
 			DR = DR + rightD;
 
+			// the inside wheel of a spin or a tight turn is going backwards
+			if((motorRadius < vtMotorRadiusStraight) && (motorRadius < vtMapGridTrackCm/2))
+			{
+				vtMapGridMove(-leftD,rightD);
+			}
+			else if((motorRadius >= vtMotorRadiusRight) && (motorRadius - vtMotorRadiusRight < vtMapGridTrackCm/2))
+			{
+				vtMapGridMove(leftD,-rightD);
+			}
+			else
+			{
+				vtMapGridMove(leftD,rightD);
+			}
+
 			if(FIRST == 1)
 			{
 				time[0] += (rightD*100)/speed;//(double)DR/(double)speed;
@@ -195,238 +291,90 @@ static portTASK_FUNCTION( vMapUpdateTask, pvParameters )
 			else
 			{
 				time[1] += (rightD*100)/speed;//(double)DR/(double)speed;
-			}
-		
-			if(FIRST != 1)
-			{
-				if(currentState != fsmStateHault)
+				// slow down for the turn coming up
+				if((seg != NULL) && notSent && (currentState != fsmStateHault) && (DL + DR >= seg->brakeAt))
 				{
-					//printf("ns: %d\n",map[curCount+1][0]);
-					//if you need to slow before a turn
-					if((map[curCount + 1][0] == fsmStateTurnLeft) || (map[curCount + 1][0] == fsmStateTurnRight))
-					{
-						//if within the distance to slow before a turn and you have not already sent a command to turn
-						if(((map[curCount][1] - (DL + DR + 0.5)/2) <= CHANGETOTURN) &&  notSent == 1)
-						{
-							//slow turn
-							if(map[curCount + 1][2] > MINWIDEDIST)
-							{
-								i2cCmdSpeed[2] = MAXWIDETURN;
-								speed = MAXWIDETURN;
-								if (vtI2CConQ(devPtr,UpdateSpeed,0x4F,sizeof(i2cCmdSpeed),i2cCmdSpeed,sizeof(i2cCmdSpeed)) != pdTRUE) {
-									VT_HANDLE_FATAL_ERROR(0);
-								}
-							}
-							//sharp turn
-							else
-							{
-								i2cCmdSpeed[2] = MAXSHARPTURN;
-								speed = MAXSHARPTURN;
-								if (vtI2CConQ(devPtr,UpdateSpeed,0x4F,sizeof(i2cCmdSpeed),i2cCmdSpeed,sizeof(i2cCmdSpeed)) != pdTRUE) {
-									VT_HANDLE_FATAL_ERROR(0);
-								}
-							}
-							notSent = 0;
-						}
-					}	
+					speed = seg->brakeSpeed;
+					mapSendSpeed(speed);
+					notSent = 0;
 				}
 			}
 			break;
 		}
-		case MapStraight: {
-			int raid = getRightDistance(&msgBuffer);
-			notSent = 1;
-			//saves the state
-			if(FIRST == 1)
-			{
-				map[stateCount][0] = currentState;
-				
-				//stores the inside tread distance
-				if(currentState == fsmStateStraight)
-				{
-					//gets the average of the distance travled
-					map[stateCount][1] = (DL + DR + 0.5)/2;	
-				}
-				else if(currentState == fsmStateTurnLeft)
-				{
-					//saves inside track distance
-					map[stateCount][1] = DL;	
-				}
-				else if(currentState == fsmStateTurnRight)
-				{
-					//saves inside track distance
-					map[stateCount][1] = DR;
-				}
-				else if(currentState == fsmStateHault)
-				{
-					map[stateCount][1] = 0;
-				}
-				//radius of 255 = straight
-				map[stateCount][2] = curRaid;
-				stateCount++;
-				//printf("s:%d c:%d\n",currentState,stateCount);
-			}
-
-			//sets the current state to straight
-			currentState = fsmStateStraight;
-			curRaid = raid;
-			DR = 0;
-			DL = 0;
-			curCount++;
-			if((FIRST != 1) && (map[curCount][1] > MINSTRAIGHT)){
-				i2cCmdSpeed[2] = MAXSTRAIGHT;
-				speed = MAXSTRAIGHT;
-				if (vtI2CConQ(devPtr,UpdateSpeed,0x4F,sizeof(i2cCmdSpeed),i2cCmdSpeed,sizeof(i2cCmdSpeed)) != pdTRUE) {
-					VT_HANDLE_FATAL_ERROR(0);
-				}
+		case vtI2CMsgTypeMotorSend: {
+			// a motor command has gone over the bus (speed, radius) -- a refused one never reached the motors
+			if (getStatus(&msgBuffer) == SUCCESS) {
+				motorRadius = getRightDistance(&msgBuffer);
 			}
 			break;
 		}
-		case MapTurnLeft: {
-			int raid = getRightDistance(&msgBuffer);
-
-			notSent = 1;
-			//saves the state
-			if(FIRST == 1)
-			{
-				map[stateCount][0] = currentState;
-				
-				//stores the inside tread distance
-				if(currentState == fsmStateStraight)
-				{
-					//gets the average of the distance travled
-					map[stateCount][1] = (DL + DR + 0.5)/2;	
-				}
-				else if(currentState == fsmStateTurnLeft)
-				{
-					//saves inside track distance
-					map[stateCount][1] = DL;	
-				}
-				else if(currentState == fsmStateTurnRight)
-				{
-					//saves inside track distance
-					map[stateCount][1] = DR;
-				}
-				else if(currentState == fsmStateHault)
-				{
-					map[stateCount][1] = 0;
-				}
-	
-				//sets radius
-				map[stateCount][2] = curRaid;
-				stateCount++;
-			}
-
-			//sets the current state to left
-			currentState = fsmStateTurnLeft;
-			curRaid = raid;
-			DR = 0;
-			DL = 0;
-			curCount++;
+		case DistanceMsg: {
+			// left and right IR distances (cm)
+			vtMapGridRange(vtMapGridIRLeft,getLeftDistance(&msgBuffer));
+			vtMapGridRange(vtMapGridIRRight,getRightDistance(&msgBuffer));
+			break;
+		}
+		case FrontValMsg: {
+			vtMapGridRange(vtMapGridIRFront,getRightDistance(&msgBuffer));
 			break;
 		}
-		case MapTurnRight: {
-			notSent = 1;
+		case MapStraight:
+		case MapTurnLeft:
+		case MapTurnRight:
+		case MapHault: {
 			int raid = getRightDistance(&msgBuffer);
-			//saves the state
+
+			//saves the state that has just ended
 			if(FIRST == 1)
 			{
-				map[stateCount][0] = currentState;
-				
-				//stores the inside tread distance
-				if(currentState == fsmStateStraight)
-				{
-					//gets the average of the distance travled
-					map[stateCount][1] = (DL + DR + 0.5)/2;	
-				}
-				else if(currentState == fsmStateTurnLeft)
-				{
-					//saves inside track distance
-					map[stateCount][1] = DL;	
-				}
-				else if(currentState == fsmStateTurnRight)
-				{
-					//saves inside track distance
-					map[stateCount][1] = DR;
-				}
-				else if(currentState == fsmStateHault)
-				{
-					map[stateCount][1] = 0;
-				}
-	
-				//sets radius
-				map[stateCount][2] = curRaid;
-				stateCount++;
+				mapRecord(currentState,curRaid,DL,DR);
 			}
 
-			//sets the current state to straight
-			currentState = fsmStateTurnRight;
+			//sets the new state
+			switch(getMsgType(&msgBuffer)) {
+			case MapStraight: currentState = fsmStateStraight; break;
+			case MapTurnLeft: currentState = fsmStateTurnLeft; break;
+			case MapTurnRight: currentState = fsmStateTurnRight; break;
+			default: currentState = fsmStateHault; break;
+			}
 			curRaid = raid;
 			DR = 0;
 			DL = 0;
 			curCount++;
-			break;
-		}
-		case MapHault: {
-			notSent = 1;
-			int raid = getRightDistance(&msgBuffer);
 
-			//saves the state
 			if(FIRST == 1)
 			{
-				map[stateCount][0] = currentState;
-				
-				//stores the inside tread distance
-				if(currentState == fsmStateStraight)
-				{
-					//gets the average of the distance travled
-					map[stateCount][1] = (DL + DR + 0.5)/2;	
-				}
-				else if(currentState == fsmStateTurnLeft)
+				//stores hault
+				if(currentState == fsmStateHault)
 				{
-					//saves inside track distance
-					map[stateCount][1] = DL;	
+					mapRecord(currentState,curRaid,0,0);
 				}
-				else if(currentState == fsmStateTurnRight)
+			}
+			else
+			{
+				// on to the next segment of the plan
+				seg = (curCount < numSegments) ? &segments[curCount] : NULL;
+				notSent = 1;
+				if((seg != NULL) && (seg->entrySpeed != 0))
 				{
-					//saves inside track distance
-					map[stateCount][1] = DR;
+					speed = seg->entrySpeed;
+					mapSendSpeed(speed);
 				}
-				else if(currentState == fsmStateHault)
+				// a segment too short to reach its braking point at all
+				if((seg != NULL) && (seg->brakeAt == 0) && (currentState != fsmStateHault))
 				{
-					map[stateCount][1] = 0;
+					speed = seg->brakeSpeed;
+					mapSendSpeed(speed);
+					notSent = 0;
 				}
-	
-				//sets radius
-				map[stateCount][2] = curRaid;
-				stateCount++;
-			}
-
-			//sets the current state to hault
-			currentState = fsmStateHault;
-			curRaid = raid;
-			DR = 0;
-			DL = 0;
-			curCount++;
-
-			//stores hault
-			if(FIRST == 1)
-			{
-				map[stateCount][0] = currentState;
-				
-				map[stateCount][1] = 0;
-	
-				//sets radius
-				map[stateCount][2] = curRaid;
-				stateCount++;
 			}
 			break;
 		}
 		case PrintMap: {
 			/*int i = 0;
-			for(i=0;i<stateCount;i++)
+			for(i=0;i<numSegments;i++)
 			{
-				sprintf(lcdBuffer,"%d,%d,%d",map[i][0],map[i][1],map[i][2]);
+				sprintf(lcdBuffer,"%d,%d,%d",segments[i].state,segments[i].length,segments[i].radius);
 				if (lcdData != NULL) {
 					if (SendLCDPrintMsg(lcdData,strnlen(lcdBuffer,vtLCDMaxLen),lcdBuffer,i+1,portMAX_DELAY) != pdTRUE) {
 						VT_HANDLE_FATAL_ERROR(0);
@@ -450,6 +398,13 @@ static portTASK_FUNCTION( vMapUpdateTask, pvParameters )
 		case UpdateRunMap: {
 			FIRST = getRightDistance(&msgBuffer);
 			curCount = 0;
+			// end of the first run: turn what was recorded into the speed plan for the second
+			if(FIRST != 1)
+			{
+				mapCompilePlan();
+				seg = (numSegments > 0) ? &segments[0] : NULL;
+				notSent = 1;
+			}
 			break;
 		}
 		default: {
@@ -462,4 +417,3 @@ static portTASK_FUNCTION( vMapUpdateTask, pvParameters )
 
 	}
 }
-
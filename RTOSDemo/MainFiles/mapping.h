@@ -35,6 +35,9 @@ void vStartMapTask(vtMapStruct *mapData,unsigned portBASE_TYPE uxPriority, vtI2C
 // Return:
 //   Result of the call to xQueueSend()
 portBASE_TYPE SendMapMsg(vtMapStruct *mapData,uint8_t msgType,uint8_t value,uint8_t rightDistance,uint8_t leftDistance,portTickType ticksToBlock);
+//
+// Same as SendMapMsg(), for a sample from the I2C bus -- status is the I2C status of the transfer (SUCCESS or ERROR)
+portBASE_TYPE SendMapSample(vtMapStruct *mapData,uint8_t msgType,uint8_t value,uint8_t rightDistance,uint8_t leftDistance,uint8_t status,portTickType ticksToBlock);
 
 //prints the map
 void printMap();
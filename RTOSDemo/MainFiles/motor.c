@@ -0,0 +1,287 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "projdefs.h"
+#include "semphr.h"
+
+/* include files. */
+#include "vtUtilities.h"
+#include "vtI2C.h"
+#include "lcdTask.h"
+#include "testing.h"
+#include "I2CTaskMsgTypes.h"
+#include "motor.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+// Length of the queue to this task
+#define vtMotorQLen 20
+
+// actual data structure that is sent in a message
+typedef struct __vtMotorMsg {
+	uint8_t msgType;
+	uint8_t count;
+	uint8_t value1;
+	uint8_t value2;
+	uint8_t status;		// I2C status of an echo
+} vtMotorMsg;
+
+// Uses sprintf() for the LCD, see navigation.c
+#define baseStack 3
+#if PRINTF_VERSION == 1
+#define motorSTACK_SIZE		((baseStack+5)*configMINIMAL_STACK_SIZE)
+#else
+#define motorSTACK_SIZE		(baseStack*configMINIMAL_STACK_SIZE)
+#endif
+
+// The motor PIC and its command
+#define motorSlvAddr 0x4D
+#define motorCmd 0x34
+#define motorCmdLen 4
+// How long after a command goes out before it is sent again if the motor PIC has not taken it
+#define motorWRITE_TIMEOUT ((portTickType) 100 / portTICK_RATE_MS)
+// LCD line used to show the last command sent
+#define motorLCDLine 8
+
+// A command as it is built up from the requests
+typedef struct __motorCommand {
+	uint8_t speed;
+	uint8_t radius;
+	uint8_t halt;			// a halt, which nothing but another halt may replace before it is sent
+	portTickType since;		// when the first request it stands for arrived
+} motorCommand;
+// Memory for the task and its queue
+static portSTACK_TYPE motorStack[motorSTACK_SIZE];
+static xStaticTask motorTCB;
+static xStaticQueue motorQueue;
+static uint8_t motorQueueStorage[vtMotorQLen*sizeof(vtMotorMsg)];
+// end of defs
+/* *********************************************** */
+
+/* The motor task. */
+static portTASK_FUNCTION_PROTO( vMotorUpdateTask, pvParameters );
+
+/*-----------------------------------------------------------*/
+// Public API
+void vStartMotorTask(vtMotorStruct *params,unsigned portBASE_TYPE uxPriority,vtI2CStruct *i2c,vtLCDStruct *lcd,vtTestStruct *test)
+{
+	// Create the queue that will be used to talk to this task
+	if ((params->inQ = xQueueCreateStatic(vtMotorQLen,sizeof(vtMotorMsg),motorQueueStorage,&motorQueue)) == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	/* Start the task */
+	portBASE_TYPE retval;
+	params->dev = i2c;
+	params->lcdData = lcd;
+	params->testData = test;
+	memset(&(params->stats),0,sizeof(vtMotorStats));
+	if ((retval = xTaskCreateStatic( vMotorUpdateTask, ( signed char * ) "Motor", motorSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL, motorStack, &motorTCB )) != pdPASS) {
+		VT_HANDLE_FATAL_ERROR(retval);
+	}
+}
+
+static portBASE_TYPE SendMotorMsg(vtMotorStruct *motorData,uint8_t msgType,uint8_t count,uint8_t value1,uint8_t value2,uint8_t status,portTickType ticksToBlock)
+{
+	vtMotorMsg motorBuffer;
+
+	if (motorData == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	motorBuffer.msgType = msgType;
+	motorBuffer.count = count;
+	motorBuffer.value1 = value1;
+	motorBuffer.value2 = value2;
+	motorBuffer.status = status;
+	return(xQueueSend(motorData->inQ,(void *) (&motorBuffer),ticksToBlock));
+}
+
+portBASE_TYPE SendMotorDrive(vtMotorStruct *motorData,uint8_t speed,uint8_t radius,portTickType ticksToBlock)
+{
+	return(SendMotorMsg(motorData,MotorMsgTypeDrive,0,speed,radius,SUCCESS,ticksToBlock));
+}
+
+portBASE_TYPE SendMotorPivot(vtMotorStruct *motorData,uint8_t speed,int right,portTickType ticksToBlock)
+{
+	// radius 0 (either way) spins in place
+	return(SendMotorMsg(motorData,MotorMsgTypeDrive,0,speed,right ? vtMotorRadiusRight : 0,SUCCESS,ticksToBlock));
+}
+
+portBASE_TYPE SendMotorHalt(vtMotorStruct *motorData,portTickType ticksToBlock)
+{
+	return(SendMotorMsg(motorData,MotorMsgTypeHalt,0,0,vtMotorRadiusStraight,SUCCESS,ticksToBlock));
+}
+
+portBASE_TYPE SendMotorSpeed(vtMotorStruct *motorData,uint8_t speed,portTickType ticksToBlock)
+{
+	return(SendMotorMsg(motorData,MotorMsgTypeSpeed,0,speed,0,SUCCESS,ticksToBlock));
+}
+
+portBASE_TYPE SendMotorWritten(vtMotorStruct *motorData,uint8_t count,uint8_t status,portTickType ticksToBlock)
+{
+	return(SendMotorMsg(motorData,vtI2CMsgTypeMotorSend,count,0,0,status,ticksToBlock));
+}
+
+void vtMotorGetStats(vtMotorStruct *motorData,vtMotorStats *stats)
+{
+	portENTER_CRITICAL();
+	*stats = motorData->stats;
+	portEXIT_CRITICAL();
+}
+// End of Public API
+/*-----------------------------------------------------------*/
+
+// Put a command on the bus
+static void motorSend(vtMotorStruct *param,const motorCommand *cmd,uint8_t count)
+{
+	uint8_t i2cCmd[motorCmdLen];
+	char lcdBuffer[vtLCDMaxLen+1];
+
+	i2cCmd[0] = motorCmd;
+	i2cCmd[1] = count;
+	i2cCmd[2] = cmd->speed;
+	i2cCmd[3] = cmd->radius;
+	#if TESTING == 0
+	// Urgent, so it only waits for the transfer already on the bus
+	if (vtI2CEnQPrio(param->dev,vtI2CPrioUrgent,vtI2CNoDeadline,vtI2CMsgTypeMotorSend,motorSlvAddr,sizeof(i2cCmd),i2cCmd,0) != pdTRUE) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	#else
+	if (vtTestEnQ(param->testData,vtI2CMsgTypeMotorSend,motorSlvAddr,sizeof(i2cCmd),i2cCmd,0) != pdTRUE) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	#endif
+	param->stats.sent++;
+	if (cmd->halt) {
+		sprintf(lcdBuffer,"Hault");
+	} else {
+		sprintf(lcdBuffer,"S: %d,%d,%d,%d",i2cCmd[0],i2cCmd[1],i2cCmd[2],i2cCmd[3]);
+	}
+	if (param->lcdData != NULL) {
+		if (SendLCDPrintMsg(param->lcdData,strnlen(lcdBuffer,vtLCDMaxLen),lcdBuffer,motorLCDLine,portMAX_DELAY) != pdTRUE) {
+			VT_HANDLE_FATAL_ERROR(0);
+		}
+	}
+}
+
+// This is the actual task that is run
+static portTASK_FUNCTION( vMotorUpdateTask, pvParameters )
+{
+	// Get the parameters
+	vtMotorStruct *param = (vtMotorStruct *) pvParameters;
+	// Buffer for receiving messages
+	vtMotorMsg msgBuffer;
+
+	// What the motors were last told to do (they start stopped) and what they are to be told next
+	motorCommand current = { 0, vtMotorRadiusStraight, 1, 0 };
+	motorCommand pending;
+	int havePending = 0;
+	// The command on the bus, if any
+	motorCommand onBus = { 0, vtMotorRadiusStraight, 1, 0 };
+	int inFlight = 0;
+	portTickType sentAt = 0;
+	uint8_t count = 0;
+	portTickType wait, now;
+
+	for(;;)
+	{
+		// Only wake up without a message to resend a command that failed or whose echo has not come back
+		wait = portMAX_DELAY;
+		if (inFlight) {
+			now = xTaskGetTickCount();
+			wait = ((now - sentAt) < motorWRITE_TIMEOUT) ? motorWRITE_TIMEOUT - (now - sentAt) : 0;
+		}
+		if (xQueueReceive(param->inQ,(void *) &msgBuffer,wait) != pdTRUE) {
+			// Lost or refused -- send it again, unless something newer is already waiting
+			param->stats.resent++;
+			inFlight = 0;
+			if (!havePending) {
+				pending = onBus;
+				havePending = 1;
+			}
+		} else {
+			switch(msgBuffer.msgType) {
+			case MotorMsgTypeDrive:
+			case MotorMsgTypeHalt:
+			case MotorMsgTypeSpeed: {
+				motorCommand req;
+
+				param->stats.requests++;
+				// Start from the latest thing asked for
+				req = havePending ? pending : current;
+				req.since = xTaskGetTickCount();
+				if (msgBuffer.msgType == MotorMsgTypeSpeed) {
+					if (req.halt) {
+						break;
+					}
+					req.speed = msgBuffer.value1;
+				} else {
+					req.speed = msgBuffer.value1;
+					req.radius = msgBuffer.value2;
+					req.halt = (msgBuffer.msgType == MotorMsgTypeHalt);
+				}
+				if (havePending) {
+					if (pending.halt && !req.halt) {
+						// a halt that has not gone out yet wins
+						param->stats.replaced++;
+						break;
+					}
+					if ((pending.speed == req.speed) && (pending.radius == req.radius) && (pending.halt == req.halt)) {
+						param->stats.repeats++;
+						break;
+					}
+					param->stats.replaced++;
+					req.since = pending.since;
+				}
+				if ((current.speed == req.speed) && (current.radius == req.radius) && (current.halt == req.halt)) {
+					// back to what the motors are doing (or about to do) already
+					param->stats.repeats++;
+					havePending = 0;
+					break;
+				}
+				pending = req;
+				havePending = 1;
+				break;
+			}
+			case vtI2CMsgTypeMotorSend: {
+				// the echo of a command that has gone over the bus
+				if (inFlight && (msgBuffer.count == (uint8_t) (count-1))) {
+					if (msgBuffer.status != SUCCESS) {
+						// the motor PIC did not take it -- leave it in flight so that the timeout above sends it
+						//   again, which also keeps a PIC that has gone away from tying up the bus
+						param->stats.failed++;
+						break;
+					}
+					inFlight = 0;
+					param->stats.written++;
+					now = xTaskGetTickCount();
+					if ((now - onBus.since) > param->stats.maxLatency) {
+						param->stats.maxLatency = now - onBus.since;
+					}
+				}
+				break;
+			}
+			default: {
+				VT_HANDLE_FATAL_ERROR(msgBuffer.msgType);
+				break;
+			}
+			}
+		}
+
+		// Nothing goes out while the last command is still on the bus, so there is never more than one waiting
+		if (havePending && !inFlight) {
+			onBus = pending;
+			current = pending;
+			havePending = 0;
+			motorSend(param,&onBus,count);
+			count++;
+			sentAt = xTaskGetTickCount();
+			#if TESTING == 0
+			inFlight = 1;
+			#endif
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#ifndef MOTOR_TASK_H
+#define MOTOR_TASK_H
+#include "vtI2C.h"
+#include "lcdTask.h"
+#include "testing.h"
+
+// The motor task is the only thing that sends commands to the motor PIC.  Other tasks tell it what they
+//   want the rover to do (drive, pivot, halt, change speed) and it decides what goes on the bus:
+//   -- there is at most one command on the bus and one waiting; a new request replaces the waiting one
+//      (the latest wins), except that a halt is never replaced by anything but another halt before it is sent
+//   -- a request for what the motors were last told to do is dropped
+//   -- it fills in the command count byte
+//   -- a command is "written" when the I2C thread hands back its echo (see conductor.c) with the transfer
+//      status SUCCESS.  If the echo says the motor PIC did not take it, or does not come back at all, the command
+//      is sent again once motorWRITE_TIMEOUT (see motor.c) has passed since it went out.
+//
+// A command is {0x34,count,speed,radius} where radius 127 is straight, 0-126 turns left with that radius
+//   (0 spins in place) and 128-255 turns right with radius (byte-128).
+#define vtMotorRadiusStraight 127
+#define vtMotorRadiusRight 128
+
+// Counters kept by the task (see vtMotorGetStats())
+typedef struct __vtMotorStats {
+	unsigned long requests;		// drive/pivot/halt/speed requests received
+	unsigned long sent;			// commands put on the bus
+	unsigned long repeats;		// requests dropped because the motors were already doing that
+	unsigned long replaced;		// requests replaced by a later one before they were sent
+	unsigned long written;		// commands the motor PIC took
+	unsigned long failed;		// commands the motor PIC did not answer (see vtI2CMsg status)
+	unsigned long resent;		// commands sent again because they failed or no echo came back
+	portTickType maxLatency;	// longest time from a request to its command being written (ticks)
+} vtMotorStats;
+
+// Structure used to pass parameters to the task
+// Do not touch...
+typedef struct __MotorStruct {
+	vtI2CStruct *dev;
+	vtLCDStruct *lcdData;
+	vtTestStruct *testData;
+	xQueueHandle inQ;
+	vtMotorStats stats;
+} vtMotorStruct;
+
+// Public API
+//
+// Start the task
+// Args:
+//   motorData: Data structure used by the task
+//   uxPriority -- the priority you want this task to be run at
+//   i2c: pointer to the data structure for the i2c task the motor PIC is on
+//   lcd: pointer to the data structure for an LCD task (may be NULL)
+//   test: pointer to the data structure for the test task (only used when TESTING is set)
+void vStartMotorTask(vtMotorStruct *motorData,unsigned portBASE_TYPE uxPriority,vtI2CStruct *i2c,vtLCDStruct *lcd,vtTestStruct *test);
+//
+// Ask for the rover to drive at a speed and radius
+// Args:
+//   motorData -- a pointer to a variable of type vtMotorStruct
+//   speed -- motor PIC speed
+//   radius -- motor PIC radius byte (see above)
+//   ticksToBlock -- how long the routine should wait if the queue is full
+// Return:
+//   Result of the call to xQueueSend()
+portBASE_TYPE SendMotorDrive(vtMotorStruct *motorData,uint8_t speed,uint8_t radius,portTickType ticksToBlock);
+//
+// Ask for the rover to spin in place
+// Args:
+//   motorData -- a pointer to a variable of type vtMotorStruct
+//   speed -- motor PIC speed
+//   right -- non-zero to spin to the right
+//   ticksToBlock -- how long the routine should wait if the queue is full
+// Return:
+//   Result of the call to xQueueSend()
+portBASE_TYPE SendMotorPivot(vtMotorStruct *motorData,uint8_t speed,int right,portTickType ticksToBlock);
+//
+// Ask for the rover to stop
+// Args:
+//   motorData -- a pointer to a variable of type vtMotorStruct
+//   ticksToBlock -- how long the routine should wait if the queue is full
+// Return:
+//   Result of the call to xQueueSend()
+portBASE_TYPE SendMotorHalt(vtMotorStruct *motorData,portTickType ticksToBlock);
+//
+// Change the speed of whatever the rover is doing (ignored while halted)
+// Args:
+//   motorData -- a pointer to a variable of type vtMotorStruct
+//   speed -- motor PIC speed
+//   ticksToBlock -- how long the routine should wait if the queue is full
+// Return:
+//   Result of the call to xQueueSend()
+portBASE_TYPE SendMotorSpeed(vtMotorStruct *motorData,uint8_t speed,portTickType ticksToBlock);
+//
+// Hand the motor task the echo of one of its commands -- called by the conductor, not by the navigation code
+// Args:
+//   motorData -- a pointer to a variable of type vtMotorStruct
+//   count -- the count byte of the command
+//   status -- the status of the I2C transfer (SUCCESS or ERROR)
+//   ticksToBlock -- how long the routine should wait if the queue is full
+// Return:
+//   Result of the call to xQueueSend()
+portBASE_TYPE SendMotorWritten(vtMotorStruct *motorData,uint8_t count,uint8_t status,portTickType ticksToBlock);
+//
+// Copy out the counters
+void vtMotorGetStats(vtMotorStruct *motorData,vtMotorStats *stats);
+#endif
@@ -6,7 +6,7 @@
 
 /* include files. */
 #include "vtUtilities.h"
-#include "LCDtask.h"
+#include "lcdTask.h"
 #include "myTimers.h"
 #include "navigation.h"
 #include "testing.h"
@@ -24,6 +24,8 @@
 // Set the task up to run every 200 ms
 
 #define nav_RATE_BASE	( ( portTickType ) 50 / portTICK_RATE_MS)
+// The timer is not taken from the heap
+static xStaticTimer navTimer;
 
 // Callback function that is called by the NavTimer
 //   Sends a message to the queue that is read by the Navigation Task
@@ -51,7 +53,7 @@ void startTimerForNav(vtNavStruct *vtNavdata) {
 	if (sizeof(long) != sizeof(vtNavStruct *)) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
-	xTimerHandle NavTimerHandle = xTimerCreate((const signed char *)"Nav Timer",nav_RATE_BASE,pdTRUE,(void *) vtNavdata,NavTimerCallback);
+	xTimerHandle NavTimerHandle = xTimerCreateStatic((const signed char *)"Nav Timer",nav_RATE_BASE,pdTRUE,(void *) vtNavdata,NavTimerCallback,&navTimer);
 	if (NavTimerHandle == NULL) {
 		VT_HANDLE_FATAL_ERROR(0);
 	} else {
@@ -65,6 +67,7 @@ void startTimerForNav(vtNavStruct *vtNavdata) {
 #if TESTING == 1
 
 #define test_RATE_BASE	( ( portTickType ) 30 / portTICK_RATE_MS)
+static xStaticTimer testTimer;
 
 // Callback function that is called by the NavTimer
 //   Sends a message to the queue that is read by the Navigation Task
@@ -92,7 +95,7 @@ void startTimerForTest(vtTestStruct *vtTestdata){
 	if (sizeof(long) != sizeof(vtTestStruct *)) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
-	xTimerHandle TestTimerHandle = xTimerCreate((const signed char *)"Test Timer",test_RATE_BASE,pdTRUE,(void *) vtTestdata,TestTimerCallback);
+	xTimerHandle TestTimerHandle = xTimerCreateStatic((const signed char *)"Test Timer",test_RATE_BASE,pdTRUE,(void *) vtTestdata,TestTimerCallback,&testTimer);
 	if (TestTimerHandle == NULL) {
 		VT_HANDLE_FATAL_ERROR(0);
 	} else {
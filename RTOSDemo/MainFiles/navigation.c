@@ -12,19 +12,24 @@
 /* include files. */
 #include "vtUtilities.h"
 #include "vtI2C.h"
-#include "LCDtask.h"
+#include "lcdTask.h"
 #include "navigation.h"
 #include "mapping.h"
 #include "testing.h"
+#include "motor.h"
 #include "I2CTaskMsgTypes.h"
 
 /* *********************************************** */
 // definitions and data structures that are private to this file
-// Length of the queue to this task
-#define vtNavQLen 20 
+// Length of the queues to this task -- the IR distances have their own queue so that they are taken before
+//   anything else waiting, and the timer ticks have theirs so a burst of sensor data cannot hold up a poll
+#define vtNavQLen 10
+#define vtNavUrgentQLen 20
+#define vtNavTimerQLen 4
+// Every item in the queues has its queue's handle in the set
+#define vtNavSetLen (vtNavQLen+vtNavUrgentQLen+vtNavTimerQLen)
 
 #define SAFEZONE 20
-#define DANGERZONE 10
 #define FRONTSAFEZONE 20
 
 #define PRINTMAP 0
@@ -55,18 +60,61 @@ typedef struct __vtNavMsg {
 #define RIGHT 3
 
 #define SMALLRAID  0
-#define LARGERAID  5
 
-#define TURNSPEED 10
-#define STRAIGHTSPEED 20
 #define PIVOTSPEED 15
+// speed the rover pivots away from a wall in front at
+#define navPIVOT_SPEED 20
 
 #define USEMAPPING 0
 
+// Wall following steering: a proportional/derivative controller on how far the rover is off the middle of the
+//   corridor, in Q15 fixed point (navQ15ONE is 1.0) so that it needs no floating point
+#define navQ15ONE 32768
+// Default gains (Q15), see vNavSetSteeringGains()
+#define navSTEER_KP 32767
+#define navSTEER_KD 16384
+// Most the steering output may change by from one distance sample to the next, so the radius moves through
+//   the steps in between rather than switching straight from one extreme to the other
+#define navSTEER_SLEW 8192
+// Steering outputs smaller than this drive straight
+#define navSTEER_DEADBAND 2048
+// The rest of the output range is split into this many turn radii, from navSTEER_MAX_RADIUS (gentlest) down to
+//   navSTEER_MIN_RADIUS (full steering) in motor PIC units -- 0 is a spin
+#define navSTEER_LEVELS 4
+#define navSTEER_MIN_RADIUS SMALLRAID
+#define navSTEER_MAX_RADIUS 15
+// How far (Q15) the output has to go past the edge of a radius step before the radius changes, so that sensor
+//   noise around an edge does not send a new motor command every sample
+#define navSTEER_HYSTERESIS 2048
+// Once pivoting away from a wall in front, keep pivoting until it is this much (cm) further away than FRONTSAFEZONE
+#define navFRONT_HYSTERESIS 5
+// Motor PIC radius byte: 127 is straight, 0-126 turn left with that radius, 128-255 turn right with radius (byte-128)
+#define navSTRAIGHT 127
+#define navRIGHT 128
+
+typedef struct __navSteerState {
+	int32_t lastError;	// error at the previous sample (Q15)
+	int32_t output;		// steering output after slew limiting (Q15, positive is left)
+	int32_t level;		// radius step in use (0 is straight, 1 to navSTEER_LEVELS are the turns, negative for right)
+} navSteerState;
+
+// Each timer poll reads every sample the sensor PIC has (3 IR channels, motor encoder and accelerometer)
+//   in one batch, so the I2C task only has to wake up once per poll
+#define SAMPLESPERPOLL 5
+// A poll that has not reached the bus by the time the next one is due is stale, so it is dropped
+#define POLLDEADLINE ((portTickType) 50 / portTICK_RATE_MS)
+
 uint8_t RUN = 1;
 uint8_t START = 0;
-uint8_t SENDCMD = 0;
 
+// Memory for the task, its queues and the set of them
+static portSTACK_TYPE navStack[i2cSTACK_SIZE];
+static xStaticTask navTCB;
+static xStaticQueue navQueue, navUrgentQueue, navTimerQueue, navSet;
+static uint8_t navQueueStorage[vtNavQLen*sizeof(vtNavMsg)];
+static uint8_t navUrgentQueueStorage[vtNavUrgentQLen*sizeof(vtNavMsg)];
+static uint8_t navTimerQueueStorage[vtNavTimerQLen*sizeof(vtNavMsg)];
+static xQueueSetMemberHandle navSetStorage[vtNavSetLen];
 // end of defs
 /* *********************************************** */
 
@@ -75,10 +123,23 @@ static portTASK_FUNCTION_PROTO( vNavUpdateTask, pvParameters );
 
 /*-----------------------------------------------------------*/
 // Public API
-void vStartNavTask(vtNavStruct *params,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtLCDStruct *lcd, vtMapStruct *map, vtTestStruct *test)
+void vStartNavTask(vtNavStruct *params,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtLCDStruct *lcd, vtMapStruct *map, vtTestStruct *test, vtMotorStruct *motor)
 {
-	// Create the queue that will be used to talk to this task
-	if ((params->inQ = xQueueCreate(vtNavQLen,sizeof(vtNavMsg))) == NULL) {
+	// Create the queues that will be used to talk to this task, and the set it waits on
+	if ((params->inQ = xQueueCreateStatic(vtNavQLen,sizeof(vtNavMsg),navQueueStorage,&navQueue)) == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	if ((params->urgentQ = xQueueCreateStatic(vtNavUrgentQLen,sizeof(vtNavMsg),navUrgentQueueStorage,&navUrgentQueue)) == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	if ((params->timerQ = xQueueCreateStatic(vtNavTimerQLen,sizeof(vtNavMsg),navTimerQueueStorage,&navTimerQueue)) == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	if ((params->inSet = xQueueCreateSetStatic(vtNavSetLen,(uint8_t *) navSetStorage,&navSet)) == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	if ((xQueueAddToSet(params->inQ,params->inSet) != pdPASS) || (xQueueAddToSet(params->urgentQ,params->inSet) != pdPASS) ||
+		(xQueueAddToSet(params->timerQ,params->inSet) != pdPASS)) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
 	/* Start the task */
@@ -87,11 +148,42 @@ void vStartNavTask(vtNavStruct *params,unsigned portBASE_TYPE uxPriority, vtI2CS
 	params->lcdData = lcd;
 	params->mapData = map;
 	params->testData = test;
-	if ((retval = xTaskCreate( vNavUpdateTask, ( signed char * ) "Navigation", i2cSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL )) != pdPASS) {
+	params->motorData = motor;
+	vNavGetDefaultParams(&(params->tuning));
+	if ((retval = xTaskCreateStatic( vNavUpdateTask, ( signed char * ) "Navigation", i2cSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL, navStack, &navTCB )) != pdPASS) {
 		VT_HANDLE_FATAL_ERROR(retval);
 	}
 }
 
+void vNavSetSteeringGains(vtNavStruct *navData,int32_t kp,int32_t kd)
+{
+	if ((navData == NULL) || (kp < 0) || (kp >= navQ15ONE) || (kd < 0) || (kd >= navQ15ONE)) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	navData->tuning.steerKp = kp;
+	navData->tuning.steerKd = kd;
+}
+
+void vNavGetDefaultParams(vtNavParams *tuning)
+{
+	tuning->safeZone = SAFEZONE;
+	tuning->frontSafeZone = FRONTSAFEZONE;
+	tuning->frontHysteresis = navFRONT_HYSTERESIS;
+	tuning->driveSpeed = PIVOTSPEED;
+	tuning->pivotSpeed = navPIVOT_SPEED;
+	tuning->steerKp = navSTEER_KP;
+	tuning->steerKd = navSTEER_KD;
+}
+
+void vNavSetParams(vtNavStruct *navData,const vtNavParams *tuning)
+{
+	if ((navData == NULL) || (tuning == NULL)) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	vNavSetSteeringGains(navData,tuning->steerKp,tuning->steerKd);
+	navData->tuning = *tuning;
+}
+
 portBASE_TYPE SendNavTimerMsg(vtNavStruct *navData,portTickType ticksElapsed,portTickType ticksToBlock)
 {
 	if (navData == NULL) {
@@ -99,7 +191,7 @@ portBASE_TYPE SendNavTimerMsg(vtNavStruct *navData,portTickType ticksElapsed,por
 	}
 	vtNavMsg navBuffer;
 	navBuffer.msgType = NavMsgTypeTimer;
-	return(xQueueSend(navData->inQ,(void *) (&navBuffer),ticksToBlock));
+	return(xQueueSend(navData->timerQ,(void *) (&navBuffer),ticksToBlock));
 }
 
 
@@ -114,6 +206,9 @@ portBASE_TYPE SendNavMsg(vtNavStruct *navData,uint8_t msgType,uint8_t count,uint
 	navBuffer.count = count;
 	navBuffer.value1 = val1;
 	navBuffer.value2 = val2;
+	if ((msgType == DistanceMsg) || (msgType == FrontValMsg)) {
+		return(xQueueSend(navData->urgentQ,(void *) (&navBuffer),ticksToBlock));
+	}
 	return(xQueueSend(navData->inQ,(void *) (&navBuffer),ticksToBlock));
 }
 
@@ -124,7 +219,7 @@ portBASE_TYPE SendSensorTimerMsg(vtNavStruct *navData,portTickType ticksElapsed,
 	}
 	vtNavMsg navBuffer;
 	navBuffer.msgType = SensorMsgTypeTimer;
-	return(xQueueSend(navData->inQ,(void *) (&navBuffer),ticksToBlock));
+	return(xQueueSend(navData->timerQ,(void *) (&navBuffer),ticksToBlock));
 }
 
 void start()
@@ -161,6 +256,25 @@ uint8_t getVal2(vtNavMsg *Buffer)
 	return(rd);
 }
 
+// Wait for the next message on any of the task's queues
+//   The set says which queue the oldest message went to, but an IR distance waiting in urgentQ is taken first.
+//   The set holds one handle per message, so when the queue it names has been emptied early like that, some
+//   other queue still has the message that handle stands for -- every queue is tried so it is not left behind.
+static void navNextMsg(vtNavStruct *param,vtNavMsg *msgBuffer)
+{
+	xQueueSetMemberHandle member;
+
+	if ((member = xQueueSelectFromSet(param->inSet,portMAX_DELAY)) == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	if ((xQueueReceive(param->urgentQ,(void *) msgBuffer,0) != pdTRUE) &&
+		(xQueueReceive(member,(void *) msgBuffer,0) != pdTRUE) &&
+		(xQueueReceive(param->timerQ,(void *) msgBuffer,0) != pdTRUE) &&
+		(xQueueReceive(param->inQ,(void *) msgBuffer,0) != pdTRUE)) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+}
+
 /* I2C commands for the temperature sensor
 	const uint8_t i2cCmdInit[]= {0xAC,0x00};
 	const uint8_t i2cCmdStartConvert[]= {0xEE};
@@ -172,22 +286,77 @@ uint8_t getVal2(vtNavMsg *Buffer)
 
 // I2C commands for the Motor Encoder
 	uint8_t i2cCmdReadVals[]= {0xCC};
-	uint8_t i2cCmdStraight[]= {0x34,0x00,0x0F,0x00};
-	uint8_t i2cCmdTurn[]= {0x34,0x00,0x0F,0x00};
-	uint8_t i2cCmdHault[] = {0x34,0x00,0x00,0x127};
+	vtI2CBatchOp i2cReadBatch[SAMPLESPERPOLL];
+// Motor commands are sent by the motor task (see motor.h)
 // end of I2C command definitions
 
+// The radius step for a steering output (Q15): 0 inside the dead band, otherwise 1 to navSTEER_LEVELS
+//   (negative for right turns)
+static int32_t navSteerLevel(int32_t output)
+{
+	int32_t mag = (output < 0) ? -output : output;
+	int32_t level;
+
+	if (mag < navSTEER_DEADBAND) {
+		return(0);
+	}
+	level = 1 + ((mag - navSTEER_DEADBAND) * navSTEER_LEVELS) / (navQ15ONE - navSTEER_DEADBAND);
+	if (level > navSTEER_LEVELS) level = navSTEER_LEVELS;
+	return((output < 0) ? -level : level);
+}
+
+// Work out the radius byte to send from the distances to the left and right walls
+//   The error is the normalized difference (left-right)/(left+right): positive when the rover is nearer the
+//   right wall, so positive outputs turn left.  Steering only happens near a wall (inside safeZone).
+static uint8_t navSteer(vtNavStruct *param,navSteerState *state,int left,int right)
+{
+	int32_t error, target, step, level, mag, radius;
+
+	if (((left < param->tuning.safeZone) || (right < param->tuning.safeZone)) && (left+right > 0)) {
+		error = ((left - right) * navQ15ONE) / (left + right);
+	} else {
+		// nowhere near a wall -- head straight and start the derivative afresh
+		error = 0;
+		state->lastError = 0;
+	}
+	target = ((param->tuning.steerKp * error) >> 15) + ((param->tuning.steerKd * (error - state->lastError)) >> 15);
+	state->lastError = error;
+	if (target >= navQ15ONE) target = navQ15ONE-1;
+	if (target <= -navQ15ONE) target = -(navQ15ONE-1);
+
+	// limit how fast the output can move
+	step = target - state->output;
+	if (step > navSTEER_SLEW) step = navSTEER_SLEW;
+	if (step < -navSTEER_SLEW) step = -navSTEER_SLEW;
+	state->output += step;
+
+	// quantize: the larger the output, the tighter the turn -- the step only changes once the output is
+	//   navSTEER_HYSTERESIS past its edge
+	level = navSteerLevel(state->output);
+	if (level > state->level) {
+		level = navSteerLevel(state->output - navSTEER_HYSTERESIS);
+		if (level < state->level) level = state->level;
+	} else if (level < state->level) {
+		level = navSteerLevel(state->output + navSTEER_HYSTERESIS);
+		if (level > state->level) level = state->level;
+	}
+	state->level = level;
+	if (level == 0) {
+		return(navSTRAIGHT);
+	}
+	mag = (level < 0) ? -level : level;
+	radius = navSTEER_MAX_RADIUS - ((mag - 1) * (navSTEER_MAX_RADIUS - navSTEER_MIN_RADIUS)) / (navSTEER_LEVELS - 1);
+	return((level > 0) ? radius : navRIGHT + radius);
+}
+
 // This is the actual task that is run
 static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 {
 	// Define local constants here
 	uint8_t countStartAcc = 0;
-	uint8_t countStartMotor = 0;
 	uint8_t countStartDistance = 0;
 	uint8_t countStartFront = 0;
 	uint8_t countAcc = 0;
-	uint8_t countMotor = 0;
-	uint8_t countMotorCommand = 0;
 	uint8_t countDistance = 0;
 	uint8_t countFront = 0;
 
@@ -197,10 +366,12 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 	vtI2CStruct *devPtr = param->dev;
 	// Get the LCD information pointer
 	vtLCDStruct *lcdData = param->lcdData;
+	#if(USEMAPPING == 1)
 	// Get the Map information pointer
 	vtMapStruct *mapData = param->mapData;
-	// Get the Test information pointer
-	vtTestStruct *testData = param->testData;
+	#endif
+	// Get the Motor information pointer
+	vtMotorStruct *motorData = param->motorData;
 
 	// String buffer for printing
 	char lcdBuffer[vtLCDMaxLen+1];
@@ -208,12 +379,21 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 	// Buffer for receiving messages
 	vtNavMsg msgBuffer;
 
+	// Set up the batch of sensor reads sent on each timer poll
+	int i;
+	for (i=0;i<SAMPLESPERPOLL;i++) {
+		i2cReadBatch[i].slvAddr = 0x4f;
+		i2cReadBatch[i].txLen = sizeof(i2cCmdReadVals);
+		i2cReadBatch[i].txBuf = i2cCmdReadVals;
+		i2cReadBatch[i].rxLen = 4;
+	}
+
+	#if(USEMAPPING == 1)
 	//used to know when to tell the map we changed state
 	uint8_t curState = HAULT;
 	uint8_t curRaid = 0;
+	#endif
 	int c=0;
-	int c1=0;
-	int c2=0;
 
 	//0 = left
 	//1 = right
@@ -223,7 +403,11 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 	//1 = in pivot
 	int inPivot = 0;
 
-	float distanceF = 0.0;
+	// wall following steering state
+	navSteerState steer = { 0, 0, 0 };
+	uint8_t radius;
+	// speed for driving along the corridor (pivots are at their own speed)
+	uint8_t driveSpeed = param->tuning.driveSpeed;
 
 	// Assumes that the I2C device (and thread) have already been initialized
 
@@ -234,9 +418,7 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 	for(;;)
 	{
 		// Wait for a message from either a timer or from an I2C operation
-		if (xQueueReceive(param->inQ,(void *) &msgBuffer,portMAX_DELAY) != pdTRUE) {
-			VT_HANDLE_FATAL_ERROR(0);
-		}
+		navNextMsg(param,&msgBuffer);
 
 		// Now, based on the type of the message and the state, we decide on the new state and action to take
 		switch(getMsgType(&msgBuffer)) {
@@ -272,145 +454,32 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 			}*/
 			
 
-			if((val1 < SAFEZONE) || (val2 < SAFEZONE))
+			// val1 is the distance to the left wall and val2 to the right one
+			radius = navSteer(param,&steer,val1,val2);
+			if(radius != navSTRAIGHT)
+				lastTurn = (radius > navSTRAIGHT) ? 1 : 0;
+			#if(USEMAPPING == 1)
+			// tell the map whenever we change the way we are going
+			if(radius == navSTRAIGHT)
 			{
-				distanceF = (float)(val1-val2)/(float)(val1+val2);
-				//set response
-				//127 for straight
-				//10 for small left (15-100) cm
-				//11 for hard left (<15) cm
-				//20 for small right (15-100) cm
-				//21 for hard right (<15) cm
-				// 0 = spin left
-				// 128 = spin right
-				// anything between 0 and 126 = turn left with a turn radius of (val2)
-				// anything between 128 and 255 = turn right with a turn radius of (val2 + 128)
-	
-				if((val1 < DANGERZONE) || (val2 < DANGERZONE))
-				{
-					//hard Left (SMALLRAID)
-					if(distanceF > 0)
-					{
-						i2cCmdTurn[2] = TURNSPEED;
-						if(i2cCmdTurn[3] != SMALLRAID)
-							SENDCMD = 1;
-						i2cCmdTurn[3] = SMALLRAID;
-						//SMALLRAID is radius
-						#if(USEMAPPING == 1)
-						if((curState != LEFT) || (curRaid != SMALLRAID))
-						{
-							if (SendMapMsg(mapData,MapTurnLeft,0,0,SMALLRAID,portMAX_DELAY) != pdTRUE) {
-								VT_HANDLE_FATAL_ERROR(0);
-							}
-							curState = LEFT;
-							curRaid = SMALLRAID;
-						}
-						#endif
-						lastTurn = 0;
-					}
-					
-					//hard Right (128+SMALLRAID)
-					else if(distanceF < -0.4)
-					{
-						i2cCmdTurn[2] = TURNSPEED;
-						if(i2cCmdTurn[3] != 128 + SMALLRAID)
-							SENDCMD = 1;
-						i2cCmdTurn[3] = 128 + SMALLRAID;
-						#if(USEMAPPING == 1)
-						if((curState != RIGHT)||(curRaid != SMALLRAID))
-						{
-							//10 is radius
-							if (SendMapMsg(mapData,MapTurnRight,0,0,SMALLRAID,portMAX_DELAY) != pdTRUE) {
-								VT_HANDLE_FATAL_ERROR(0);
-							}
-							curState = RIGHT;
-							curRaid = 10;
-						}
-						#endif
-						lastTurn = 1;
-					}
-				}
-				else
-				{
-					//small Left
-					if(distanceF > 0)
-					{
-						i2cCmdTurn[2] = TURNSPEED;
-						if(i2cCmdTurn[3] != LARGERAID)
-							SENDCMD = 1;
-						i2cCmdTurn[3] = LARGERAID;
-						//20 is radius
-						#if(USEMAPPING == 1)
-						if((curState != LEFT) || (curRaid != LARGERAID))
-						{
-							if (SendMapMsg(mapData,MapTurnLeft,0,0,LARGERAID,portMAX_DELAY) != pdTRUE) {
-								VT_HANDLE_FATAL_ERROR(0);
-							}
-							curState = LEFT;
-							curRaid = 20;
-						}
-						#endif
-						lastTurn = 0;
-					}
-					//127 = straight
-					else if(distanceF == 0)
-					{
-						i2cCmdTurn[2] = STRAIGHTSPEED;
-						if(i2cCmdTurn[3] != 127)
-							SENDCMD = 1;
-						i2cCmdTurn[3] = 127;
-						//255 is radius
-						#if(USEMAPPING == 1)
-						if((curState != STRAIGHT))
-						{
-							if (SendMapMsg(mapData,MapStraight,0,0,127,portMAX_DELAY) != pdTRUE) {
-								VT_HANDLE_FATAL_ERROR(0);
-							}
-							curState = STRAIGHT;
-							curRaid = 127;
-						}
-						#endif
-					}
-					//small Right (128+LARGERAID)
-					else
-					{
-						i2cCmdTurn[2] = TURNSPEED;
-						if(i2cCmdTurn[3] != 128 + LARGERAID)
-							SENDCMD = 1;
-						i2cCmdTurn[3] = 128 + LARGERAID;
-						#if(USEMAPPING == 1)
-						if((curState != RIGHT)||(curRaid != 20))
-						{
-							//20 is radius
-							if (SendMapMsg(mapData,MapTurnRight,0,0,LARGERAID,portMAX_DELAY) != pdTRUE) {
-								VT_HANDLE_FATAL_ERROR(0);
-							}
-							curState = RIGHT;
-							curRaid = 10;
-						}
-						#endif
-						lastTurn = 1;
-					}
-				}
-			}
-			else
-			{	
-				i2cCmdTurn[2] = STRAIGHTSPEED; 
-				if(i2cCmdTurn[3] != 127)
-					SENDCMD = 1;  
-				i2cCmdTurn[3] = 127;
-				//255 is radius
-				#if(USEMAPPING == 1)
-				if((curState != STRAIGHT))
+				if(curState != STRAIGHT)
 				{
 					if (SendMapMsg(mapData,MapStraight,0,0,127,portMAX_DELAY) != pdTRUE) {
 						VT_HANDLE_FATAL_ERROR(0);
 					}
 					curState = STRAIGHT;
-					curRaid = 255;
+					curRaid = 127;
 				}
-				#endif
 			}
+			else if((curState != (lastTurn ? RIGHT : LEFT)) || (curRaid != (radius & 0x7F)))
+			{
+				if (SendMapMsg(mapData,lastTurn ? MapTurnRight : MapTurnLeft,0,0,radius & 0x7F,portMAX_DELAY) != pdTRUE) {
+					VT_HANDLE_FATAL_ERROR(0);
+				}
+				curState = lastTurn ? RIGHT : LEFT;
+				curRaid = radius & 0x7F;
+			}
+			#endif
 			//printf("S:%d:%d:%d \n",val1,val2,i2cCmdTurn[3]);
 			/*if (lcdData != NULL) {
 				if (SendLCDPrintMsg(lcdData,strnlen(lcdBuffer,vtLCDMaxLen),lcdBuffer,4,portMAX_DELAY) != pdTRUE) {
@@ -419,53 +488,17 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 			} */
 			
 			
-			if(START == 1 && SENDCMD == 1 && inPivot == 0)
+			// the motor task drops the request if the motors are already doing this
+			if(START == 1 && inPivot == 0)
 			{
-				i2cCmdTurn[2] = PIVOTSPEED;
-				i2cCmdTurn[1] = countMotorCommand;
-				countMotorCommand++;
-
-				SENDCMD = 0;
-				sprintf(lcdBuffer,"S: %d,%d,%d,%d",i2cCmdTurn[0],i2cCmdTurn[1],i2cCmdTurn[2],i2cCmdTurn[3]);
-				if (lcdData != NULL) {
-					if (SendLCDPrintMsg(lcdData,strnlen(lcdBuffer,vtLCDMaxLen),lcdBuffer,8,portMAX_DELAY) != pdTRUE) {
-						VT_HANDLE_FATAL_ERROR(0);
-					}
-				}
-				#if TESTING == 0
-				//Send the correct motor command
-				if (vtI2CEnQ(devPtr,vtI2CMsgTypeMotorSend,0x4d,sizeof(i2cCmdTurn),i2cCmdTurn,0) != pdTRUE) {
-					VT_HANDLE_FATAL_ERROR(0);
-				}
-				#else
-				//Send the correct motor command
-				if (vtTestEnQ(testData,vtI2CMsgTypeMotorSend,0x4d,sizeof(i2cCmdTurn),i2cCmdTurn,0) != pdTRUE) {
+				if (SendMotorDrive(motorData,driveSpeed,radius,portMAX_DELAY) != pdTRUE) {
 					VT_HANDLE_FATAL_ERROR(0);
 				}
-				#endif
 			}
 			break;
 		}
-		case vtI2CMsgTypeMotorRead: {
-		    #if TESTING == 0
-				i2cCmdTurn[2] = 20;
-				i2cCmdTurn[3] = 127;
-				//Send the correct motor command
-				if (vtI2CEnQ(devPtr,vtI2CMsgTypeMotorSend,0x4f,sizeof(i2cCmdTurn),i2cCmdTurn,0) != pdTRUE) {
-					VT_HANDLE_FATAL_ERROR(0);
-				}
-				sprintf(lcdBuffer,"m: %d, %d, %d, %d",i2cCmdTurn[0],i2cCmdTurn[1],i2cCmdTurn[2],i2cCmdTurn[3]);
-					if (lcdData != NULL) {
-						if (SendLCDPrintMsg(lcdData,strnlen(lcdBuffer,vtLCDMaxLen),lcdBuffer,6,portMAX_DELAY) != pdTRUE) {
-							VT_HANDLE_FATAL_ERROR(0);
-						}
-				}
-			#endif
-		    break;
-		}
 		case FrontValMsg: {
 			int msgCount = getCount(&msgBuffer);
-			int val1 = getVal1(&msgBuffer);
 			int val2 = getVal2(&msgBuffer);
 
 			if(countStartFront == 0)
@@ -494,73 +527,36 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 					VT_HANDLE_FATAL_ERROR(0);
 				}
 			} 
-			if(val2 < FRONTSAFEZONE)
+			if((val2 < param->tuning.frontSafeZone) || ((inPivot == 1) && (val2 < param->tuning.frontSafeZone + param->tuning.frontHysteresis)))
 			{
-				if(START == 1)
+				// the pivot only needs asking for once -- the motors keep turning until told otherwise
+				if(START == 1 && inPivot == 0)
 				{
-					i2cCmdTurn[1] = countMotorCommand;
-					countMotorCommand++;
-
-					i2cCmdTurn[2] = 20;
-
-						if(lastTurn == 0)
-							i2cCmdTurn[3] = 128;
-						else
-							i2cCmdTurn[3] = 0;
-
-					inPivot = 1;
-
-					SENDCMD = 0;
-					sprintf(lcdBuffer,"S: %d,%d,%d,%d",i2cCmdTurn[0],i2cCmdTurn[1],i2cCmdTurn[2],i2cCmdTurn[3]);
-					if (lcdData != NULL) {
-						if (SendLCDPrintMsg(lcdData,strnlen(lcdBuffer,vtLCDMaxLen),lcdBuffer,8,portMAX_DELAY) != pdTRUE) {
-							VT_HANDLE_FATAL_ERROR(0);
-						}
-					}
-					#if TESTING == 0
-					//Send the correct motor command
-					if (vtI2CEnQ(devPtr,vtI2CMsgTypeMotorSend,0x4d,sizeof(i2cCmdTurn),i2cCmdTurn,0) != pdTRUE) {
-						VT_HANDLE_FATAL_ERROR(0);
-					}
-					#else
-					//Send the correct motor command
-					if (vtTestEnQ(testData,vtI2CMsgTypeMotorSend,0x4d,sizeof(i2cCmdTurn),i2cCmdTurn,0) != pdTRUE) {
+					// turn away from the side we last steered towards
+					if (SendMotorPivot(motorData,param->tuning.pivotSpeed,lastTurn == 0,portMAX_DELAY) != pdTRUE) {
 						VT_HANDLE_FATAL_ERROR(0);
 					}
-					#endif
+					inPivot = 1;
 				}
-				else
+				else if(START != 1)
 				{
-					sprintf(lcdBuffer,"Hault");
-					if (lcdData != NULL) {
-						if (SendLCDPrintMsg(lcdData,strnlen(lcdBuffer,vtLCDMaxLen),lcdBuffer,8,portMAX_DELAY) != pdTRUE) {
-							VT_HANDLE_FATAL_ERROR(0);
-						}
-					}
-					#if TESTING == 0
-					//Send the correct motor command
-					if (vtI2CEnQ(devPtr,vtI2CMsgTypeMotorSend,0x4d,sizeof(i2cCmdHault),i2cCmdHault,0) != pdTRUE) {
-						VT_HANDLE_FATAL_ERROR(0);
-					}
-					#else
-					//Send the correct motor command
-					if (vtTestEnQ(testData,vtI2CMsgTypeMotorSend,0x4d,sizeof(i2cCmdHault),i2cCmdHault,0) != pdTRUE) {
+					if (SendMotorHalt(motorData,portMAX_DELAY) != pdTRUE) {
 						VT_HANDLE_FATAL_ERROR(0);
 					}
-					#endif
 				}
 			}
 			else
 			{
+				// out of the pivot: the next distance sample asks for the steering again
 				inPivot = 0;
-				i2cCmdTurn[2] = 15;
 			}
 			break;
 		}
 		case UpdateSpeed: {
-			int speed = getVal2(&msgBuffer);
-			i2cCmdStraight[2] = speed;
-			i2cCmdTurn[2] = speed;
+			driveSpeed = getVal2(&msgBuffer);
+			if (SendMotorSpeed(motorData,driveSpeed,portMAX_DELAY) != pdTRUE) {
+				VT_HANDLE_FATAL_ERROR(0);
+			}
 			break;
 		}
 		case vtI2CMsgTypeAccRead: {
@@ -606,7 +602,7 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 
 			#if TESTING == 0
 			//For now just send back a command to go straight
-			if (vtI2CEnQ(devPtr,vtI2CMsgTypeMotorSend,0x4f,sizeof(i2cCmdHault),i2cCmdHault,0) != pdTRUE) {
+			if (vtI2CEnQPrio(devPtr,vtI2CPrioUrgent,vtI2CNoDeadline,vtI2CMsgTypeMotorSend,0x4f,sizeof(i2cCmdHault),i2cCmdHault,0) != pdTRUE) {
 				VT_HANDLE_FATAL_ERROR(0);
 			}
 			#else
@@ -656,7 +652,7 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 		}
 		case NavMsgTypeTimer: {
 			c++;
-			if (vtI2CEnQ(devPtr,NavMsgTypeTimer,0x4f,sizeof(i2cCmdReadVals),i2cCmdReadVals,4) != pdTRUE) {
+			if (vtI2CBatchEnQ(devPtr,vtI2CPrioNormal,POLLDEADLINE,NavMsgTypeTimer,SAMPLESPERPOLL,i2cReadBatch) != pdTRUE) {
 				VT_HANDLE_FATAL_ERROR(0);
 			}
 			if(c == 10)
@@ -683,7 +679,7 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 				}
 				#if TESTING == 0
 				//Send the correct motor command
-				if (vtI2CEnQ(devPtr,vtI2CMsgTypeMotorSend,0x4d,sizeof(i2cCmdTurn),i2cCmdTurn,0) != pdTRUE) {
+				if (vtI2CEnQPrio(devPtr,vtI2CPrioUrgent,vtI2CNoDeadline,vtI2CMsgTypeMotorSend,0x4d,sizeof(i2cCmdTurn),i2cCmdTurn,0) != pdTRUE) {
 					VT_HANDLE_FATAL_ERROR(0);
 				}
 				#else
@@ -692,7 +688,7 @@ static portTASK_FUNCTION( vNavUpdateTask, pvParameters )
 					VT_HANDLE_FATAL_ERROR(0);
 				}
 				#endif
-			/*}
+			}
 			else
 			{
 				if (vtI2CEnQ(devPtr,NavMsgTypeTimer,0x4f,sizeof(i2cCmdReadVals),i2cCmdReadVals,4) != pdTRUE) {
@@ -4,6 +4,18 @@
 #include "lcdTask.h"
 #include "mapping.h"
 #include "testing.h"
+#include "motor.h"
+// The values the navigation decisions are tuned with (the defaults are the #defines in navigation.c)
+typedef struct __vtNavParams {
+	int safeZone;			// steer away from a side wall nearer than this (cm)
+	int frontSafeZone;		// pivot away from a wall in front nearer than this (cm)
+	int frontHysteresis;	// and keep pivoting until it is this much further away (cm)
+	uint8_t driveSpeed;		// motor PIC speed along the corridor, until the map asks for another
+	uint8_t pivotSpeed;		// motor PIC speed for a pivot
+	int32_t steerKp;		// wall following gains (Q15, see vNavSetSteeringGains())
+	int32_t steerKd;
+} vtNavParams;
+
 // Structure used to pass parameters to the task
 // Do not touch...
 typedef struct __NavStruct {
@@ -11,7 +23,12 @@ typedef struct __NavStruct {
 	vtLCDStruct *lcdData;
 	vtMapStruct *mapData;
 	vtTestStruct *testData;
-	xQueueHandle inQ;
+	vtMotorStruct *motorData;
+	xQueueHandle inQ;			// accelerometer samples and speed changes
+	xQueueHandle urgentQ;		// the IR distances the steering and pivots act on
+	xQueueHandle timerQ;		// timer ticks
+	xQueueSetHandle inSet;		// the three queues above -- the task blocks on this
+	vtNavParams tuning;
 } vtNavStruct;
 // Maximum length of a message that can be received by this task
 #define vtNavMaxLen   (sizeof(portTickType))
@@ -25,7 +42,22 @@ typedef struct __NavStruct {
 //   i2c: pointer to the data structure for an i2c task
 //   lcd: pointer to the data structure for an LCD task (may be NULL)
 //   map: pointer to the data structure for a map task
-void vStartNavTask(vtNavStruct *navData,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtLCDStruct *lcd,vtMapStruct *map,vtTestStruct *test);
+//   test: pointer to the data structure for the test task
+//   motor: pointer to the data structure for the motor task, which sends the motor commands
+void vStartNavTask(vtNavStruct *navData,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtLCDStruct *lcd,vtMapStruct *map,vtTestStruct *test,vtMotorStruct *motor);
+//
+// Set the gains of the wall following steering (call after vStartNavTask())
+//   The steering output is kp*error + kd*(change in error), where the error is (left-right)/(left+right)
+//   from the side IR sensors.  The output is slew limited and quantized to the motor PIC's radius byte.
+// Args:
+//   navData: Data structure used by the task
+//   kp -- proportional gain in Q15 (0-32767, 32767 is just under 1.0)
+//   kd -- derivative gain in Q15 (0-32767)
+void vNavSetSteeringGains(vtNavStruct *navData,int32_t kp,int32_t kd);
+//
+// Get the default tuning, and replace all of it (call after vStartNavTask() and before the scheduler is started)
+void vNavGetDefaultParams(vtNavParams *tuning);
+void vNavSetParams(vtNavStruct *navData,const vtNavParams *tuning);
 //
 // Send a timer message to the Navigation task
 // Args:
@@ -0,0 +1,93 @@
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lpc_types.h"
+
+/* include files. */
+#include "vtUtilities.h"
+#include "sensorBus.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+typedef struct __vtSensorSub {
+	vtSensorDeliver deliver;
+	void *subscriber;
+	unsigned long dropped;		// samples this subscriber did not take in time
+} vtSensorSub;
+
+// The subscription table, indexed by message type
+//   Entries are only added (and numSubs only goes up after the entry is filled in), so publishers read it without locking
+static vtSensorSub subs[vtSensorBusMaxTypes][vtSensorBusMaxSubs];
+static uint8_t numSubs[vtSensorBusMaxTypes];
+// end of defs
+/* *********************************************** */
+
+/*-----------------------------------------------------------*/
+// Public API
+void vtSensorSubscribe(uint8_t msgType,vtSensorDeliver deliver,void *subscriber)
+{
+	if ((msgType >= vtSensorBusMaxTypes) || (deliver == NULL)) {
+		VT_HANDLE_FATAL_ERROR(msgType);
+	}
+	portENTER_CRITICAL();
+	if (numSubs[msgType] >= vtSensorBusMaxSubs) {
+		// too many subscribers for this type
+		portEXIT_CRITICAL();
+		VT_HANDLE_FATAL_ERROR(msgType);
+	}
+	subs[msgType][numSubs[msgType]].deliver = deliver;
+	subs[msgType][numSubs[msgType]].subscriber = subscriber;
+	subs[msgType][numSubs[msgType]].dropped = 0;
+	numSubs[msgType]++;
+	portEXIT_CRITICAL();
+}
+
+portBASE_TYPE vtSensorPublish(const vtSensorSample *sample,portTickType ticksToBlock)
+{
+	portBASE_TYPE retval = pdTRUE;
+	int i;
+
+	if (sample->msgType >= vtSensorBusMaxTypes) {
+		return(pdFALSE);
+	}
+	for (i=0;i<numSubs[sample->msgType];i++) {
+		if (subs[sample->msgType][i].deliver(subs[sample->msgType][i].subscriber,sample,ticksToBlock) != pdTRUE) {
+			portENTER_CRITICAL();
+			subs[sample->msgType][i].dropped++;
+			portEXIT_CRITICAL();
+			retval = pdFALSE;
+		}
+	}
+	return(retval);
+}
+
+portBASE_TYPE vtSensorPublishValues(uint8_t msgType,uint8_t count,uint8_t value1,uint8_t value2,portTickType ticksToBlock)
+{
+	vtSensorSample sample;
+
+	sample.msgType = msgType;
+	sample.count = count;
+	sample.value1 = value1;
+	sample.value2 = value2;
+	sample.status = SUCCESS;
+	return(vtSensorPublish(&sample,ticksToBlock));
+}
+
+unsigned long vtSensorDropped(void *subscriber)
+{
+	unsigned long dropped = 0;
+	int msgType, i;
+
+	portENTER_CRITICAL();
+	for (msgType=0;msgType<vtSensorBusMaxTypes;msgType++) {
+		for (i=0;i<numSubs[msgType];i++) {
+			if (subs[msgType][i].subscriber == subscriber) {
+				dropped += subs[msgType][i].dropped;
+			}
+		}
+	}
+	portEXIT_CRITICAL();
+	return(dropped);
+}
+// End of Public API
+/*-----------------------------------------------------------*/
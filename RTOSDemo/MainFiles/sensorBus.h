@@ -0,0 +1,64 @@
+#ifndef SENSOR_BUS_H
+#define SENSOR_BUS_H
+#include "FreeRTOS.h"
+
+// The sensor bus routes samples from the task that produces them (normally the I2C thread) to every task that
+//   wants them, keyed on the message type ids in I2CTaskMsgTypes.h.  A producer publishes a sample once and each
+//   subscriber's delivery function is called in turn -- there is no routing task in between.
+//
+// Subscriptions are made while the tasks are being set up, before the scheduler is started.
+
+// Message type ids must be below this
+#define vtSensorBusMaxTypes 64
+// Most subscribers for one message type
+#define vtSensorBusMaxSubs 4
+
+// A sample as it is passed to subscribers: the message type and the three bytes after the command echo in the
+//   I2C reply (the message count and two values), and the status of the transfer it came from
+typedef struct __vtSensorSample {
+	uint8_t msgType;
+	uint8_t count;
+	uint8_t value1;
+	uint8_t value2;
+	uint8_t status;		// SUCCESS, or ERROR if the I2C transfer failed (see vtI2CMsg)
+} vtSensorSample;
+
+// Called for each sample a subscriber has asked for, in the publisher's task
+//   It should do no more than put the sample on the subscriber's queue, waiting no longer than ticksToBlock
+// Args:
+//   subscriber -- the pointer given to vtSensorSubscribe()
+//   sample -- the sample (only valid during the call)
+//   ticksToBlock -- the publisher's block time
+// Return:
+//   pdTRUE if the sample was delivered
+typedef portBASE_TYPE (*vtSensorDeliver)(void *subscriber,const vtSensorSample *sample,portTickType ticksToBlock);
+
+// Public API
+//
+// Ask for the samples of one message type
+// Args:
+//   msgType -- the message type (see I2CTaskMsgTypes.h)
+//   deliver -- the function called with each sample
+//   subscriber -- passed to deliver (usually the task's parameter structure)
+void vtSensorSubscribe(uint8_t msgType,vtSensorDeliver deliver,void *subscriber);
+//
+// Send a sample to everything that has subscribed to its type (samples that nobody has asked for are dropped)
+//   A subscriber that does not take the sample within ticksToBlock misses it and the miss is counted
+// Args:
+//   sample -- the sample
+//   ticksToBlock -- how long to wait for each subscriber (a task that must not stall, such as the I2C thread,
+//                   should use 0)
+// Return:
+//   pdTRUE if every subscriber took the sample
+portBASE_TYPE vtSensorPublish(const vtSensorSample *sample,portTickType ticksToBlock);
+//
+// Same as vtSensorPublish(), with the fields given separately (for samples that did not fail)
+portBASE_TYPE vtSensorPublishValues(uint8_t msgType,uint8_t count,uint8_t value1,uint8_t value2,portTickType ticksToBlock);
+//
+// How many samples a subscriber has missed, over all of its subscriptions
+// Args:
+//   subscriber -- the pointer given to vtSensorSubscribe()
+// Return:
+//   the number of samples it did not take in time
+unsigned long vtSensorDropped(void *subscriber);
+#endif
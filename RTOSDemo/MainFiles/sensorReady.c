@@ -0,0 +1,140 @@
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "projdefs.h"
+#include "semphr.h"
+
+/* include files. */
+#include "lpc17xx_exti.h"
+#include "lpc17xx_pinsel.h"
+#include "vtUtilities.h"
+#include "vtTrace.h"
+#include "vtI2C.h"
+#include "I2CTaskMsgTypes.h"
+#include "sensorReady.h"
+
+/* **************************************************************** */
+// WARNING: Do not print in this file -- the stack is not large enough for this task
+/* **************************************************************** */
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+#define sensorReadySTACK_SIZE		(2*configMINIMAL_STACK_SIZE)
+// Must be no higher (numerically lower) than configMAX_SYSCALL_INTERRUPT_PRIORITY, as for the I2C interrupts
+#define sensorReadyIntPriority 7
+// The sensor PIC and the command that reads its next sample
+#define sensorReadySlvAddr 0x4F
+#define sensorReadyRxLen 4
+static const uint8_t sensorReadyCmd[] = { 0xCC };
+// A sample read for an edge is of no use once the next one is due, so it is dropped if it has not
+//   made it onto the bus by then
+#define sensorReadyDEADLINE ((portTickType) 10 / portTICK_RATE_MS)
+// With no edge for this long, read a batch the way the Nav timer used to
+#define sensorReadyTIMEOUT ((portTickType) 50 / portTICK_RATE_MS)
+#define sensorReadyPOLLBATCH 5
+
+// For the interrupt handler
+static vtSensorReadyStruct *readyStaticPtr = NULL;
+// Memory for the task and its semaphore
+static portSTACK_TYPE readyStack[sensorReadySTACK_SIZE];
+static xStaticTask readyTCB;
+static xStaticSemaphore readySemaphore;
+// end of defs
+/* *********************************************** */
+
+/* The task that starts the reads */
+static portTASK_FUNCTION_PROTO( vSensorReadyTask, pvParameters );
+
+/*-----------------------------------------------------------*/
+// Public API
+void vStartSensorReadyTask(vtSensorReadyStruct *params,unsigned portBASE_TYPE uxPriority,vtI2CStruct *i2c)
+{
+	PINSEL_CFG_Type PinCfg;
+	EXTI_InitTypeDef ExtiCfg;
+	portBASE_TYPE retval;
+
+	if ((params == NULL) || (i2c == NULL) || (readyStaticPtr != NULL)) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	params->dev = i2c;
+	params->edges = 0;
+	params->polls = 0;
+	// Create semaphore to communicate with interrupt handler, initially taken
+	vSemaphoreCreateBinaryStatic(params->binSemaphore,&readySemaphore);
+	if (params->binSemaphore == NULL) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	if (xSemaphoreTake(params->binSemaphore,0) != pdTRUE) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	readyStaticPtr = params;
+
+	// Start with the interrupt disabled *and* make sure we have the priority correct
+	NVIC_SetPriority(EINT2_IRQn,sensorReadyIntPriority);
+	NVIC_DisableIRQ(EINT2_IRQn);
+	// P2.12 as EINT2, falling edge
+	PinCfg.OpenDrain = 0;
+	PinCfg.Pinmode = 0;
+	PinCfg.Funcnum = 1;
+	PinCfg.Pinnum = 12;
+	PinCfg.Portnum = 2;
+	PINSEL_ConfigPin(&PinCfg);
+	EXTI_Init();
+	ExtiCfg.EXTI_Line = EXTI_EINT2;
+	ExtiCfg.EXTI_Mode = EXTI_MODE_EDGE_SENSITIVE;
+	ExtiCfg.EXTI_polarity = EXTI_POLARITY_LOW_ACTIVE_OR_FALLING_EDGE;
+	EXTI_Config(&ExtiCfg);
+	EXTI_ClearEXTIFlag(EXTI_EINT2);
+
+	if ((retval = xTaskCreateStatic( vSensorReadyTask, ( signed char * ) "Ready", sensorReadySTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL, readyStack, &readyTCB )) != pdPASS) {
+		VT_HANDLE_FATAL_ERROR(retval);
+	}
+}
+
+// EINT2 interrupt handler -- all of the work is left to the task
+void vtSensorReadyIsr(void)
+{
+	static signed portBASE_TYPE xHigherPriorityTaskWoken;
+
+	vtTraceIsrEnter(vtTraceIsrEINT2);
+	EXTI_ClearEXTIFlag(EXTI_EINT2);
+	readyStaticPtr->edges++;
+	xHigherPriorityTaskWoken = pdFALSE;
+	// Edges that arrive before the task has started the last read are merged into one read
+	xSemaphoreGiveFromISR(readyStaticPtr->binSemaphore,&xHigherPriorityTaskWoken);
+	vtTraceIsrExit(vtTraceIsrEINT2);
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+// End of Public API
+/*-----------------------------------------------------------*/
+
+// This is the actual task that is run
+static portTASK_FUNCTION( vSensorReadyTask, pvParameters )
+{
+	vtSensorReadyStruct *param = (vtSensorReadyStruct *) pvParameters;
+	vtI2CBatchOp pollBatch[sensorReadyPOLLBATCH];
+	int i;
+
+	for (i=0;i<sensorReadyPOLLBATCH;i++) {
+		pollBatch[i].slvAddr = sensorReadySlvAddr;
+		pollBatch[i].txLen = sizeof(sensorReadyCmd);
+		pollBatch[i].txBuf = sensorReadyCmd;
+		pollBatch[i].rxLen = sensorReadyRxLen;
+	}
+	// Now that there is someone to wake, let the edges in
+	NVIC_EnableIRQ(EINT2_IRQn);
+
+	for (;;) {
+		if (xSemaphoreTake(param->binSemaphore,sensorReadyTIMEOUT) == pdTRUE) {
+			// The results go wherever the I2C task's result handler sends them (see conductor.c)
+			if (vtI2CEnQPrio(param->dev,vtI2CPrioNormal,sensorReadyDEADLINE,SensorMsgTypeReady,sensorReadySlvAddr,sizeof(sensorReadyCmd),sensorReadyCmd,sensorReadyRxLen) != pdTRUE) {
+				VT_HANDLE_FATAL_ERROR(0);
+			}
+		} else {
+			param->polls++;
+			if (vtI2CBatchEnQ(param->dev,vtI2CPrioNormal,sensorReadyTIMEOUT,SensorMsgTypeReady,sensorReadyPOLLBATCH,pollBatch) != pdTRUE) {
+				VT_HANDLE_FATAL_ERROR(0);
+			}
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#ifndef SENSOR_READY_H
+#define SENSOR_READY_H
+#include "vtI2C.h"
+
+// The sensor PIC pulls its data-ready line low each time it has a new sample.  The line is wired to
+//   P2.12 (EINT2) and the interrupt handler wakes a small task that starts the I2C read straight away,
+//   so a sample is read about one bus transaction after it is taken instead of waiting for the next
+//   50ms Nav timer tick.
+//
+// If no edge arrives for sensorReadyTIMEOUT (see sensorReady.c) -- a PIC without the line, or a
+//   disconnected wire -- the task falls back to reading a batch of samples, as the Nav timer did.
+
+// Structure used to pass parameters to the task
+// Do not touch...
+typedef struct __vtSensorReadyStruct {
+	vtI2CStruct *dev;
+	xSemaphoreHandle binSemaphore;	// given by the EINT2 interrupt handler
+	unsigned long edges;			// data-ready edges seen
+	unsigned long polls;			// batches read because the line went quiet
+} vtSensorReadyStruct;
+
+// Public API
+//
+// Start the task and enable the data-ready interrupt
+// Only one of these can be started (there is only one data-ready line)
+// Args:
+//   readyData: Data structure used by the task
+//   uxPriority -- the priority you want this task to be run at (it should be above the tasks that use
+//                 the samples, as it only does the work that cannot be done in the interrupt handler)
+//   i2c: pointer to the data structure for the i2c task the sensor PIC is on
+void vStartSensorReadyTask(vtSensorReadyStruct *readyData,unsigned portBASE_TYPE uxPriority,vtI2CStruct *i2c);
+
+// The EINT2 interrupt handler (in the vector table in place of EINT2_IRQHandler)
+void vtSensorReadyIsr(void);
+#endif
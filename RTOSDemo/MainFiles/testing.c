@@ -12,7 +12,7 @@
 /* include files. */
 #include "vtUtilities.h"
 #include "vtI2C.h"
-#include "LCDtask.h"
+#include "lcdTask.h"
 #include "I2CTaskMsgTypes.h"
 #include "testing.h"
 #include "mapping.h"
@@ -86,6 +86,35 @@ typedef struct __vtTestI2CMsg {
 #define FINWIDTH 17
 #endif
 
+// The courses are drawn into a bitmap of the part of the screen they use, so that looking up a pixel
+//   does not mean searching the wall lists -- every course must fit in this window
+#define SIMWORLDX 96
+#define SIMWORLDY 128
+#define SIMWORLDW 128
+#define SIMWORLDH 128
+// Bits in the bitmap for each pixel
+#define SIMWALL 1
+#define SIMFINISH 2
+
+// The sensors can only see 80 cm (1 pixel = 1 cm)
+#define SIMIRRANGE 80
+
+// sin() of 0..90 degrees, in 1/16384
+static const int16_t simSin[91] = {
+	    0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,  2845,  3126,  3406,
+	 3686,  3964,  4240,  4516,  4790,  5063,  5334,  5604,  5872,  6138,  6402,  6664,  6924,
+	 7182,  7438,  7692,  7943,  8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087,
+	10311, 10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365, 12551, 12733,
+	12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044, 14189, 14330, 14466, 14598, 14726,
+	14849, 14968, 15082, 15191, 15296, 15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964,
+	16026, 16083, 16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382, 16384,
+};
+
+// Memory for the task and its queue
+static portSTACK_TYPE testStack[testSTACK_SIZE];
+static xStaticTask testTCB;
+static xStaticQueue testQueue;
+static uint8_t testQueueStorage[vtTestQLen*sizeof(vtTestI2CMsg)];
 // end of defs
 /* *********************************************** */
 
@@ -93,6 +122,8 @@ typedef struct __vtTestI2CMsg {
 uint8_t simRightWall[MAXRIGHT][2];
 uint8_t simLeftWall[MAXLEFT][2];
 uint8_t simFinish[FINWIDTH][2];
+// Two bits a pixel (SIMWALL, SIMFINISH), four pixels to a byte
+static uint8_t simWorld[(SIMWORLDW*SIMWORLDH)/4];
 
 //Simulation Car position
 int simCar[4];
@@ -116,7 +147,7 @@ static portTASK_FUNCTION_PROTO( vTestUpdateTask, pvParameters );
 void vStartTestTask(vtTestStruct *params,unsigned portBASE_TYPE uxPriority, vtI2CStruct *i2c,vtLCDStruct *lcd)
 {
 	// Create the queue that will be used to talk to this task
-	if ((params->inQ = xQueueCreate(vtTestQLen,sizeof(vtTestI2CMsg))) == NULL) {
+	if ((params->inQ = xQueueCreateStatic(vtTestQLen,sizeof(vtTestI2CMsg),testQueueStorage,&testQueue)) == NULL) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
 	/* Start the task */
@@ -125,7 +156,7 @@ void vStartTestTask(vtTestStruct *params,unsigned portBASE_TYPE uxPriority, vtI2
 	params->lcdData = lcd;
 	lcdScreen = lcd;
 	RUNTEST = 0;
-	if ((retval = xTaskCreate( vTestUpdateTask, ( signed char * ) "Testing", testSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL )) != pdPASS) {
+	if ((retval = xTaskCreateStatic( vTestUpdateTask, ( signed char * ) "Testing", testSTACK_SIZE, (void *) params, uxPriority, ( xTaskHandle * ) NULL, testStack, &testTCB )) != pdPASS) {
 		VT_HANDLE_FATAL_ERROR(retval);
 	}
 }
@@ -204,142 +235,108 @@ uint8_t getTestVal2(vtTestI2CMsg *Buffer)
 	return(rd);
 }
 
-int isWall(int px,int py)
+static int simPixel(int px,int py)
 {
-	int j;
+	int i;
 
-	for(j=0;j<MAXRIGHT;j++)
-	{
-		//checks to see if the new pixel = a wall pixel
-		if(((px == simRightWall[j][0]) &&
-		   (py == simRightWall[j][1])))
-		{
-		   	return 1;
-		}
-	}
-	for(j=0;j<MAXLEFT;j++)
-	{
-		if(((px == simLeftWall[j][0]) &&
-		   (py == simLeftWall[j][1])))
-		{
-			return 1;
-		}
+	if ((px < SIMWORLDX) || (px >= SIMWORLDX+SIMWORLDW) || (py < SIMWORLDY) || (py >= SIMWORLDY+SIMWORLDH)) {
+		return 0;
 	}
-	return 0;
+	i = (py - SIMWORLDY)*SIMWORLDW + (px - SIMWORLDX);
+	return((simWorld[i >> 2] >> ((i & 3) << 1)) & 3);
 }
-int isFinish(int px,int py)
+
+static void simDraw(int px,int py,int what)
 {
-	int j;
+	int i;
 
-	for(j=0;j<FINWIDTH;j++)
-	{
-		//checks to see if the new pixel = a wall pixel
-		if(((px == simFinish[j][0]) &&
-		   (py == simFinish[j][1])))
-		{
-		   	return 1;
-		}
+	if ((px < SIMWORLDX) || (px >= SIMWORLDX+SIMWORLDW) || (py < SIMWORLDY) || (py >= SIMWORLDY+SIMWORLDH)) {
+		// the course does not fit in the bitmap
+		VT_HANDLE_FATAL_ERROR(0);
 	}
-	return 0;
+	i = (py - SIMWORLDY)*SIMWORLDW + (px - SIMWORLDX);
+	simWorld[i >> 2] |= what << ((i & 3) << 1);
 }
-int getDL(int cPX,int cPY, int angle)
+
+// sin() and cos() of any angle in degrees, in 1/16384
+static int simSinDeg(int angle)
 {
+	angle %= 360;
+	if (angle < 0)
+		angle += 360;
+	if (angle <= 90)
+		return simSin[angle];
+	if (angle <= 180)
+		return simSin[180-angle];
+	if (angle <= 270)
+		return -simSin[angle-180];
+	return -simSin[360-angle];
+}
+
+static int simCosDeg(int angle)
+{
+	return simSinDeg(angle+90);
+}
+
+int isWall(int px,int py)
+{
+	return((simPixel(px,py) & SIMWALL) != 0);
+}
+int isFinish(int px,int py)
+{
+	return((simPixel(px,py) & SIMFINISH) != 0);
+}
+
+// Distance (cm) from the middle of pixel (cPX,cPY) to the first wall pixel along a heading, or SIMIRRANGE if
+//   there is none that close.  Headings are in degrees counter clockwise from straight up the screen, as simCar[3].
+// The ray visits every pixel it passes through (so it cannot slip between the pixels of a diagonal wall) and
+//   all of the arithmetic is integer: distances along the ray are kept in 1/16384 cm.
+int simRayCast(int cPX,int cPY,int angle)
+{
+	// direction of the ray -- up the screen is -y
+	int dx = -simSinDeg(angle);
+	int dy = -simCosDeg(angle);
 	int px = cPX;
 	int py = cPY;
-	int count = 0;
-	while(isWall(px,py) == 0)
+	int sx = (dx < 0) ? -1 : 1;
+	int sy = (dy < 0) ? -1 : 1;
+	// distance along the ray to cross one pixel in x (or y), and to the next pixel edge in x (or y)
+	int32_t tDeltaX = (dx != 0) ? (((int32_t) 1 << 28)/abs(dx)) : 0x7FFFFFFF;
+	int32_t tDeltaY = (dy != 0) ? (((int32_t) 1 << 28)/abs(dy)) : 0x7FFFFFFF;
+	int32_t tMaxX = tDeltaX/2;
+	int32_t tMaxY = tDeltaY/2;
+	int32_t t = 0;
+	const int32_t range = (int32_t) SIMIRRANGE << 14;
+
+	while (!isWall(px,py))
 	{
-		count++;
-		//sensor can only see 80 cm away
-		if(count == 80)
-			break;
-		if(angle == 0)
-			px--;
-		else if(angle == 45)
-		{
-			px--;
-			py++;
-		}
-		else if(angle == 90)
-		{
-			py++;
-		}
-		else if(angle == 135)
+		if (tMaxX < tMaxY)
 		{
-			px++;
-			py++;
+			t = tMaxX;
+			tMaxX += tDeltaX;
+			px += sx;
 		}
-		else if(angle == 180)
-		{
-			px++;
-		}
-		else if(angle == 225)
-		{
-			px++;
-			py--;
-		}
-		else if(angle == 270)
+		else
 		{
-			py--;
+			t = tMaxY;
+			tMaxY += tDeltaY;
+			py += sy;
 		}
-		else if(angle == 315)
-		{
-			px--;
-			py--;
-		}	
+		if (t >= range)
+			return SIMIRRANGE;
 	}
-	int DL = sqrt(abs((float)px - (float)cPX)*abs((float)px - (float)cPX) + abs((float)py - (float)cPY)*abs((float)py - (float)cPY)) + 0.5;
-	return DL;
+	return((t + (1 << 13)) >> 14);
+}
+
+// Left and right sensors, which look at right angles to the heading
+int getDL(int cPX,int cPY, int angle)
+{
+	return simRayCast(cPX,cPY,angle+90);
 }
 
 int getDR(int cPX, int cPY, int angle)
 {
-	int px = cPX;
-	int py = cPY;
-	int count = 0;
-	while(isWall(px,py) == 0)
-	{
-		count++;
-		//sensors can only see 80 cm;
-		if(count == 80)
-			break;
-		if(angle == 0)
-			px++;
-		else if(angle == 45)
-		{
-			px++;
-			py--;
-		}
-		else if(angle == 90)
-		{
-			py--;
-		}
-		else if(angle == 135)
-		{
-			px--;
-			py--;
-		}
-		else if(angle == 180)
-		{
-			px--;
-		}
-		else if(angle == 225)
-		{
-			px--;
-			py++;
-		}
-		else if(angle == 270)
-		{
-			py++;
-		}
-		else if(angle == 315)
-		{
-			px++;
-			py++;
-		}	
-	}
-	int DR = sqrt(abs((float)px - (float)cPX)*abs((float)px - (float)cPX) + abs((float)py - (float)cPY)*abs((float)py - (float)cPY)) + 0.5;
-	return DR;
+	return simRayCast(cPX,cPY,angle-90);
 }
 // I2C commands for the Motor Encoder
 	uint8_t i2cCmdReadVals[]= {0xAA};
@@ -368,9 +365,9 @@ void createCourse()
 		//left wall y
 	    simLeftWall[i][1] = 240-i;
 		//right wall x
-		simRightWall[i][2] = 168;
+		simRightWall[i][0] = 168;
 		//right wall y
-		simRightWall[i][3] = 240-i;
+		simRightWall[i][1] = 240-i;
 	}
 	//create finish line
 	for(i=0;i<FINWIDTH;i++)
@@ -405,9 +402,9 @@ void createCourse()
 	for(i=0;i<10;i++)
 	{
 		//right wall x
-		simRightWall[i][2] = 175;
+		simRightWall[i][0] = 175;
 		//right wall y
-		simRightWall[i][3] = 240-i;
+		simRightWall[i][1] = 240-i;
 	}
 	for(i=10;i<30;i++)
 	{
@@ -452,9 +449,9 @@ void createCourse()
 	for(i=0;i<10;i++)
 	{
 		//left wall x
-		simLeftWall[i][2] = 145;
+		simLeftWall[i][0] = 145;
 		//left wall y
-		simLeftWall[i][3] = 240-i;
+		simLeftWall[i][1] = 240-i;
 	}
 	for(i=10;i<30;i++)
 	{
@@ -486,15 +483,15 @@ void createCourse()
 		if((i>24) && (i<75))
 		{
 			//right wall x
-			simRightWall[i][2] = 178;
+			simRightWall[i][0] = 178;
 		}
 		else
 		{
 			//right wall x
-			simRightWall[i][2] = 168;
+			simRightWall[i][0] = 168;
 		}
 		//right wall y
-		simRightWall[i][3] = 240-i;
+		simRightWall[i][1] = 240-i;
 	}
 	//create finish line
 	for(i=0;i<FINWIDTH;i++)
@@ -515,9 +512,9 @@ void createCourse()
 		//left wall y
 	    simLeftWall[i][1] = 240-i;
 		//right wall x
-		simRightWall[i][2] = 168;
+		simRightWall[i][0] = 168;
 		//right wall y
-		simRightWall[i][3] = 240-i;
+		simRightWall[i][1] = 240-i;
 	}
 	for(i=25; i<50; i++)
 	{			
@@ -526,9 +523,9 @@ void createCourse()
 		//left wall y
 	    simLeftWall[i][1] = 240-24;
 		//right wall x
-		simRightWall[i][2] = 168 + (i-25);
+		simRightWall[i][0] = 168 + (i-25);
 		//right wall y
-		simRightWall[i][3] = 240-24;
+		simRightWall[i][1] = 240-24;
 	}
 	for(i=50; i<75; i++)
 	{			
@@ -537,9 +534,9 @@ void createCourse()
 		//left wall y
 	    simLeftWall[i][1] = 240-40;
 		//right wall x
-		simRightWall[i][2] = 168 + 25 - (i-50);
+		simRightWall[i][0] = 168 + 25 - (i-50);
 		//right wall y
-		simRightWall[i][3] = 240-40;
+		simRightWall[i][1] = 240-40;
 	}
 	for(i=75; i<100; i++)
 	{			
@@ -548,9 +545,9 @@ void createCourse()
 		//left wall y
 	    simLeftWall[i][1] = 240-40-(i-75);
 		//right wall x
-		simRightWall[i][2] = 168;
+		simRightWall[i][0] = 168;
 		//right wall y
-		simRightWall[i][3] = 240-40-(i-75);
+		simRightWall[i][1] = 240-40-(i-75);
 	}
 	//create finish line
 	for(i=0;i<FINWIDTH;i++)
@@ -567,9 +564,9 @@ void createCourse()
 	for(i=0	; i<64; i++)
 	{			
 		//right wall x
-		simRightWall[i][2] = 168;
+		simRightWall[i][0] = 168;
 		//right wall y
-		simRightWall[i][3] = 240-i;
+		simRightWall[i][1] = 240-i;
 	}
 	for(i=0	; i<25; i++)
 	{			
@@ -607,6 +604,20 @@ void createCourse()
 	}
 	#endif
 
+	//draw the course into the bitmap used to look up walls
+	memset(simWorld,0,sizeof(simWorld));
+	for(i=0;i<MAXLEFT;i++)
+	{
+		simDraw(simLeftWall[i][0],simLeftWall[i][1],SIMWALL);
+	}
+	for(i=0;i<MAXRIGHT;i++)
+	{
+		simDraw(simRightWall[i][0],simRightWall[i][1],SIMWALL);
+	}
+	for(i=0;i<FINWIDTH;i++)
+	{
+		simDraw(simFinish[i][0],simFinish[i][1],SIMFINISH);
+	}
 
 	for(i=0;i<MAXLEFT;i++)
 	{
@@ -660,10 +671,8 @@ void createCourse()
 static portTASK_FUNCTION( vTestUpdateTask, pvParameters )
 {
 	// Define local constants here
-	uint8_t countStartAcc = 0;
 	uint8_t countStartMotor = 0;
 	uint8_t countDist = 0;
-	uint8_t countAcc = 0;
 	uint8_t countMotor = 0;
 
 	// Get the parameters
@@ -923,56 +932,9 @@ static portTASK_FUNCTION( vTestUpdateTask, pvParameters )
 			i2cCmdDistance[1] = countDist;
 			countDist++;
 			//Calculating carSPX (where the car will be if car goes straight 10 units)
-			//car going straight
-			if(simCar[3] == 0)
-			{
-				carSPY = simCar[1]-10;
-				carSPX = simCar[0];
-			}
-			//45 degrees left
-			else if(simCar[3] == 45)
-			{
-				//7 used when going diagonal because 7^2 + 7^2 = 98 ~=10^2 
-				carSPX = simCar[0]-7;
-				carSPY = simCar[1]-7;
-			}
-			//straight left
-			else if(simCar[3] == 90)
-			{
-				carSPX = simCar[0]-10;
-				carSPY = simCar[1];
-			}
-			//down left
-			else if(simCar[3] == 135)
-			{
-				carSPX = simCar[0]-7;
-				carSPY = simCar[1]+7;
-			}
-			//straight down
-			else if(simCar[3] == 180)
-			{
-				carSPX = simCar[0];
-				carSPY = simCar[1]+10;
-			}
-			//down right
-			else if(simCar[3] == 225)
-			{
-				carSPX = simCar[0]-7;
-				carSPY = simCar[1]+7;
-			}
-			//straight right
-			else if(simCar[3] == 270)
-			{
-				carSPX = simCar[0]+10;
-				carSPY = simCar[1];
-			}
-			//up right
-			else if(simCar[3] == 315)
-			{
-				carSPX = simCar[0]+7;
-				carSPY = simCar[1]-7;
-			}
-			
+			carSPX = simCar[0] - ((10*simSinDeg(simCar[3]) + (1 << 13)) >> 14);
+			carSPY = simCar[1] - ((10*simCosDeg(simCar[3]) + (1 << 13)) >> 14);
+
 			i2cCmdDistance[2] = getDL(carSPX,carSPY,simCar[3]);
 			i2cCmdDistance[3] = getDR(carSPX,carSPY,simCar[3]);
 			
@@ -986,8 +948,6 @@ static portTASK_FUNCTION( vTestUpdateTask, pvParameters )
 		case vtI2CMsgTypeMotorSend: {
 			
 			uint8_t msgCount = getTestCount(&msgBuffer);
-			//speed
-			uint8_t val1 = getTestVal1(&msgBuffer);
 			//turn radius see below for translation
 			uint8_t val2 = getTestVal2(&msgBuffer);
 
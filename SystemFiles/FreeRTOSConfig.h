@@ -89,6 +89,11 @@
 #define configUSE_ALTERNATIVE_API 		0
 #define configCHECK_FOR_STACK_OVERFLOW	2
 #define configUSE_RECURSIVE_MUTEXES		1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	1
+#define configSUPPORT_STATIC_ALLOCATION	1
+#define configUSE_TASK_NOTIFICATIONS	1
+#define configUSE_QUEUE_SETS			1
+#define configUSE_TIMER_WHEEL			1
 #define configQUEUE_REGISTRY_SIZE		10
 #define configGENERATE_RUN_TIME_STATS	1
 
@@ -104,6 +109,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelay					1
 #define INCLUDE_uxTaskGetStackHighWaterMark	1
 #define	INCLUDE_xTaskGetSchedulerState		1
+#define INCLUDE_xTaskGetCurrentTaskHandle	1
 
 /*-----------------------------------------------------------
  * Ethernet configuration.
@@ -158,6 +164,13 @@ extern void vConfigureTimerForRunTimeStats( void );
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() vConfigureTimerForRunTimeStats()
 #define portGET_RUN_TIME_COUNTER_VALUE() TIM0->TC
 
+/*-----------------------------------------------------------
+ * Binary kernel event trace (vtCode/vtTrace), timestamped with the run
+ * time stats clock.  Set to 0 to leave the kernel trace macros empty.
+ *-----------------------------------------------------------*/
+#define configUSE_VT_TRACE 1
+#include "vtTrace.h"
+
 
 /* The structure that is passed on the xLCDQueue.  Put here for convenience. */
 typedef struct
@@ -11,9 +11,11 @@
 .extern vPortSVCHandler
 .extern vEMAC_ISR
 .extern vtSSPIsr
+.extern vtSSPDMAIsr
 .extern vtI2C0Isr
 .extern vtI2C1Isr
 .extern vtI2C2Isr
+.extern vtSensorReadyIsr
 /*
 // <h> Stack Configuration
 //   <o> Stack Size (in Bytes) <0x0-0xFFFFFFFF:8>
@@ -104,13 +106,13 @@ __cs3_interrupt_vector_cortex_m:
     .long   RTC_IRQHandler              /* 33: Real Time Clock              */
     .long   EINT0_IRQHandler            /* 34: External Interrupt 0         */
     .long   EINT1_IRQHandler            /* 35: External Interrupt 1         */
-    .long   EINT2_IRQHandler            /* 36: External Interrupt 2         */
+    .long   vtSensorReadyIsr            /* changed from default EINT2_IRQHandler */ /* 36: External Interrupt 2         */
     .long   EINT3_IRQHandler            /* 37: External Interrupt 3         */
     .long   ADC_IRQHandler              /* 38: A/D Converter                */
     .long   BOD_IRQHandler              /* 39: Brown-Out Detect             */
     .long   USB_IRQHandler              /* 40: USB                          */
     .long   CAN_IRQHandler              /* 41: CAN                          */
-    .long   DMA_IRQHandler              /* 42: General Purpose DMA          */
+    .long   vtSSPDMAIsr					/* changed from default DMA_IRQHandler  */          /* 42: General Purpose DMA          */
     .long   I2S_IRQHandler              /* 43: I2S                          */
     .long   vEMAC_ISR					/* MTJ changed from default ENET_IRQHandler  */           /* 44: Ethernet                     */
     .long   RIT_IRQHandler              /* 45: Repetitive Interrupt Timer   */
@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "vtI2C.h"
 /* Scheduler include files. */
@@ -11,26 +12,32 @@
 /* include files. */
 #include "lpc17xx_i2c.h"
 #include "vtUtilities.h"
+#include "vtTrace.h"
 
 #include "lpc17xx_libcfg_default.h"
 #include "lpc17xx_pinsel.h"
 
 /* ************************************************ */
 // Private definitions used in the Public API
-// Structure used to define the messages that are sent to/from the I2C thread 
-typedef struct __vtI2CMsg {
-	uint8_t msgType; // A field you will likely use in your communications between processors (and for debugging)
-	uint8_t slvAddr; // Address of the device to whom the message is being sent (or was sent)
-	uint8_t	rxLen;	 // Length of the message you *expect* to receive (or, on the way back, the length that *was* received)
-	uint8_t txLen;   // Length of the message you want to sent (or, on the way back, the length that *was* sent)
-	uint8_t status;  // status of the completed operation -- I've not done anything much here, you probably should...
-	uint8_t buf[vtI2CMLen]; // On the way in, message to be sent, on the way out, message received (if any)
-} vtI2CMsg;
-// Length of the message queues to/from this task
-#define vtI2CQLen 10
+// The pool of message descriptors (vtI2CMsg, see vtI2C.h) shared by all of the I2C tasks
+//   -- The queues to/from the I2C tasks carry only pointers into this pool, so a message is written once by
+//      the sender, filled in place by the I2C task and read in place by the receiver
+//   -- Free descriptors are kept in a queue (of pointers) so that a sender blocks when the pool is empty, in
+//      the same way that it used to block when the I2C task's queue was full
+//   -- The first vtI2CUrgentReserve descriptors are only for urgent requests and have a free queue of their own
+static vtI2CMsg msgPool[vtI2CPoolSize];
+static xQueueHandle freeQ = NULL;
+static xStaticQueue freeQBuffer;
+static vtI2CMsg *freeQStorage[vtI2CPoolSize-vtI2CUrgentReserve];
+static xQueueHandle urgentFreeQ = NULL;
+static xStaticQueue urgentFreeQBuffer;
+static vtI2CMsg *urgentFreeQStorage[vtI2CUrgentReserve];
 
 #define vtI2CTransferFailed -2
 #define vtI2CIntPriority 7
+// Bits on the wire for each byte (8 data + ACK), and for the start and stop conditions of each attempt
+#define vtI2CBitsPerByte 9
+#define vtI2CFramingBits 2
 
 //Used for testing
 #define TESTSEND 0
@@ -40,15 +47,6 @@ typedef struct __vtI2CMsg {
 static 	vtI2CStruct *devStaticPtr[3];
 vtLCDStruct *lcdP;
 
-// I have set this to a large stack size because of (a) using printf() and (b) the depth of function calls
-//   for some of the I2C operations -- it is possible/very likely these are much larger than needed (see LCDtask.c for how to check the stack size)
-#define baseStack 3
-#if PRINTF_VERSION == 1
-#define i2cSTACK_SIZE		((baseStack+5)*configMINIMAL_STACK_SIZE)
-#else
-#define i2cSTACK_SIZE		(baseStack*configMINIMAL_STACK_SIZE)
-#endif
-
 /* The I2C monitor tasks. */
 static portTASK_FUNCTION_PROTO( vI2CMonitorTask, pvParameters );
 // End of private definitions
@@ -62,8 +60,17 @@ int vtI2CInit(vtI2CStruct *devPtr,uint8_t i2cDevNum,unsigned portBASE_TYPE taskP
 {
 	PINSEL_CFG_Type PinCfg;
 
+	if ((i2cSpeed < 1000) || (i2cSpeed > vtI2CFastMode)) {
+		return(vtI2CErrInit);
+	}
 	devPtr->devNum = i2cDevNum;
 	devPtr->taskPriority = taskPriority;
+	devPtr->i2cSpeed = i2cSpeed;
+	memset(&(devPtr->stats),0,sizeof(vtI2CStats));
+	memset(devPtr->slaveStats,0,sizeof(devPtr->slaveStats));
+	devPtr->numSlaves = 0;
+	devPtr->resultHandler = NULL;
+	devPtr->resultArg = NULL;
 
 	lcdP = lcd;
 	int retval = vtI2CInitSuccess;
@@ -108,32 +115,38 @@ int vtI2CInit(vtI2CStruct *devPtr,uint8_t i2cDevNum,unsigned portBASE_TYPE taskP
 		}
 	}
 
-	// Create semaphore to communicate with interrupt handler
-	vSemaphoreCreateBinary(devPtr->binSemaphore);
-	if (devPtr->binSemaphore == NULL) {
+	// The first call sets up the message pool by putting every descriptor on its free queue
+	if (freeQ == NULL) {
+		int i;
+		if ((freeQ = xQueueCreateStatic(vtI2CPoolSize-vtI2CUrgentReserve,sizeof(vtI2CMsg *),(uint8_t *) freeQStorage,&freeQBuffer)) == NULL) {
+			return(vtI2CErrInit);
+		}
+		if ((urgentFreeQ = xQueueCreateStatic(vtI2CUrgentReserve,sizeof(vtI2CMsg *),(uint8_t *) urgentFreeQStorage,&urgentFreeQBuffer)) == NULL) {
+			return(vtI2CErrInit);
+		}
+		for (i=0;i<vtI2CPoolSize;i++) {
+			vtI2CRelease(&(msgPool[i]));
+		}
+	}
+
+	// Allocate the queues to be used to communicate with other tasks (they hold pointers to pool entries)
+	//   They and the semaphore live in devPtr, so a failure leaves nothing to free
+	if ((devPtr->inQ = xQueueCreateStatic(vtI2CQLen,sizeof(vtI2CMsg *),(uint8_t *) devPtr->inQStorage,&(devPtr->inQBuffer))) == NULL) {
 		return(vtI2CErrInit);
 	}
-	// Need to do an initial "take" on the semaphore to ensure that it is initially blocked
-	if (xSemaphoreTake(devPtr->binSemaphore,0) != pdTRUE) {
-		// free up everyone and go home
-		vQueueDelete(devPtr->binSemaphore);
+	if ((devPtr->urgentQ = xQueueCreateStatic(vtI2CQLen,sizeof(vtI2CMsg *),(uint8_t *) devPtr->urgentQStorage,&(devPtr->urgentQBuffer))) == NULL) {
 		return(vtI2CErrInit);
 	}
-
-	// Allocate the two queues to be used to communicate with other tasks
-	if ((devPtr->inQ = xQueueCreate(vtI2CQLen,sizeof(vtI2CMsg))) == NULL) {
-		// free up everyone and go home
-		vQueueDelete(devPtr->binSemaphore);
+	// Semaphore used to wake the I2C task when a request is put in either queue
+	vSemaphoreCreateBinaryStatic(devPtr->workSemaphore,&(devPtr->workSemaphoreBuffer));
+	if (devPtr->workSemaphore == NULL) {
 		return(vtI2CErrInit);
 	}
-	if ((devPtr->outQ = xQueueCreate(vtI2CQLen,sizeof(vtI2CMsg))) == NULL) {
-		// free up everyone and go home
-		vQueueDelete(devPtr->binSemaphore);
-		vQueueDelete(devPtr->outQ);
+	if ((devPtr->outQ = xQueueCreateStatic(vtI2CQLen,sizeof(vtI2CMsg *),(uint8_t *) devPtr->outQStorage,&(devPtr->outQBuffer))) == NULL) {
 		return(vtI2CErrInit);
 	}
 
-	// Initialize  I2C peripheral
+	// Initialize  I2C peripheral (the NXP driver works out the SCL duty cycle for Standard or Fast mode)
 	I2C_Init(devPtr->devAddr, i2cSpeed);
 
 	// Enable  I2C operation
@@ -142,7 +155,7 @@ int vtI2CInit(vtI2CStruct *devPtr,uint8_t i2cDevNum,unsigned portBASE_TYPE taskP
 	/* Start the task */
 	char taskLabel[8];
 	sprintf(taskLabel,"I2C%d",devPtr->devNum);
-	if ((retval = xTaskCreate( vI2CMonitorTask, (signed char*) taskLabel, i2cSTACK_SIZE,(void *) devPtr, devPtr->taskPriority, ( xTaskHandle * ) NULL )) != pdPASS) {
+	if ((retval = xTaskCreateStatic( vI2CMonitorTask, (signed char*) taskLabel, vtI2CStackSize,(void *) devPtr, devPtr->taskPriority, &(devPtr->taskHandle), devPtr->stack, &(devPtr->tcb) )) != pdPASS) {
 		VT_HANDLE_FATAL_ERROR(retval);
 		return(vtI2CErrInit); // return is just to keep the compiler happy, we will never get here
 	} else {
@@ -150,81 +163,261 @@ int vtI2CInit(vtI2CStruct *devPtr,uint8_t i2cDevNum,unsigned portBASE_TYPE taskP
 	}
 }
 
-// A simple routine to use for filling out and sending a message to the I2C thread
-//   You may want to make your own versions of these as they are not suited to all purposes
-portBASE_TYPE vtI2CEnQ(vtI2CStruct *dev,uint8_t msgType,uint8_t slvAddr,uint8_t txLen,const uint8_t *txBuf,uint8_t rxLen)
+// Take a descriptor from the pool and fill it in -- blocks if the pool is empty
+//   An urgent request tries the reserve, then the shared pool, and if both are empty waits for the reserve, which
+//   only other urgent requests can be holding
+static vtI2CMsg *vtI2CFill(uint8_t prio,uint8_t msgType,uint8_t slvAddr,uint8_t txLen,const uint8_t *txBuf,uint8_t rxLen)
 {
-	vtI2CMsg msgBuf;
-	int i;
+	vtI2CMsg *msgPtr;
 
-    msgBuf.slvAddr = slvAddr;
-	msgBuf.msgType = msgType;
-	msgBuf.rxLen = rxLen;
-	if (msgBuf.rxLen > vtI2CMLen) {
+	if (rxLen > vtI2CMLen) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
-	msgBuf.txLen = txLen;
-	if (msgBuf.txLen > vtI2CMLen) {
+	if (txLen > vtI2CMLen) {
 		VT_HANDLE_FATAL_ERROR(0);
 	}
-	for (i=0;i<msgBuf.txLen;i++) {
-		msgBuf.buf[i] = txBuf[i];
+	if (prio == vtI2CPrioUrgent) {
+		if ((xQueueReceive(urgentFreeQ,(void *) (&msgPtr),0) != pdTRUE) &&
+			(xQueueReceive(freeQ,(void *) (&msgPtr),0) != pdTRUE) &&
+			(xQueueReceive(urgentFreeQ,(void *) (&msgPtr),portMAX_DELAY) != pdTRUE)) {
+			VT_HANDLE_FATAL_ERROR(0);
+		}
+	} else if (xQueueReceive(freeQ,(void *) (&msgPtr),portMAX_DELAY) != pdTRUE) {
+		VT_HANDLE_FATAL_ERROR(0);
 	}
-	return(xQueueSend(dev->inQ,(void *) (&msgBuf),portMAX_DELAY));
+	msgPtr->slvAddr = slvAddr;
+	msgPtr->msgType = msgType;
+	msgPtr->rxLen = rxLen;
+	msgPtr->txLen = txLen;
+	msgPtr->next = NULL;
+	msgPtr->queuedAt = xTaskGetTickCount();
+	msgPtr->maxWait = vtI2CNoDeadline;
+	memcpy(msgPtr->buf,txBuf,txLen);
+	return(msgPtr);
 }
 
-// A simple routine to use for filling out and sending a message to the Conductor
-portBASE_TYPE vtI2CConQ(vtI2CStruct *dev,uint8_t msgType,uint8_t slvAddr,uint8_t txLen,const uint8_t *txBuf,uint8_t rxLen)
+// Hand a request (or the first message of a batch) to the I2C thread
+static portBASE_TYPE vtI2CSubmit(vtI2CStruct *dev,uint8_t prio,portTickType maxWait,vtI2CMsg *msgPtr)
+{
+	portBASE_TYPE retval;
+
+	msgPtr->maxWait = maxWait;
+	retval = xQueueSend((prio == vtI2CPrioUrgent) ? dev->urgentQ : dev->inQ,(void *) (&msgPtr),portMAX_DELAY);
+	xSemaphoreGive(dev->workSemaphore);
+	return(retval);
+}
+
+// A simple routine to use for filling out and sending a message to the I2C thread
+//   You may want to make your own versions of these as they are not suited to all purposes
+portBASE_TYPE vtI2CEnQ(vtI2CStruct *dev,uint8_t msgType,uint8_t slvAddr,uint8_t txLen,const uint8_t *txBuf,uint8_t rxLen)
 {
-	vtI2CMsg msgBuf;
+	return(vtI2CEnQPrio(dev,vtI2CPrioNormal,vtI2CNoDeadline,msgType,slvAddr,txLen,txBuf,rxLen));
+}
+
+// Same as vtI2CEnQ(), with a priority class and a deadline
+portBASE_TYPE vtI2CEnQPrio(vtI2CStruct *dev,uint8_t prio,portTickType maxWait,uint8_t msgType,uint8_t slvAddr,uint8_t txLen,const uint8_t *txBuf,uint8_t rxLen)
+{
+	return(vtI2CSubmit(dev,prio,maxWait,vtI2CFill(prio,msgType,slvAddr,txLen,txBuf,rxLen)));
+}
+
+// Queue a batch of transfers that the I2C thread runs back-to-back with a single wake up at the end
+portBASE_TYPE vtI2CBatchEnQ(vtI2CStruct *dev,uint8_t prio,portTickType maxWait,uint8_t msgType,uint8_t numOps,const vtI2CBatchOp *ops)
+{
+	vtI2CMsg *head = NULL;
+	vtI2CMsg *tail = NULL;
+	vtI2CMsg *msgPtr;
 	int i;
 
-    msgBuf.slvAddr = slvAddr;
-	msgBuf.msgType = msgType;
-	msgBuf.rxLen = rxLen;
-	if (msgBuf.rxLen > vtI2CMLen) {
-		VT_HANDLE_FATAL_ERROR(0);
+	if ((numOps == 0) || (numOps > vtI2CMaxBatch)) {
+		VT_HANDLE_FATAL_ERROR(numOps);
 	}
-	msgBuf.txLen = txLen;
-	if (msgBuf.txLen > vtI2CMLen) {
-		VT_HANDLE_FATAL_ERROR(0);
+	for (i=0;i<numOps;i++) {
+		msgPtr = vtI2CFill(vtI2CPrioNormal,msgType,ops[i].slvAddr,ops[i].txLen,ops[i].txBuf,ops[i].rxLen);
+		if (head == NULL) {
+			head = msgPtr;
+		} else {
+			tail->next = msgPtr;
+		}
+		tail = msgPtr;
 	}
-	for (i=0;i<msgBuf.txLen;i++) {
-		msgBuf.buf[i] = txBuf[i];
+	return(vtI2CSubmit(dev,prio,maxWait,head));
+}
+
+// A simple routine to use for filling out and sending a message to the Conductor
+portBASE_TYPE vtI2CConQ(vtI2CStruct *dev,uint8_t msgType,uint8_t slvAddr,uint8_t txLen,const uint8_t *txBuf,uint8_t rxLen)
+{
+	vtI2CMsg *msgPtr = vtI2CFill(vtI2CPrioNormal,msgType,slvAddr,txLen,txBuf,rxLen);
+
+	if (dev->resultHandler != NULL) {
+		dev->resultHandler(dev->resultArg,msgPtr);
+		vtI2CRelease(msgPtr);
+		return(pdTRUE);
 	}
-	return(xQueueSend(dev->outQ,(void *) (&msgBuf),portMAX_DELAY));
+	return(xQueueSend(dev->outQ,(void *) (&msgPtr),portMAX_DELAY));
 }
 
 // A simple routine to use for retrieving a message from the I2C thread
 portBASE_TYPE vtI2CDeQ(vtI2CStruct *dev,uint8_t maxRxLen,uint8_t *rxBuf,uint8_t *rxLen,uint8_t *msgType,uint8_t *status)
 {
-	vtI2CMsg msgBuf;
-	int i;
+	vtI2CMsg *msgPtr;
+	uint8_t len;
 
-	if (xQueueReceive(dev->outQ,(void *) (&msgBuf),portMAX_DELAY) != pdTRUE) {
+	if (vtI2CDeQRef(dev,&msgPtr) != pdTRUE) {
 		return(pdFALSE);
 	}
-	(*status) = msgBuf.status;
-	(*rxLen) = msgBuf.rxLen;
-	if (msgBuf.rxLen > maxRxLen) msgBuf.rxLen = maxRxLen;
-	for (i=0;i<msgBuf.rxLen;i++) {
-		rxBuf[i] = msgBuf.buf[i];
-	}
-	(*msgType) = msgBuf.msgType;	
+	(*status) = msgPtr->status;
+	(*rxLen) = msgPtr->rxLen;
+	len = msgPtr->rxLen;
+	if (len > maxRxLen) len = maxRxLen;
+	memcpy(rxBuf,msgPtr->buf,len);
+	(*msgType) = msgPtr->msgType;
+	vtI2CRelease(msgPtr);
 
 	return(pdTRUE);
 }
 
+// Retrieve a message from the I2C thread without copying it
+portBASE_TYPE vtI2CDeQRef(vtI2CStruct *dev,vtI2CMsg **msgPtr)
+{
+	return(xQueueReceive(dev->outQ,(void *) msgPtr,portMAX_DELAY));
+}
+
+// Give a message obtained from vtI2CDeQRef() back to the pool
+void vtI2CRelease(vtI2CMsg *msgPtr)
+{
+	// back to the free queue it came from
+	xQueueHandle q = (msgPtr < &(msgPool[vtI2CUrgentReserve])) ? urgentFreeQ : freeQ;
+
+	if (xQueueSend(q,(void *) (&msgPtr),0) != pdTRUE) {
+		// more messages released than there are in the pool -- one was released twice
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+}
+
+// Have the I2C thread pass each result to a function rather than queue it
+void vtI2CSetResultHandler(vtI2CStruct *dev,vtI2CResultHandler handler,void *arg)
+{
+	dev->resultHandler = handler;
+	dev->resultArg = arg;
+}
+
+// Take a copy of the bus counters
+void vtI2CGetStats(vtI2CStruct *dev,vtI2CStats *stats)
+{
+	// The interrupt handler updates the counters, so make sure they are not copied half way through an update
+	portENTER_CRITICAL();
+	(*stats) = dev->stats;
+	portEXIT_CRITICAL();
+}
+
+// Take a copy of the counters for each slave device
+int vtI2CGetSlaveStats(vtI2CStruct *dev,vtI2CSlaveStats *slaves,int maxSlaves)
+{
+	int i;
+
+	portENTER_CRITICAL();
+	for (i=0;(i<dev->numSlaves) && (i<maxSlaves);i++) {
+		slaves[i] = dev->slaveStats[i];
+	}
+	portEXIT_CRITICAL();
+	return(i);
+}
+
 // End of public API Functions
 /* ************************************************ */
 
+// Set up and start the transfer for the message at devPtr->curMsg -- called from the task and, for the rest of a batch, from the interrupt handler
+// The reply is received straight into the message buffer -- all of the bytes to be sent have gone
+//   out on the bus before the first byte is received, so it is safe to reuse the buffer
+static void vtI2CStartTransfer(vtI2CStruct *devPtr)
+{
+	vtI2CMsg *msgPtr = devPtr->curMsg;
+	I2C_M_SETUP_Type *cfg = &(devPtr->transferCfg);
+
+	cfg->sl_addr7bit = msgPtr->slvAddr;
+	cfg->tx_data = msgPtr->buf;
+	cfg->tx_length = msgPtr->txLen;
+	cfg->rx_data = msgPtr->buf;
+	cfg->rx_length = msgPtr->rxLen;
+	cfg->retransmissions_max = 3;
+	cfg->retransmissions_count = 0;	 // this *should* be initialized in the LPC code, but is not for interrupt mode
+	msgPtr->status = I2C_MasterTransferData(devPtr->devAddr, cfg, I2C_TRANSFER_INTERRUPT);
+}
+
+// The counters for a slave address, or NULL once vtI2CMaxSlaves addresses have been seen
+//   Only called by the I2C task and its interrupt handler, which never run at the same time for one bus
+static vtI2CStats *vtI2CSlaveCounters(vtI2CStruct *devPtr,uint8_t slvAddr)
+{
+	int i;
+
+	for (i=0;i<devPtr->numSlaves;i++) {
+		if (devPtr->slaveStats[i].slvAddr == slvAddr) {
+			return(&(devPtr->slaveStats[i].stats));
+		}
+	}
+	if (devPtr->numSlaves == vtI2CMaxSlaves) {
+		return(NULL);
+	}
+	devPtr->slaveStats[i].slvAddr = slvAddr;
+	devPtr->numSlaves++;
+	return(&(devPtr->slaveStats[i].stats));
+}
+
+// Add a finished transfer to a set of counters
+static void vtI2CAddTransfer(vtI2CStats *stats,unsigned long bytes,unsigned long retransmissions,int nacked,unsigned long busy)
+{
+	stats->transactions++;
+	stats->bytes += bytes;
+	stats->retransmissions += retransmissions;
+	if (nacked) {
+		stats->nacks++;
+	}
+	stats->busyMicroseconds += busy;
+}
+
+// Add a finished transfer to the bus counters and those of its slave -- called from the interrupt handler
+//   Each attempt sends an address byte for the write and for the read parts of the transfer; the NXP driver only
+//   counts the data bytes that got through on the last attempt, so the bytes lost to a failed attempt are not counted
+static void vtI2CCount(vtI2CStruct *devPtr)
+{
+	I2C_M_SETUP_Type *cfg = &(devPtr->transferCfg);
+	unsigned long attempts = cfg->retransmissions_count + 1;
+	unsigned long bytes = cfg->tx_count + cfg->rx_count;
+	unsigned long busy;
+	int nacked = (cfg->status & I2C_SETUP_STATUS_NOACKF) != 0;
+	vtI2CStats *slave;
+
+	if (cfg->tx_length > 0) bytes += attempts;
+	if (cfg->rx_length > 0) bytes += attempts;
+	// kept in 32 bits: 1000 times the bits in a transfer, then divided by the clock in kHz
+	busy = ((bytes*vtI2CBitsPerByte + attempts*vtI2CFramingBits)*1000UL)/(devPtr->i2cSpeed/1000UL);
+	vtI2CAddTransfer(&(devPtr->stats),bytes,cfg->retransmissions_count,nacked,busy);
+	if ((slave = vtI2CSlaveCounters(devPtr,cfg->sl_addr7bit)) != NULL) {
+		vtI2CAddTransfer(slave,bytes,cfg->retransmissions_count,nacked,busy);
+	}
+}
+
 // i2c interrupt handler
-static __INLINE void vtI2CIsr(LPC_I2C_TypeDef *devAddr,xSemaphoreHandle *binSemaphore) {
-	I2C_MasterHandler(devAddr);
-	if (I2C_MasterTransferComplete(devAddr)) {
+static __INLINE void vtI2CIsr(vtI2CStruct *devPtr) {
+	I2C_MasterHandler(devPtr->devAddr);
+	if (I2C_MasterTransferComplete(devPtr->devAddr)) {
+		vtI2CMsg *msgPtr = devPtr->curMsg;
+		// Record what happened on the bus
+		msgPtr->txLen = devPtr->transferCfg.tx_count;
+		msgPtr->rxLen = devPtr->transferCfg.rx_count;
+		msgPtr->msgType = msgPtr->buf[0];
+		// In interrupt mode the driver only says whether the transfer started, so fill in how it ended
+		msgPtr->status = (devPtr->transferCfg.status & I2C_SETUP_STATUS_DONE) ? SUCCESS : ERROR;
+		vtI2CCount(devPtr);
+		// If this is part of a batch, go straight on to the next transfer without waking the task
+		if (msgPtr->next != NULL) {
+			devPtr->curMsg = msgPtr->next;
+			vtI2CStartTransfer(devPtr);
+			return;
+		}
 		static signed portBASE_TYPE xHigherPriorityTaskWoken;
 		xHigherPriorityTaskWoken = pdFALSE;
-		xSemaphoreGiveFromISR(*binSemaphore,&xHigherPriorityTaskWoken);
+		vTaskNotifyGiveFromISR(devPtr->taskHandle,&xHigherPriorityTaskWoken);
 		portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 	}
 }
@@ -232,74 +425,105 @@ static __INLINE void vtI2CIsr(LPC_I2C_TypeDef *devAddr,xSemaphoreHandle *binSema
 void vtI2C0Isr(void) {
 	// Log the I2C status code
 	vtITMu8(vtITMPortI2C0IntHandler,((devStaticPtr[0]->devAddr)->I2STAT & I2C_STAT_CODE_BITMASK));
-	vtI2CIsr(devStaticPtr[0]->devAddr,&(devStaticPtr[0]->binSemaphore));
+	vtTraceIsrEnter(vtTraceIsrI2C0);
+	vtI2CIsr(devStaticPtr[0]);
+	vtTraceIsrExit(vtTraceIsrI2C0);
 }
 
 // Simply pass on the information to the real interrupt handler above (have to do this to work for multiple i2c peripheral units on the LPC1768
 void vtI2C1Isr(void) {
 	// Log the I2C status code
 	vtITMu8(vtITMPortI2C1IntHandler,((devStaticPtr[1]->devAddr)->I2STAT & I2C_STAT_CODE_BITMASK));
-	vtI2CIsr(devStaticPtr[1]->devAddr,&(devStaticPtr[1]->binSemaphore));
+	vtTraceIsrEnter(vtTraceIsrI2C1);
+	vtI2CIsr(devStaticPtr[1]);
+	vtTraceIsrExit(vtTraceIsrI2C1);
 }
 // Simply pass on the information to the real interrupt handler above (have to do this to work for multiple i2c peripheral units on the LPC1768
 void vtI2C2Isr(void) {
-	vtI2CIsr(devStaticPtr[2]->devAddr,&(devStaticPtr[2]->binSemaphore));
+	vtTraceIsrEnter(vtTraceIsrI2C2);
+	vtI2CIsr(devStaticPtr[2]);
+	vtTraceIsrExit(vtTraceIsrI2C2);
 }
 
 
+// Wait for the next request to put on the bus
+//   Urgent requests always go first, so they wait for at most the request (or batch) already on the bus
+//   A request that has waited longer than its deadline is dropped -- it is given back to the pool unsent
+static vtI2CMsg *vtI2CNextRequest(vtI2CStruct *devPtr)
+{
+	vtI2CMsg *msgPtr;
+	vtI2CMsg *nextPtr;
+	vtI2CStats *slave;
+
+	for (;;) {
+		if ((xQueueReceive(devPtr->urgentQ,(void *) &msgPtr,0) == pdTRUE) ||
+			(xQueueReceive(devPtr->inQ,(void *) &msgPtr,0) == pdTRUE)) {
+			if ((msgPtr->maxWait == vtI2CNoDeadline) || ((xTaskGetTickCount() - msgPtr->queuedAt) <= msgPtr->maxWait)) {
+				return(msgPtr);
+			}
+			while (msgPtr != NULL) {
+				nextPtr = msgPtr->next;
+				msgPtr->next = NULL;
+				devPtr->stats.dropped++;
+				if ((slave = vtI2CSlaveCounters(devPtr,msgPtr->slvAddr)) != NULL) {
+					slave->dropped++;
+				}
+				vtI2CRelease(msgPtr);
+				msgPtr = nextPtr;
+			}
+		} else {
+			// Both queues are empty; the senders give this after every request, so nothing can be missed
+			if (xSemaphoreTake(devPtr->workSemaphore,portMAX_DELAY) != pdTRUE) {
+				VT_HANDLE_FATAL_ERROR(0);
+			}
+		}
+	}
+}
+
 // This is the actual task that is run
 static portTASK_FUNCTION( vI2CMonitorTask, pvParameters )
 {
 	// Get the i2c structure for this task/device
 	vtI2CStruct *devPtr = (vtI2CStruct *) pvParameters;
-	vtI2CMsg msgBuffer;
-	uint8_t tmpRxBuf[vtI2CMLen];
-	I2C_M_SETUP_Type transferMCfg;
-	int i;
+	vtI2CMsg *msgPtr;
+	vtI2CMsg *nextPtr;
 
 	for (;;) {
 		// wait for a message from another task telling us to send/recv over i2c
-		if (xQueueReceive(devPtr->inQ,(void *) &msgBuffer,portMAX_DELAY) != pdTRUE) {
-			VT_HANDLE_FATAL_ERROR(0);
-		}
+		msgPtr = vtI2CNextRequest(devPtr);
 		//Log that we are processing a message
-		vtITMu8(vtITMPortI2CMsg,msgBuffer.msgType);
-
-		// process the messsage and perform the I2C transaction
-		transferMCfg.sl_addr7bit = msgBuffer.slvAddr;
-		transferMCfg.tx_data = msgBuffer.buf;
-		transferMCfg.tx_length = msgBuffer.txLen;
-		transferMCfg.rx_data = tmpRxBuf;
-		transferMCfg.rx_length = msgBuffer.rxLen;
-		transferMCfg.retransmissions_max = 3;
-		transferMCfg.retransmissions_count = 0;	 // this *should* be initialized in the LPC code, but is not for interrupt mode
-		msgBuffer.status = I2C_MasterTransferData(devPtr->devAddr, &transferMCfg, I2C_TRANSFER_INTERRUPT);
+		vtITMu8(vtITMPortI2CMsg,msgPtr->msgType);
+
+		// process the messsage and perform the I2C transaction(s) -- a batch is run back-to-back by the interrupt handler
+		devPtr->curMsg = msgPtr;
+		vtI2CStartTransfer(devPtr);
 		// Block until the I2C operation is complete -- we *cannot* overlap operations on the I2C bus...
-		if (xSemaphoreTake(devPtr->binSemaphore,portMAX_DELAY) != pdTRUE) {
+		if (ulTaskNotifyTake(pdTRUE,portMAX_DELAY) == 0) {
 			// something went wrong 
 			VT_HANDLE_FATAL_ERROR(0);
 		}
-		//check here
-		msgBuffer.txLen = transferMCfg.tx_count;
-		msgBuffer.rxLen = transferMCfg.rx_count;
-		// Now send out a message with the data that was read
-		// First, copy over the buffer that was received (if any)
-		for (i=0;i<msgBuffer.rxLen;i++) {
-			msgBuffer.buf[i] = tmpRxBuf[i];
-		}
-		msgBuffer.msgType = msgBuffer.buf[0];
 		/*char lcdBuffer[vtLCDMaxLen+1];
-		sprintf(lcdBuffer,"%d:%d:%d:%d",msgBuffer.msgType,msgBuffer.buf[1],msgBuffer.buf[2],msgBuffer.buf[3]);
+		sprintf(lcdBuffer,"%d:%d:%d:%d",msgPtr->msgType,msgPtr->buf[1],msgPtr->buf[2],msgPtr->buf[3]);
 		if (lcdP != NULL) {
 			if (SendLCDPrintMsg(lcdP,strnlen(lcdBuffer,vtLCDMaxLen),lcdBuffer,8,portMAX_DELAY) != pdTRUE) {
 				VT_HANDLE_FATAL_ERROR(0);
 			}
 		}*/
 
-		// now put a message in the message queue
-		if (xQueueSend(devPtr->outQ,(void*)(&msgBuffer),portMAX_DELAY) != pdTRUE) {
-			// something went wrong 
-			VT_HANDLE_FATAL_ERROR(0);
-		} 
+		// now put the message(s) in the message queue, in the order they went over the bus
+		//   (the receiver may release a message as soon as it has it, so pick up the link first)
+		while (msgPtr != NULL) {
+			nextPtr = msgPtr->next;
+			msgPtr->next = NULL;
+			if (devPtr->resultHandler != NULL) {
+				// handed straight on -- no queue and no task switch
+				devPtr->resultHandler(devPtr->resultArg,msgPtr);
+				vtI2CRelease(msgPtr);
+			} else if (xQueueSend(devPtr->outQ,(void*)(&msgPtr),portMAX_DELAY) != pdTRUE) {
+				// something went wrong 
+				VT_HANDLE_FATAL_ERROR(0);
+			}
+			msgPtr = nextPtr;
+		}
 	}
-}
\ No newline at end of file
+}
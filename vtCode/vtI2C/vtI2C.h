@@ -4,7 +4,8 @@
 #include "lpc17xx_i2c.h"
 #include "vtUtilities.h"
 #include "FreeRTOS.h"
-#include "projDefs.h"
+#include "projdefs.h"
+#include "task.h"
 #include "semphr.h"
 #include "lcdTask.h"
 
@@ -12,9 +13,85 @@
 #define vtI2CErrInit -1
 #define vtI2CInitSuccess 0
 
+// Bus clock speeds for vtI2CInit()
+//   Fast-mode needs an asymmetric SCL duty cycle, which the NXP driver sets up for any speed above Standard-mode
+#define vtI2CStandardMode I2C_STANDARD_MODE_CLOCK
+#define vtI2CFastMode I2C_FAST_MODE_CLOCK
+
 // The maximum length of a message to be sent/received over I2C 
 #define vtI2CMLen 64
+// Number of messages that can be in flight (queued, on the bus, or held by a receiver) across all I2C tasks
+#define vtI2CPoolSize 16
+// How many of those are kept for single urgent requests (see vtI2CEnQPrio()) -- normal requests and batches share
+//   the rest of the pool and never take these
+#define vtI2CUrgentReserve 2
+// Largest number of transfers in one batch (see vtI2CBatchEnQ())
+//   A batch takes its descriptors one at a time and waits in vtI2CFill() for any that other tasks are holding, so
+//   building one can take as long as those tasks keep them.  Keeping a batch to half of the shared part of the pool
+//   means that two batches built at the same time can both be finished, rather than each holding part of what the
+//   other needs.
+#define vtI2CMaxBatch ((vtI2CPoolSize-vtI2CUrgentReserve)/2)
+// Length of the message queues to/from each I2C task -- a queue can never hold more messages than are in the pool
+#define vtI2CQLen vtI2CPoolSize
+// Stack of each I2C task (words).  I have set this to a large stack size because of (a) using printf() and (b) the
+//   depth of function calls for some of the I2C operations -- it is possible/very likely these are much larger than
+//   needed (see LCDtask.c for how to check the stack size)
+#define vtI2CBaseStack 3
+#if PRINTF_VERSION == 1
+#define vtI2CStackSize ((vtI2CBaseStack+5)*configMINIMAL_STACK_SIZE)
+#else
+#define vtI2CStackSize (vtI2CBaseStack*configMINIMAL_STACK_SIZE)
+#endif
+
+// Structure used to define the messages that are sent to/from the I2C thread
+//   Messages live in a fixed pool inside vtI2C.c; the queues to and from the I2C thread only carry pointers to them
+typedef struct __vtI2CMsg {
+	uint8_t msgType; // A field you will likely use in your communications between processors (and for debugging)
+	uint8_t slvAddr; // Address of the device to whom the message is being sent (or was sent)
+	uint8_t	rxLen;	 // Length of the message you *expect* to receive (or, on the way back, the length that *was* received)
+	uint8_t txLen;   // Length of the message you want to sent (or, on the way back, the length that *was* sent)
+	uint8_t status;  // status of the completed operation -- SUCCESS, or ERROR if the slave did not answer after the retries
+	uint8_t buf[vtI2CMLen]; // On the way in, message to be sent, on the way out, message received (if any)
+	struct __vtI2CMsg *next; // Next transfer of a batch (only used inside vtI2C.c; NULL once a message has been received)
+	portTickType queuedAt;	 // When the message was queued (only used inside vtI2C.c)
+	portTickType maxWait;	 // How long the message may wait to go on the bus (only used inside vtI2C.c)
+} vtI2CMsg;
+
+// Priority classes for requests to the I2C thread (see vtI2CEnQPrio())
+#define vtI2CPrioNormal 0
+#define vtI2CPrioUrgent 1
+// Deadline value for a request that is never dropped
+#define vtI2CNoDeadline 0
 
+// One transfer of a batch (see vtI2CBatchEnQ())
+typedef struct __vtI2CBatchOp {
+	uint8_t slvAddr;		// Address of the i2c slave device
+	uint8_t txLen;			// The number of bytes to send
+	const uint8_t *txBuf;	// The bytes to send
+	uint8_t rxLen;			// The number of bytes to receive
+} vtI2CBatchOp;
+
+// Counters kept for each I2C peripheral (see vtI2CGetStats()), and for each slave device on it (see vtI2CGetSlaveStats())
+typedef struct __vtI2CStats {
+	unsigned long transactions;		// transfers completed (successfully or not)
+	unsigned long bytes;			// address and data bytes put on the bus, including retries
+	unsigned long nacks;			// transfers that ended with a NACK from the slave
+	unsigned long retransmissions;	// restarts done by the NXP driver after a NACK or lost arbitration
+	unsigned long busyMicroseconds;	// time the bus was busy, worked out from the bytes moved and the clock speed
+	unsigned long dropped;			// requests dropped because they missed their deadline
+} vtI2CStats;
+
+// Most slave devices counted separately on one bus -- transfers to any more are only in the bus totals
+#define vtI2CMaxSlaves 8
+// The counters for one slave device
+typedef struct __vtI2CSlaveStats {
+	uint8_t slvAddr;				// 7-bit address of the slave
+	vtI2CStats stats;				// its share of the bus counters
+} vtI2CSlaveStats;
+
+// Function called by the I2C thread with each result when set with vtI2CSetResultHandler()
+//   The message is only valid during the call -- it goes back to the pool as soon as the handler returns
+typedef void (*vtI2CResultHandler)(void *arg,const vtI2CMsg *msgPtr);
 // Structure that is used to define the operate of an I2C peripheral using the vtI2C routines
 //   It should be initialized by vtI2CInit() and then not changed by anything... ever
 //   A user of the API should never change or access it, it should only pass it as a parameter
@@ -22,9 +99,27 @@ typedef struct __vtI2CStruct {
 	uint8_t devNum;	  						// Number of the I2C peripheral (0,1,2 on the 1768)
 	LPC_I2C_TypeDef *devAddr;	 			// Memory address of the I2C peripheral
 	unsigned portBASE_TYPE taskPriority;   	// Priority of the I2C task
-	xSemaphoreHandle binSemaphore;		   	// Semaphore used between I2C task and I2C interrupt handler
+	xTaskHandle taskHandle;					// The I2C task -- notified by the interrupt handler when a transfer (or batch) is done
 	xQueueHandle inQ;					   	// Queue used to send messages from other tasks to the I2C task
+	xQueueHandle urgentQ;					// Same as inQ, for urgent messages (always taken before inQ)
+	xSemaphoreHandle workSemaphore;			// Given whenever a message is put in inQ or urgentQ
 	xQueueHandle outQ;						// Queue used by the I2C task to send out results
+	vtI2CMsg *curMsg;						// Message on the bus (shared with the interrupt handler)
+	I2C_M_SETUP_Type transferCfg;			// Transfer set up for curMsg (shared with the interrupt handler)
+	uint32_t i2cSpeed;						// Bus clock speed (Hz)
+	vtI2CStats stats;						// Bus counters (updated by the interrupt handler, read with vtI2CGetStats())
+	vtI2CSlaveStats slaveStats[vtI2CMaxSlaves];	// The same for each slave address, in the order they were first used
+	uint8_t numSlaves;						// Entries of slaveStats in use
+	vtI2CResultHandler resultHandler;		// If not NULL, results go to this function instead of outQ
+	void *resultArg;						// Passed to resultHandler
+	// Memory for the task, its queues and its semaphore, so none of them come from the heap
+	portSTACK_TYPE stack[vtI2CStackSize];
+	xStaticTask tcb;
+	xStaticSemaphore workSemaphoreBuffer;
+	xStaticQueue inQBuffer, urgentQBuffer, outQBuffer;
+	vtI2CMsg *inQStorage[vtI2CQLen];
+	vtI2CMsg *urgentQStorage[vtI2CQLen];
+	vtI2CMsg *outQStorage[vtI2CQLen];
 } vtI2CStruct;
 
 /* ********************************************************************* */
@@ -34,7 +129,7 @@ typedef struct __vtI2CStruct {
 //   dev: pointer to the vtI2CStruct data structure
 //   i2cDevNum: The number of the i2c device -- 0, 1, or 2
 //   taskPriority: At what priority should this task be run?
-//   i2cSpeed: Clock speed of the i2c bus
+//   i2cSpeed: Clock speed of the i2c bus -- up to vtI2CFastMode (usually vtI2CStandardMode or vtI2CFastMode)
 // Return:
 //   if successful, returns vtI2CInitSuccess
 //   if not, should return vtI2CErrInit
@@ -54,7 +149,40 @@ int vtI2CInit(vtI2CStruct *devPtr,uint8_t i2cDevNum,unsigned portBASE_TYPE taskP
 //   Result of the call to xQueueSend()
 portBASE_TYPE vtI2CEnQ(vtI2CStruct *dev,uint8_t msgType,uint8_t slvAddr,uint8_t txLen,const uint8_t *txBuf,uint8_t rxLen);
 
+// Same as vtI2CEnQ(), with a priority class and a deadline
+//   Urgent requests are put on the bus ahead of all normal ones, so an urgent request waits for at most the
+//   request already on the bus (and any urgent requests ahead of it).  An urgent request takes its descriptor
+//   from the vtI2CUrgentReserve kept for it, or from the shared pool if the reserve is in use, and only waits for
+//   one when both are empty -- then for the reserve, which only urgent requests hold, so a burst of normal
+//   requests cannot hold it up.  A request that has not reached the bus within maxWait ticks of being queued is
+//   dropped and no reply comes out of the I2C thread for it.
+// Args
+//   dev: pointer to the vtI2CStruct data structure
+//   prio: vtI2CPrioNormal or vtI2CPrioUrgent
+//   maxWait: The deadline in ticks, or vtI2CNoDeadline
+//   (the rest are the same as for vtI2CEnQ())
+// Return:
+//   Result of the call to xQueueSend()
+portBASE_TYPE vtI2CEnQPrio(vtI2CStruct *dev,uint8_t prio,portTickType maxWait,uint8_t msgType,uint8_t slvAddr,uint8_t txLen,const uint8_t *txBuf,uint8_t rxLen);
+
+// Queue a batch of transfers to be run back-to-back
+//   The interrupt handler starts each transfer as soon as the one before it is complete, and the I2C thread only
+//   wakes up once the whole batch is done.  The results come out of the I2C thread as separate messages, in
+//   order, exactly as if each transfer had been queued with vtI2CEnQ().  Whatever its priority, a batch takes its
+//   descriptors from the shared pool (the urgent reserve is only for single requests).
+// Args
+//   dev: pointer to the vtI2CStruct data structure
+//   prio: vtI2CPrioNormal or vtI2CPrioUrgent (see vtI2CEnQPrio())
+//   maxWait: The deadline in ticks for the whole batch, or vtI2CNoDeadline
+//   msgType: The message type value used for every transfer in the batch
+//   numOps: The number of transfers (1 to vtI2CMaxBatch)
+//   ops: The transfers
+// Return:
+//   Result of the call to xQueueSend()
+portBASE_TYPE vtI2CBatchEnQ(vtI2CStruct *dev,uint8_t prio,portTickType maxWait,uint8_t msgType,uint8_t numOps,const vtI2CBatchOp *ops);
+
 // A simple routine to use for filling out and sending a message to the Conductor thread
+//   If a result handler has been set, the message is passed to it straight away (in the caller's task)
 // Args
 //   dev: pointer to the vtI2CStruct data structure
 //   msgType: The message type value -- does not get sent on the wire, but is included in the response in the message queue
@@ -73,8 +201,46 @@ portBASE_TYPE vtI2CConQ(vtI2CStruct *dev,uint8_t msgType,uint8_t slvAddr,uint8_t
 //   rxBuf: The buffer that you are providing into which the message will be copied
 //   rxLen: The number of bytes that were actually received
 //   msgType: The message type value -- does not get sent/received on the wire, but is included in the response in the message queue
-//   status: Return code of the operation (you will need to dive into the code to understand the status values)
+//   status: Return code of the operation -- SUCCESS, or ERROR if the slave did not answer after the retries
 // Return:
 //   Result of the call to xQueueReceive()
 portBASE_TYPE vtI2CDeQ(vtI2CStruct *dev,uint8_t maxRxLen,uint8_t *rxBuf,uint8_t *rxLen,uint8_t *msgType,uint8_t *status);
+
+// Retrieve a message from the I2C thread without copying it
+//   The caller owns the message until it hands it back with vtI2CRelease() -- and must do so, or the pool runs dry
+// Args
+//   dev: pointer to the vtI2CStruct data structure
+//   msgPtr: set to point at the message (msgType, rxLen, status and buf are valid)
+// Return:
+//   Result of the call to xQueueReceive()
+portBASE_TYPE vtI2CDeQRef(vtI2CStruct *dev,vtI2CMsg **msgPtr);
+
+// Give a message obtained with vtI2CDeQRef() back to the pool
+// Args
+//   msgPtr: the message -- it must not be used after this call
+void vtI2CRelease(vtI2CMsg *msgPtr);
+
+// Have the I2C thread pass each result to a function rather than queue it for vtI2CDeQ()/vtI2CDeQRef()
+//   This saves a task switch per result when all that the receiver does is forward it -- the handler runs in the
+//   I2C thread, so anything that it blocks on holds up the bus
+//   Must be called before the scheduler is started
+// Args
+//   dev: pointer to the vtI2CStruct data structure
+//   handler: the function to call (NULL to go back to using the queue)
+//   arg: passed to the handler with each result
+void vtI2CSetResultHandler(vtI2CStruct *dev,vtI2CResultHandler handler,void *arg);
+// Take a copy of the bus counters
+//   The counters start at zero in vtI2CInit() and are never reset, so rates are found by taking two copies
+// Args
+//   dev: pointer to the vtI2CStruct data structure
+//   stats: filled in with the counters
+void vtI2CGetStats(vtI2CStruct *dev,vtI2CStats *stats);
+// Take a copy of the counters for each slave device, to see which one is NACKing or taking up the bus
+// Args:
+//   dev: pointer to the vtI2CStruct data structure
+//   slaves: filled in with the counters, one entry for each slave address used so far
+//   maxSlaves: the number of entries slaves has room for
+// Return:
+//   the number of entries filled in
+int vtI2CGetSlaveStats(vtI2CStruct *dev,vtI2CSlaveStats *slaves,int maxSlaves);
 #endif
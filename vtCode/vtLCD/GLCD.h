@@ -60,5 +60,10 @@ extern void GLCD_Bargraph       (unsigned int x, unsigned int y, unsigned int w,
 extern void GLCD_Bitmap         (unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned char *bitmap);
 extern void GLCD_Bmp            (unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned char *bmp);
 extern void GLCD_ScrollVertical (unsigned int dy);
+extern void GLCD_BitPlane       (unsigned int x, unsigned int y, unsigned int w, unsigned int h, const unsigned char *plane, unsigned int stride);
+
+/* 16x24 font used by GLCD_DisplayChar() with fi = 1: 24 rows per character  */
+/* starting at ' ', leftmost pixel in the most significant bit                */
+extern const unsigned short Font_16x24_h[];
 
 #endif /* _GLCD_H */
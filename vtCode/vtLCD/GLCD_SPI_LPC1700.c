@@ -267,6 +267,144 @@ static void wr_dat_only (unsigned short dat) {
 }
 
 
+/*******************************************************************************
+* DMA data writing to the LCD controller (between wr_dat_start/wr_dat_stop)    *
+*   Parameter:    color:  color to be written count times (wr_dat_fill)        *
+*                 pix:    pixels to be written (wr_dat_block)                  *
+*                 count:  number of pixels                                     *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static void wr_dat_fill (unsigned short *color, unsigned int count) {
+
+  vtSSPStartDMA(color, count, 1);
+  if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
+	VT_HANDLE_FATAL_ERROR(0);
+  }
+}
+
+static void wr_dat_block (unsigned short *pix, unsigned int count) {
+
+  vtSSPStartDMA(pix, count, 0);
+  if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
+	VT_HANDLE_FATAL_ERROR(0);
+  }
+}
+
+
+/*******************************************************************************
+* Overlapped DMA data writing: wr_dat_span starts writing a span and returns   *
+* at once so the next span can be built while this one goes out; wr_dat_sync   *
+* waits for the last span started (if any)                                     *
+*   Parameter:    pix:    pixels to be written (left alone until wr_dat_sync)  *
+*                 count:  number of pixels                                     *
+*   Return:                                                                    *
+*******************************************************************************/
+
+static unsigned char spanBusy = 0;
+
+static void wr_dat_sync (void) {
+
+  if (spanBusy) {
+    if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
+	  VT_HANDLE_FATAL_ERROR(0);
+    }
+    spanBusy = 0;
+  }
+}
+
+static void wr_dat_span (unsigned short *pix, unsigned int count) {
+
+  wr_dat_sync();
+  vtSSPStartDMA(pix, count, 0);
+  spanBusy = 1;
+}
+
+
+/*******************************************************************************
+* Expand 1 bit per pixel data into a span of pixels (set bits in TextColor,    *
+* clear bits in BackColor).  The pixels for each of the 16 4-bit patterns are  *
+* kept in spanNibble and rebuilt only when the colors change, so whole glyph   *
+* rows are expanded with table copies rather than a test per pixel             *
+*******************************************************************************/
+
+static unsigned short spanNibble[16][4];
+static unsigned short spanText, spanBack;
+static unsigned char spanValid = 0;
+
+static void span_colors (void) {
+  unsigned int n, b;
+
+  if (spanValid && (spanText == TextColor) && (spanBack == BackColor)) {
+    return;
+  }
+  spanText = TextColor;
+  spanBack = BackColor;
+  for (n = 0; n < 16; n++) {
+    for (b = 0; b < 4; b++) {
+      spanNibble[n][b] = (n & (0x8 >> b)) ? spanText : spanBack;
+    }
+  }
+  spanValid = 1;
+}
+
+/*******************************************************************************
+* Expand the low n bits of bits, the most significant of them first            *
+*   Parameter:    dst:    where the pixels go                                  *
+*                 bits:   the pixel bits                                       *
+*                 n:      number of pixels (up to 32)                          *
+*   Return:               the next free pixel in dst                           *
+*******************************************************************************/
+
+static unsigned short *span_bits (unsigned short *dst, unsigned long bits, unsigned int n) {
+  const unsigned short *src;
+
+  while (n >= 4) {
+    n -= 4;
+    src = spanNibble[(bits >> n) & 0xF];
+    dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = src[3];
+    dst += 4;
+  }
+  while (n > 0) {
+    n--;
+    *dst++ = ((bits >> n) & 1) ? spanText : spanBack;
+  }
+  return(dst);
+}
+
+/*******************************************************************************
+* Build one pixel row of a string: the same glyph row of each character, left  *
+* to right, in one span                                                        *
+*   Parameter:    dst:    where the pixels go                                  *
+*                 fi:     font index (0 = 6x8, 1 = 16x24)                      *
+*                 s:      the characters                                       *
+*                 n:      number of characters                                 *
+*                 row:    glyph row (0 is the top)                             *
+*   Return:                                                                    *
+*******************************************************************************/
+
+#define FONT_FIRST  0x20                /* First character in both fonts      */
+#define FONT_LAST   0x8F                /* Last character in both fonts       */
+
+static unsigned int font_index (unsigned char c) {
+
+  // anything not in the font is shown as a space
+  return(((c < FONT_FIRST) || (c > FONT_LAST)) ? 0 : (c - FONT_FIRST));
+}
+
+static void span_text_row (unsigned short *dst, unsigned char fi, const unsigned char *s, unsigned int n, unsigned int row) {
+  unsigned int k;
+
+  for (k = 0; k < n; k++) {
+    if (fi == 0) {
+      dst = span_bits(dst, Font_6x8_h[font_index(s[k]) * 8 + row], 6);
+    } else {
+      dst = span_bits(dst, Font_16x24_h[font_index(s[k]) * 24 + row], 16);
+    }
+  }
+}
+
+
 /*******************************************************************************
 * Read data from the LCD controller                                            *
 *   Parameter:                                                                 *
@@ -676,25 +814,12 @@ void GLCD_Clear (unsigned short color) {
 #else
   Not implemented
 #endif
-  unsigned int i;
-  vtSSPIsrData dataCfg;  
-  unsigned char *tptr = (unsigned char *) colorBuf;
-  
-  dataCfg.tx_data = colorBuf;
-  dataCfg.length = WIDTH*sizeof(unsigned short);
-
-  tptr[0] = color >> 8;
-  tptr[1] = color & 0xFF;
-  for (i=1;i<WIDTH;i++) colorBuf[i] = colorBuf[0];
+  // The whole screen goes out in one DMA operation
+  colorBuf[0] = color;
   GLCD_WindowMax();
   wr_cmd(0x22);
   wr_dat_start();
-  for (i=0;i<HEIGHT;i++) {
-	vtSSPStartOperation(&dataCfg);
-	if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
-		VT_HANDLE_FATAL_ERROR(0);
-	}
-  }
+  wr_dat_fill(colorBuf, WIDTH*HEIGHT);
   wr_dat_stop();
 }
 
@@ -703,25 +828,11 @@ void GLCD_ClearWindow (unsigned int x, unsigned int y, unsigned int width, unsig
 #else
   Not implemented
 #endif  
-  unsigned int i;
-  vtSSPIsrData dataCfg;  
-  unsigned char *tptr = (unsigned char *) colorBuf;
-  
-  dataCfg.tx_data = colorBuf;
-  dataCfg.length = width*sizeof(unsigned short);
-
-  tptr[0] = color >> 8;
-  tptr[1] = color & 0xFF;
-  for (i=1;i<width;i++) colorBuf[i] = colorBuf[0];
+  colorBuf[0] = color;
   GLCD_SetWindow(y, WIDTH-x-width, height, width);
   wr_cmd(0x22);
   wr_dat_start();
-  for (i=0;i<height;i++) {
-	vtSSPStartOperation(&dataCfg);
-	if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
-		VT_HANDLE_FATAL_ERROR(0);
-	}
-  }
+  wr_dat_fill(colorBuf, width*height);
   wr_dat_stop();
 }
 
@@ -738,30 +849,27 @@ void GLCD_ClearWindow (unsigned int x, unsigned int y, unsigned int width, unsig
 *******************************************************************************/
 
 void GLCD_DrawChar_U8 (unsigned int x, unsigned int y, unsigned int cw, unsigned int ch, unsigned char *c) {
-  int i, j;
+  unsigned int j;
+  unsigned short *dst;
 
+  if ((x+cw > WIDTH) || (y+ch > HEIGHT)) {
+    // writing past the end of the line or the bottom of the screen -- ignore it
+  	return;
+  }
 #if (HORIZONTAL == 1)
-  x = WIDTH-x-cw;
-  GLCD_SetWindow(y, x, ch, cw);
+  GLCD_SetWindow(y, WIDTH-x-cw, ch, cw);
 #else
   GLCD_SetWindow(x, y, cw, ch);
 #endif
-  wr_cmd(0x22);
-  wr_dat_start();
+  span_colors();
+  // a 6x8 character is 48 pixels, so it goes out in one block
+  dst = colorBuf;
   for (j = 0; j < ch; j++) {
-#if (HORIZONTAL == 1)
-    for (i = cw-1; i >= 0; i--) {
-#else
-    for (i = 0; i <= cw-1; i++) {
-#endif
-      if(((*c) & (1 << i)) == 0x00) {
-        wr_dat_only(BackColor);
-      } else {
-        wr_dat_only(TextColor);
-      }
-    }
-    c++;
+    dst = span_bits(dst, c[j], cw);
   }
+  wr_cmd(0x22);
+  wr_dat_start();
+  wr_dat_block(colorBuf, cw*ch);
   wr_dat_stop();
 }
 
@@ -777,91 +885,35 @@ void GLCD_DrawChar_U8 (unsigned int x, unsigned int y, unsigned int cw, unsigned
 *******************************************************************************/
 
 void GLCD_DrawChar_U16 (unsigned int x, unsigned int y, unsigned int cw, unsigned int ch, unsigned short *c) {
-  int i, j;
-  int cnt;
-  unsigned short revBackColor;
-  unsigned short revTextColor;
-  vtSSPIsrData dataCfg;
-  unsigned short curBits;
-
-  revBackColor = BackColor >> 8;
-  revBackColor += BackColor << 8;
-  revTextColor = TextColor >> 8;
-  revTextColor += TextColor << 8;
-
-   // for (i=x+cw/2;i<x+cw;i++) {
-  				  GLCD_PutPixel ( x,y);
-//	}
-#if (HORIZONTAL == 1)
-  x = WIDTH-x-cw;
-  if (x < 0) {
-    // writing past the end of the line -- ignore it
+  unsigned int j;
+  unsigned int rows;
+  unsigned short *dst;
+
+  if ((x+cw > WIDTH) || (y+ch > HEIGHT)) {
+    // writing past the end of the line or the bottom of the screen -- ignore it
   	return;
   }
-  if (y+ch > HEIGHT) {
-    // writing beyond the bottom of the screen -- ignore it
-  	return;
-  } 
-  GLCD_SetWindow(y, x, ch, cw);
+#if (HORIZONTAL == 1)
+  GLCD_SetWindow(y, WIDTH-x-cw, ch, cw);
 #else
-  if (x+cw > WIDTH)) {
-    // writing past the end of the line -- ignore it
-  	return;
-  }
-  if (y+ch > HEIGHT) {
-    // writing beyond the bottom of the screen -- ignore it
-  	return;
-  }
   GLCD_SetWindow(x, y, cw, ch);
 #endif
-  dataCfg.tx_data = colorBuf;
-  //dataCfg.length = cw*sizeof(unsigned short);
-
+  span_colors();
   wr_cmd(0x22);
   wr_dat_start();
-  cnt = 0;
-  for (j = 0; j < ch; j++) {
-	curBits = (*c);
-	c++;
-#if (HORIZONTAL == 1)
-    for (i = cw-1; i >= 0; i--) {
-#else
-    for (i = 0; i <= cw-1; i++) {
-#endif
-	  
-	  /*if(((*c) & (1 << i)) == 0x00) {
-        colorBuf[cnt] = revBackColor; cnt++; //wr_dat_only(BackColor);
-      } else {
-        colorBuf[cnt] = revTextColor; cnt++; //wr_dat_only(TextColor);
-      }	 */
-	  if (curBits & 0x8000) {
-        colorBuf[cnt] = revTextColor; 
-      } else {
-        colorBuf[cnt] = revBackColor;
-      }
-	  cnt++;
-	  curBits = curBits << 1;
+  // as many rows as fit in colorBuf per block (all 24 rows of a 16x24 character take two)
+  rows = WIDTH/cw;
+  for (j = 0; j < ch; j += rows) {
+    if (j+rows > ch) {
+      rows = ch-j;
     }
-	if (cnt > WIDTH-cw) {
-		// the buffer is nearly full, so write it out
-		dataCfg.length = cnt*sizeof(unsigned short);
-		vtSSPStartOperation(&dataCfg);
-		if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
-			VT_HANDLE_FATAL_ERROR(0);
-		}
-		cnt = 0;
-	}
-  }
-  if (cnt > 0) {
-  	// send out the rest of the buffer if it has not been written yet
-	dataCfg.length = cnt*sizeof(unsigned short);
-	vtSSPStartOperation(&dataCfg);
-	if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
-		VT_HANDLE_FATAL_ERROR(0);
-	}
+    dst = colorBuf;
+    while (dst < colorBuf+rows*cw) {
+      dst = span_bits(dst, *c++, cw);
+    }
+    wr_dat_block(colorBuf, rows*cw);
   }
   wr_dat_stop();
-
 }
 
 
@@ -875,21 +927,19 @@ void GLCD_DrawChar_U16 (unsigned int x, unsigned int y, unsigned int cw, unsigne
 *******************************************************************************/
 
 void GLCD_DisplayChar (unsigned int ln, unsigned int col, unsigned char fi, unsigned char c) {
+  unsigned char s[2];
 
-  c -= 32;
-  switch (fi) {
-    case 0:  /* Font 6 x 8 */
-      GLCD_DrawChar_U8 (col *  6, ln *  8,  6,  8, (unsigned char  *)&Font_6x8_h  [c * 8]);
-      break;
-    case 1:  /* Font 16 x 24 */
-      GLCD_DrawChar_U16(col * 16, ln * 24, 16, 24, (unsigned short *)&Font_16x24_h[c * 24]);
-      break;
-  }
+  s[0] = c;
+  s[1] = 0;
+  GLCD_DisplayString(ln, col, fi, s);
 }
 
 
 /*******************************************************************************
 * Disply string on given line                                                  *
+* The string is drawn in one window, a pixel row at a time: each row is built  *
+* as one span across all of the characters while the previous row is still    *
+* going out over DMA                                                           *
 *   Parameter:      ln:       line number                                      *
 *                   col:      column number                                    *
 *                   fi:       font index (0 = 6x8, 1 = 16x24)                  *
@@ -897,12 +947,47 @@ void GLCD_DisplayChar (unsigned int ln, unsigned int col, unsigned char fi, unsi
 *   Return:                                                                    *
 *******************************************************************************/
 
+static unsigned short spanBuf[WIDTH];   /* Second row buffer (with colorBuf)  */
+
 void GLCD_DisplayString (unsigned int ln, unsigned int col, unsigned char fi, unsigned char *s) {
+  unsigned int cw, ch, x, y, n, j;
+  unsigned short *buf;
 
-  GLCD_WindowMax();
-  while (*s) {
-    GLCD_DisplayChar(ln, col++, fi, *s++);
+  switch (fi) {
+    case 0:  cw =  6; ch =  8; break;   /* Font 6 x 8                         */
+    case 1:  cw = 16; ch = 24; break;   /* Font 16 x 24                       */
+    default: return;
   }
+  x = col * cw;
+  y = ln * ch;
+  if ((x >= WIDTH) || (y+ch > HEIGHT)) {
+    // nothing of the string is on the screen
+    return;
+  }
+  // characters past the end of the line are dropped
+  n = 0;
+  while ((s[n] != 0) && (x+(n+1)*cw <= WIDTH)) {
+    n++;
+  }
+  if (n == 0) {
+    return;
+  }
+#if (HORIZONTAL == 1)
+  GLCD_SetWindow(y, WIDTH-x-n*cw, ch, n*cw);
+#else
+  GLCD_SetWindow(x, y, n*cw, ch);
+#endif
+  span_colors();
+  wr_cmd(0x22);
+  wr_dat_start();
+  buf = colorBuf;
+  for (j = 0; j < ch; j++) {
+    span_text_row(buf, fi, s, n, j);
+    wr_dat_span(buf, n*cw);
+    buf = (buf == colorBuf) ? spanBuf : colorBuf;
+  }
+  wr_dat_sync();
+  wr_dat_stop();
 }
 
 
@@ -914,10 +999,7 @@ void GLCD_DisplayString (unsigned int ln, unsigned int col, unsigned char fi, un
 *******************************************************************************/
 
 void GLCD_ClearLn (unsigned int ln, unsigned char fi) {
-  int i;
   unsigned int cHeight, pixHeight;
-  unsigned char *tptr = (unsigned char *) colorBuf;
-  vtSSPIsrData dataCfg;
 
   switch(fi)  {
   	case 0: {
@@ -942,20 +1024,10 @@ void GLCD_ClearLn (unsigned int ln, unsigned char fi) {
 #else
   GLCD_SetWindow(0, pixHeight, WIDTH, cHeight);
 #endif
-  dataCfg.tx_data = colorBuf;
-  dataCfg.length = WIDTH*sizeof(unsigned short);
-
-  tptr[0] = BackColor >> 8;
-  tptr[1] = BackColor & 0xFF;
-  for (i=1;i<WIDTH;i++) colorBuf[i] = colorBuf[0];
+  colorBuf[0] = BackColor;
   wr_cmd(0x22);
   wr_dat_start();
-  for (i=0;i<cHeight;i++) {
-	vtSSPStartOperation(&dataCfg);
-	if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
-		VT_HANDLE_FATAL_ERROR(0);
-	}
-  }
+  wr_dat_fill(colorBuf, WIDTH*cHeight);
   wr_dat_stop();
 
 #if 0
@@ -1078,8 +1150,6 @@ void GLCD_Bitmap (unsigned int x, unsigned int y, unsigned int w, unsigned int h
 void GLCD_Bmp (unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned char *bmp) {
   unsigned int    i, j;
   unsigned short *bitmap_ptr = (unsigned short *)bmp;
-  vtSSPIsrData dataCfg;
-  unsigned char *tbuf = (unsigned char *) colorBuf;
   unsigned int bufCnt;
 
 #if (HORIZONTAL == 1)
@@ -1088,7 +1158,6 @@ void GLCD_Bmp (unsigned int x, unsigned int y, unsigned int w, unsigned int h, u
 #else
   GLCD_SetWindow(x, y, w, h);
 #endif
-  dataCfg.tx_data = colorBuf;
   wr_cmd(0x22);
   wr_dat_start();
 #if (HORIZONTAL == 1)
@@ -1097,26 +1166,16 @@ void GLCD_Bmp (unsigned int x, unsigned int y, unsigned int w, unsigned int h, u
   for (j = 0; j < h; j++) {
     for (i = 0; i < w; i++) {
       //wr_dat_only(*bitmap_ptr--);
-	  tbuf[bufCnt] = (*bitmap_ptr) >> 8; bufCnt++;
-	  tbuf[bufCnt] = (*bitmap_ptr) & 0xFF; bufCnt++;
-	  //colorBuf[bufCnt] = (*bitmap_ptr); bufCnt++;
-	  if (bufCnt >= (WIDTH*2)-2) {
-	    dataCfg.length = bufCnt;
-		vtSSPStartOperation(&dataCfg);
-		if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
-			VT_HANDLE_FATAL_ERROR(0);
-		}
+	  colorBuf[bufCnt] = (*bitmap_ptr); bufCnt++;
+	  if (bufCnt >= WIDTH) {
+		wr_dat_block(colorBuf, bufCnt);
 		bufCnt = 0;
 	  }
 	  bitmap_ptr--;
     }
   }
   if (bufCnt > 0) {
-    dataCfg.length = bufCnt;
-	vtSSPStartOperation(&dataCfg);
-	if (vtSSPWaitComplete(portMAX_DELAY) != pdPASS) {
-		VT_HANDLE_FATAL_ERROR(0);
-	}
+	wr_dat_block(colorBuf, bufCnt);
   }
 #else
   bitmap_ptr += ((h-1)*w);
@@ -1131,6 +1190,55 @@ void GLCD_Bmp (unsigned int x, unsigned int y, unsigned int w, unsigned int h, u
 }
 
 
+/*******************************************************************************
+* Display part of a 1 bit per pixel plane (set bits in TextColor, clear bits   *
+* in BackColor) in one window                                                  *
+*   Parameter:      x:        horizontal position (in the screen and plane)    *
+*                   y:        vertical position (in the screen and plane)      *
+*                   w:        width of the part to display                     *
+*                   h:        height of the part to display                    *
+*                   plane:    the plane, leftmost pixel in the MSB of a byte   *
+*                   stride:   bytes per row of the plane                       *
+*   Return:                                                                    *
+*******************************************************************************/
+
+void GLCD_BitPlane (unsigned int x, unsigned int y, unsigned int w, unsigned int h, const unsigned char *plane, unsigned int stride) {
+  unsigned int i, j, n;
+  const unsigned char *row;
+  unsigned short *buf, *dst;
+
+  if ((w == 0) || (h == 0) || (x+w > WIDTH) || (y+h > HEIGHT)) {
+    // nothing to do, or out of bounds
+    return;
+  }
+#if (HORIZONTAL == 1)
+  GLCD_SetWindow(y, WIDTH-x-w, h, w);
+#else
+  GLCD_SetWindow(x, y, w, h);
+#endif
+  span_colors();
+  wr_cmd(0x22);
+  wr_dat_start();
+  buf = colorBuf;
+  for (j = y; j < y+h; j++) {
+    // one span per row, a byte of the plane at a time (part bytes at either end)
+    row = plane + j*stride;
+    dst = buf;
+    for (i = x; i < x+w; i += n) {
+      n = 8 - (i & 7);
+      if (n > x+w-i) {
+        n = x+w-i;
+      }
+      dst = span_bits(dst, row[i >> 3] >> (8 - (i & 7) - n), n);
+    }
+    wr_dat_span(buf, w);
+    buf = (buf == colorBuf) ? spanBuf : colorBuf;
+  }
+  wr_dat_sync();
+  wr_dat_stop();
+}
+
+
 /*******************************************************************************
 * Scroll content of the whole display for dy pixels vertically                 *
 *   Parameter:      dy:       number of pixels for vertical scroll             *
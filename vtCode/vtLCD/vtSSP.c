@@ -5,8 +5,8 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "projdefs.h"
-#include "semphr.h"
 #include "vtSSP.h"
+#include "vtTrace.h"
 
 // Often, an interrupt handler needs some type of initilization data from the "rest" of the program.
 //   This initialization data does not change over time and is not for ongoing communication.  We'll use
@@ -17,7 +17,7 @@
 //   file for inclusion by other programs.  We would do the same for functions we expect other programs to use.
 typedef struct __vtSSPIsrStruct {
 	unsigned short unitNum; // Is it SSP 0 or 1
-	xSemaphoreHandle binSemaphore; // Binary semaphore used for coordination with tasks
+	xTaskHandle waitingTask; // Task that started the write -- notified when it is done
 	LPC_SSP_TypeDef *SSPx; // Pointer to the SSP module we are actually using
 	vtSSPIsrData *dataSetup; // temporary -- will replace
 } vtSSPIsrStruct;
@@ -25,9 +25,32 @@ typedef struct __vtSSPIsrStruct {
 //   The static declaration ensures that this variable is *not* visible outside of this file
 static vtSSPIsrStruct initSSPdata;
 
+// Linked list for DMA driven writes -- only the last descriptor raises an interrupt, so a full screen takes one
+//   The GPDMA reads these while it runs, so they cannot live on the caller's stack
+static GPDMA_LLI_Type dmaLLI[vtSSPDMAMaxLLI];
+
 /* *************************
 Private Functions
 ************************** */
+// Change the SSP frame size -- must only be done when the SSP is idle
+static void vtSSPSetDataBits(LPC_SSP_TypeDef *SSPx, uint32_t dataBits)
+{
+	SSPx->CR1 &= ~SSP_CR1_SSP_EN;
+	SSPx->CR0 = (SSPx->CR0 & ~SSP_CR0_DSS(16)) | dataBits;
+	SSPx->CR1 |= SSP_CR1_SSP_EN;
+}
+
+// Wait until the transmit FIFO has emptied and the module is no longer busy
+static void vtSSPDrain(LPC_SSP_TypeDef *SSPx)
+{
+	uint32_t status;
+
+	status = SSPx->SR;
+	while ((!(status & SSP_SR_TFE)) || (status & SSP_SR_BSY)){
+		status = SSPx->SR;
+	}
+}
+
 // Declare it static so that it cannot be called by any routine outside of this file
 static unsigned char vtSSPFastWriteBuffer(LPC_SSP_TypeDef *SSPx, vtSSPIsrData *dCfg)
 {
@@ -56,10 +79,7 @@ static unsigned char vtSSPFastWriteBuffer(LPC_SSP_TypeDef *SSPx, vtSSPIsrData *d
 		return(0);
 	} else {
 		// make sure the send queue has really emptied and the module is no longer busy
-		status = SSPx->SR;
-		while ((!(status & SSP_SR_TFE)) || (status & SSP_SR_BSY)){
-			status = SSPx->SR;
-		}
+		vtSSPDrain(SSPx);
 		return(1);
 	}
 }
@@ -86,16 +106,12 @@ int vtSSPIsrInit(unsigned short unitNum) {
 		}
 	}
 	initSSPdata.dataSetup = NULL;
-	vSemaphoreCreateBinary(initSSPdata.binSemaphore);
-	if (initSSPdata.binSemaphore == NULL) {
-		return(vtSSPErrInit);
-	}
-	// Need to do an initial "take" on the semaphore to ensure that it is initially blocked
-	if (xSemaphoreTake(initSSPdata.binSemaphore,0) != pdTRUE) {
-		// free up everyone and go home
-		vQueueDelete(initSSPdata.binSemaphore);
-		return(vtSSPErrInit);
-	}
+	initSSPdata.waitingTask = NULL;
+	// Power up the GPDMA for vtSSPStartDMA() -- its interrupt is left enabled, as it only comes at the end of a write
+	GPDMA_Init();
+	NVIC_SetPriority(DMA_IRQn,vtSSPIntPriority);
+	NVIC_ClearPendingIRQ(DMA_IRQn);
+	NVIC_EnableIRQ(DMA_IRQn);
 	return(vtSSPInitSuccess);
 }
 
@@ -111,6 +127,7 @@ void vtSSPStartOperation(vtSSPIsrData *dptr)
 	// 3. Clear any pending interrupts of this type via the NVIC (Nested Vector Interrupt Controller)
 	// 4. Enable the interrupt via the NVIC
 	// 5. Unmask any interrupts in the SSP module
+	initSSPdata.waitingTask = xTaskGetCurrentTaskHandle();
 	initSSPdata.dataSetup = dptr;
 	initSSPdata.dataSetup->tx_cnt = 0;
 	if (initSSPdata.unitNum == 0) {
@@ -129,27 +146,107 @@ void vtSSPStartOperation(vtSSPIsrData *dptr)
 portBASE_TYPE vtSSPWaitComplete(portTickType delay)
 {
 	portBASE_TYPE retVal;
-	retVal = xSemaphoreTake(initSSPdata.binSemaphore,delay);
+	retVal = (ulTaskNotifyTake(pdTRUE,delay) != 0) ? pdTRUE : pdFALSE;
 	NVIC_DisableIRQ(SSP1_IRQn);
 	return(retVal);
 }
 
+// Call this function to begin a DMA driven write of 16-bit words
+void vtSSPStartDMA(const uint16_t *data,uint32_t count,uint8_t fill)
+{
+	GPDMA_Channel_CFG_Type dmaCfg;
+	uint32_t control;
+	uint32_t chunk;
+	uint32_t src = (uint32_t) data;
+	int n;
+
+	if ((count == 0) || (count > vtSSPDMAMaxWords)) {
+		VT_HANDLE_FATAL_ERROR(count);
+	}
+	// A fill reads the same word over and over, so the source address is only incremented for a buffer
+	control = GPDMA_DMACCxControl_SBSize(GPDMA_BSIZE_4) | GPDMA_DMACCxControl_DBSize(GPDMA_BSIZE_4)
+			| GPDMA_DMACCxControl_SWidth(GPDMA_WIDTH_HALFWORD) | GPDMA_DMACCxControl_DWidth(GPDMA_WIDTH_HALFWORD);
+	if (!fill) {
+		control |= GPDMA_DMACCxControl_SI;
+	}
+	for (n=0;count>0;n++) {
+		chunk = (count > vtSSPDMAMaxChunk) ? vtSSPDMAMaxChunk : count;
+		count -= chunk;
+		dmaLLI[n].SrcAddr = src;
+		dmaLLI[n].DstAddr = (uint32_t) &(initSSPdata.SSPx->DR);
+		dmaLLI[n].NextLLI = (count > 0) ? (uint32_t) &(dmaLLI[n+1]) : 0;
+		dmaLLI[n].Control = control | GPDMA_DMACCxControl_TransferSize(chunk) | ((count > 0) ? 0 : GPDMA_DMACCxControl_I);
+		if (!fill) {
+			src += chunk*sizeof(uint16_t);
+		}
+	}
+
+	initSSPdata.waitingTask = xTaskGetCurrentTaskHandle();
+	// Anything already written (e.g. the LCD start byte) has to go out in 8-bit frames before the switch
+	vtSSPDrain(initSSPdata.SSPx);
+	vtSSPSetDataBits(initSSPdata.SSPx,SSP_DATABIT_16);
+
+	dmaCfg.ChannelNum = vtSSPDMAChannel;
+	dmaCfg.TransferSize = dmaLLI[0].Control & GPDMA_DMACCxControl_TransferSize(0xFFF);
+	dmaCfg.TransferWidth = 0;
+	dmaCfg.SrcMemAddr = dmaLLI[0].SrcAddr;
+	dmaCfg.DstMemAddr = 0;
+	dmaCfg.TransferType = GPDMA_TRANSFERTYPE_M2P;
+	dmaCfg.SrcConn = 0;
+	dmaCfg.DstConn = (initSSPdata.unitNum == 0) ? GPDMA_CONN_SSP0_Tx : GPDMA_CONN_SSP1_Tx;
+	dmaCfg.DMALLI = dmaLLI[0].NextLLI;
+	if (GPDMA_Setup(&dmaCfg) != SUCCESS) {
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	// GPDMA_Setup() always sets up byte transfers with an interrupt at the end of the first block -- use the first descriptor instead
+	vtSSPDMAChannelRegs->DMACCControl = dmaLLI[0].Control;
+	SSP_DMACmd(initSSPdata.SSPx,SSP_DMA_TX,ENABLE);
+	GPDMA_ChannelCmd(vtSSPDMAChannel,ENABLE);
+}
+
 // This function assumes that SSP_isrInit() has already been successfully executed
 // This function *only* handles the TX side of things and completely ignores RX
 void vtSSPIsr(void) {
+	vtTraceIsrEnter(vtTraceIsrSSP0+initSSPdata.unitNum);
 	// Mask out interrupts from SSP
 	initSSPdata.SSPx->IMSC = 0;
 	// Write data to the SSP module
 	if (vtSSPFastWriteBuffer(initSSPdata.SSPx,initSSPdata.dataSetup)) {
 		// We have completed writing the entire buffer
-		//   Signal that the buffer is now free for other use via the Semaphore
+		//   Signal that the buffer is now free for other use by notifying the task that started the write
 		//   All four of the following lines are done as per the FreeRTOS API requirements
 		static signed portBASE_TYPE xHigherPriorityTaskWoken;
 		xHigherPriorityTaskWoken = pdFALSE;
-		xSemaphoreGiveFromISR(initSSPdata.binSemaphore,&xHigherPriorityTaskWoken);
+		vTaskNotifyGiveFromISR(initSSPdata.waitingTask,&xHigherPriorityTaskWoken);
+		vtTraceIsrExit(vtTraceIsrSSP0+initSSPdata.unitNum);
 		portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 	} else {
 		// We have not yet finished writing the buffer, so unmask the SSP TX interrupt
 		initSSPdata.SSPx->IMSC = SSP_INTCFG_TX;
+		vtTraceIsrExit(vtTraceIsrSSP0+initSSPdata.unitNum);
+	}
+}
+
+// This function assumes that vtSSPIsrInit() has already been successfully executed
+// The GPDMA only interrupts at the end of the last descriptor of a write started by vtSSPStartDMA()
+void vtSSPDMAIsr(void) {
+	vtTraceIsrEnter(vtTraceIsrDMA);
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTERR,vtSSPDMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTERR,vtSSPDMAChannel);
+		VT_HANDLE_FATAL_ERROR(0);
+	}
+	if (GPDMA_IntGetStatus(GPDMA_STAT_INTTC,vtSSPDMAChannel)) {
+		GPDMA_ClearIntPending(GPDMA_STATCLR_INTTC,vtSSPDMAChannel);
+		SSP_DMACmd(initSSPdata.SSPx,SSP_DMA_TX,DISABLE);
+		// The last words are still in the SSP FIFO -- they must be out before the caller can raise the chip select
+		vtSSPDrain(initSSPdata.SSPx);
+		vtSSPSetDataBits(initSSPdata.SSPx,SSP_DATABIT_8);
+		static signed portBASE_TYPE xHigherPriorityTaskWoken;
+		xHigherPriorityTaskWoken = pdFALSE;
+		vTaskNotifyGiveFromISR(initSSPdata.waitingTask,&xHigherPriorityTaskWoken);
+		vtTraceIsrExit(vtTraceIsrDMA);
+		portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+	} else {
+		vtTraceIsrExit(vtTraceIsrDMA);
 	}
 }
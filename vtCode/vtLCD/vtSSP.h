@@ -6,9 +6,19 @@
 
 #include "vtUtilities.h"
 #include "lpc17xx_ssp.h"
+#include "lpc17xx_gpdma.h"
 
 #define vtSSPIntPriority 7
 
+// GPDMA channel used for DMA driven SSP writes (channel 0 has the highest DMA priority)
+#define vtSSPDMAChannel 0
+#define vtSSPDMAChannelRegs LPC_GPDMACH0
+// Largest number of 16-bit words in one linked list descriptor (the GPDMA transfer size field is 12 bits)
+#define vtSSPDMAMaxChunk 4095
+// Largest DMA write -- a full 320x240 screen
+#define vtSSPDMAMaxWords (320*240)
+#define vtSSPDMAMaxLLI ((vtSSPDMAMaxWords+vtSSPDMAMaxChunk-1)/vtSSPDMAMaxChunk)
+
 #define vtSSPErrInit -1
 #define vtSSPInitSuccess 0
 
@@ -24,7 +34,17 @@ int vtSSPIsrInit(unsigned short);
 
 void vtSSPStartOperation(vtSSPIsrData *);
 
+// Wait for the write to finish -- this *must* be called by the task that started the write, as the interrupt handler notifies that task
 portBASE_TYPE vtSSPWaitComplete(portTickType);
 
+// Begin a DMA driven write of 16-bit words (e.g. pixels), finished with vtSSPWaitComplete()
+//   The SSP sends 16-bit frames for the write, so each word goes out high byte first -- just as two 8-bit writes would
+//   If fill is non-zero, data[0] is sent count times, otherwise count words are sent from data
+//   The words are read while the DMA runs, so data *must* not be changed or de-allocated until vtSSPWaitComplete() returns
+void vtSSPStartDMA(const uint16_t *data,uint32_t count,uint8_t fill);
+
 void vtSSPIsr(void);
+
+// GPDMA interrupt handler (in the vector table in place of DMA_IRQHandler)
+void vtSSPDMAIsr(void);
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include <string.h>
+
+/* Scheduler include files. */
+#include "FreeRTOS.h"
+
+/* include files. */
+#include "vtTrace.h"
+
+/* *********************************************** */
+// definitions and data structures that are private to this file
+// The trace is placed by the linker on the target (after the occupancy grid) -- the host build defines this as nothing
+#ifndef vtTraceSection
+#define vtTraceSection __attribute__ ((section ("USB_RAM")))
+#endif
+
+// Not in vtTraceData, as that is not cleared at reset (see ldscript_rom_gnu.ld)
+static volatile int running = 0;
+static uint8_t queuesCreated = 0;
+static uint8_t lastTask = 0;
+// The timers seen so far, by the order they first expired in
+static const void *timers[vtTraceMaxTimers];
+static int timersSeen = 0;
+// end of defs
+/* *********************************************** */
+
+vtTraceRecorder vtTraceData vtTraceSection;
+
+static void traceName(char *dst,const signed char *name)
+{
+	strncpy(dst,(const char *) name,vtTraceNameLen-1);
+	dst[vtTraceNameLen-1] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+// Public API
+void vtTraceStart(void)
+{
+	running = 0;
+	memset(&vtTraceData,0,sizeof(vtTraceData));
+	vtTraceData.magic = vtTraceMagic;
+	vtTraceData.version = vtTraceVersion;
+	vtTraceData.eventSize = sizeof(vtTraceEvent);
+	vtTraceData.clockHz = vtTraceClockHz;
+	vtTraceData.length = vtTraceLen;
+	queuesCreated = 0;
+	lastTask = 0;
+	timersSeen = 0;
+	vtTraceData.running = 1;
+	running = 1;
+}
+
+void vtTraceStop(void)
+{
+	running = 0;
+	vtTraceData.running = 0;
+}
+
+void vtTraceRecord(uint8_t type,uint8_t obj,uint16_t arg)
+{
+	vtTraceEvent *e;
+
+	if (!running) {
+		return;
+	}
+	// Claim a slot, then fill it in -- anything that interrupts this takes the next one
+	e = &(vtTraceData.events[__sync_fetch_and_add(&(vtTraceData.head),1) & (vtTraceLen-1)]);
+	e->time = portGET_RUN_TIME_COUNTER_VALUE();
+	e->type = type;
+	e->obj = obj;
+	e->arg = arg;
+}
+
+void vtTraceTaskCreated(unsigned long number,const signed char *name,unsigned long priority)
+{
+	if (!running) {
+		return;
+	}
+	if (number < vtTraceMaxTasks) {
+		traceName(vtTraceData.taskNames[number],name);
+	}
+	vtTraceRecord(vtTraceEvtTaskCreate,number,priority);
+}
+
+void vtTraceSwitchedIn(unsigned long number)
+{
+	// vTaskSwitchContext() often picks the task that was already running
+	if (number != lastTask) {
+		lastTask = number;
+		vtTraceRecord(vtTraceEvtSwitchIn,number,0);
+	}
+}
+
+uint8_t vtTraceQueueCreated(uint8_t kind)
+{
+	// Queue 0 is any queue past the end of the table
+	if ((!running) || (queuesCreated >= vtTraceMaxQueues-1)) {
+		return(0);
+	}
+	queuesCreated++;
+	vtTraceData.queueKinds[queuesCreated] = kind;
+	vtTraceRecord(vtTraceEvtQueueCreate,queuesCreated,kind);
+	return(queuesCreated);
+}
+
+void vtTraceTimerExpired(const void *timer,const signed char *name)
+{
+	int i;
+
+	for (i=0;(i<timersSeen) && (timers[i] != timer);i++);
+	if ((i == timersSeen) && (timersSeen < vtTraceMaxTimers)) {
+		timers[timersSeen++] = timer;
+		traceName(vtTraceData.timerNames[i],name);
+	}
+	// Timer 0 is any timer past the end of the table
+	vtTraceRecord(vtTraceEvtTimerExpired,(i < vtTraceMaxTimers) ? i+1 : 0,0);
+}
+// End of Public API
+/*-----------------------------------------------------------*/
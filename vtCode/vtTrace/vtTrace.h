@@ -0,0 +1,146 @@
+#ifndef __vtTraceh
+#define __vtTraceh
+#include <stdint.h>
+#ifndef configUSE_VT_TRACE
+#error Include FreeRTOS.h before vtTrace.h
+#endif
+
+// Binary kernel event trace
+//
+// Every event is 8 bytes in a ring buffer: a 32-bit timestamp from the run time stats clock (TIM0 on the
+//   target, at vtTraceClockHz), the event type, the task/queue/interrupt/timer it is about and one more
+//   byte of detail.  The ring keeps the last vtTraceLen events.
+//
+// The kernel writes the events itself through the trace macros (traceTASK_SWITCHED_IN() and the rest),
+//   which this file defines when configUSE_VT_TRACE is set in FreeRTOSConfig.h.  That file includes this
+//   one, so this one must not include any FreeRTOS headers and other files should get it by including
+//   FreeRTOS.h first.  The drivers mark their interrupt handlers with vtTraceIsrEnter()/vtTraceIsrExit().
+//
+// Writing an event takes no lock: the slot is claimed with an atomic increment of the head (ldrex/strex
+//   on the Cortex-M3), so an interrupt that arrives in the middle of a task's write just takes the next
+//   slot.  Two events written that close together may have their timestamps out of order by the time
+//   the interrupt took.
+//
+// To get the trace off the target, stop it (vtTraceStop(), or halt in the debugger) and save the memory
+//   of vtTraceData as a binary file, e.g. with gdb "dump binary value trace.bin vtTraceData".  The host
+//   build writes it with "rover_host -T trace.bin".  RTOSDemo/Host/traceDecode.c turns the file into
+//   per-task latency and blocking figures and (with -t) a timeline.
+
+// Events kept (a power of two)
+#define vtTraceLen 512
+#define vtTraceMaxTasks 16
+#define vtTraceMaxQueues 64
+#define vtTraceMaxTimers 8
+#define vtTraceNameLen 12
+// The timestamp clock -- TIM0 is set to count at 1MHz in vConfigureTimerForRunTimeStats() (main.c)
+#define vtTraceClockHz 1000000UL
+#define vtTraceMagic 0x45435254UL	// "TRCE"
+#define vtTraceVersion 1
+
+// The interrupts traced (the obj byte of vtTraceEvtIsrEnter/vtTraceEvtIsrExit)
+#define vtTraceIsrI2C0 1
+#define vtTraceIsrI2C1 2
+#define vtTraceIsrI2C2 3
+#define vtTraceIsrSSP0 4
+#define vtTraceIsrSSP1 5
+#define vtTraceIsrEINT2 6
+#define vtTraceIsrDMA 7
+
+// Event types, and what obj and arg hold for each
+#define vtTraceEvtTaskCreate 1			// task, priority
+#define vtTraceEvtSwitchIn 2			// task
+#define vtTraceEvtReady 3				// task
+#define vtTraceEvtDelay 4				// task (the running task blocks for a time)
+#define vtTraceEvtQueueCreate 5			// queue, kind (vtTraceQueueKind...)
+#define vtTraceEvtQueueSend 6			// queue
+#define vtTraceEvtQueueReceive 7		// queue
+#define vtTraceEvtBlockSend 8			// queue (the running task blocks until there is room)
+#define vtTraceEvtBlockReceive 9		// queue (the running task blocks until there is something)
+#define vtTraceEvtSendFailed 10			// queue (full and the wait, if any, ran out)
+#define vtTraceEvtReceiveFailed 11		// queue (empty and the wait, if any, ran out)
+#define vtTraceEvtSendFromIsr 12		// queue
+#define vtTraceEvtReceiveFromIsr 13		// queue
+#define vtTraceEvtIsrEnter 14			// interrupt (vtTraceIsr...)
+#define vtTraceEvtIsrExit 15			// interrupt
+#define vtTraceEvtTimerExpired 16		// timer (its callback is about to run in the timer task)
+#define vtTraceEvtBlockNotify 17		// task (the running task blocks until it is notified)
+#define vtTraceEvtNotifyFromIsr 18		// task (notified by an interrupt handler)
+
+#define vtTraceQueueKindQueue 0
+#define vtTraceQueueKindMutex 1
+
+typedef struct __vtTraceEvent {
+	uint32_t time;
+	uint8_t type;
+	uint8_t obj;
+	uint16_t arg;
+} vtTraceEvent;
+
+// What is saved from the target -- the layout is the same on the host, so only fixed size types are used
+typedef struct __vtTraceRecorder {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t eventSize;
+	uint32_t clockHz;
+	uint32_t length;
+	volatile uint32_t head;		// events written since vtTraceStart(); the next goes in head % length
+	volatile uint32_t running;
+	char taskNames[vtTraceMaxTasks][vtTraceNameLen];	// by the kernel's task number
+	char timerNames[vtTraceMaxTimers][vtTraceNameLen];	// by the order they first expired in (timer n at n-1)
+	uint8_t queueKinds[vtTraceMaxQueues];				// by the order they were created in (from 1)
+	vtTraceEvent events[vtTraceLen];
+} vtTraceRecorder;
+
+extern vtTraceRecorder vtTraceData;
+
+// Public API
+//
+// Clear the trace and start recording (called before the scheduler is started, so the task and queue
+//   creation is in it)
+void vtTraceStart(void);
+//
+// Stop recording, e.g. before the trace is saved or when something has gone wrong
+void vtTraceStop(void);
+//
+// Record an event (the macros below are the usual way in)
+void vtTraceRecord(uint8_t type,uint8_t obj,uint16_t arg);
+//
+// Used by the kernel macros below
+void vtTraceTaskCreated(unsigned long number,const signed char *name,unsigned long priority);
+void vtTraceSwitchedIn(unsigned long number);
+uint8_t vtTraceQueueCreated(uint8_t kind);
+void vtTraceTimerExpired(const void *timer,const signed char *name);
+// End of Public API
+
+#if configUSE_VT_TRACE == 1
+
+#define vtTraceIsrEnter(isr) vtTraceRecord(vtTraceEvtIsrEnter,(isr),0)
+#define vtTraceIsrExit(isr) vtTraceRecord(vtTraceEvtIsrExit,(isr),0)
+
+// The kernel hooks (see FreeRTOS.h for where each is called from)
+#define traceTASK_CREATE( pxNewTCB ) vtTraceTaskCreated( ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName, ( pxNewTCB )->uxPriority )
+#define traceTASK_SWITCHED_IN() vtTraceSwitchedIn( pxCurrentTCB->uxTCBNumber )
+#define traceMOVED_TASK_TO_READY_STATE( pxTCB ) vtTraceRecord( vtTraceEvtReady, ( pxTCB )->uxTCBNumber, 0 )
+#define traceTASK_DELAY() vtTraceRecord( vtTraceEvtDelay, pxCurrentTCB->uxTCBNumber, 0 )
+#define traceTASK_DELAY_UNTIL() vtTraceRecord( vtTraceEvtDelay, pxCurrentTCB->uxTCBNumber, 0 )
+#define traceQUEUE_CREATE( pxNewQueue ) ( pxNewQueue )->ucQueueNumber = vtTraceQueueCreated( vtTraceQueueKindQueue )
+#define traceCREATE_MUTEX( pxNewQueue ) ( pxNewQueue )->ucQueueNumber = vtTraceQueueCreated( vtTraceQueueKindMutex )
+#define traceQUEUE_SEND( pxQueue ) vtTraceRecord( vtTraceEvtQueueSend, ( pxQueue )->ucQueueNumber, 0 )
+#define traceQUEUE_RECEIVE( pxQueue ) vtTraceRecord( vtTraceEvtQueueReceive, ( pxQueue )->ucQueueNumber, 0 )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue ) vtTraceRecord( vtTraceEvtBlockSend, ( pxQueue )->ucQueueNumber, 0 )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue ) vtTraceRecord( vtTraceEvtBlockReceive, ( pxQueue )->ucQueueNumber, 0 )
+#define traceQUEUE_SEND_FAILED( pxQueue ) vtTraceRecord( vtTraceEvtSendFailed, ( pxQueue )->ucQueueNumber, 0 )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue ) vtTraceRecord( vtTraceEvtReceiveFailed, ( pxQueue )->ucQueueNumber, 0 )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue ) vtTraceRecord( vtTraceEvtSendFromIsr, ( pxQueue )->ucQueueNumber, 0 )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue ) vtTraceRecord( vtTraceEvtReceiveFromIsr, ( pxQueue )->ucQueueNumber, 0 )
+#define traceTIMER_EXPIRED( pxTimer ) vtTraceTimerExpired( ( pxTimer ), ( pxTimer )->pcTimerName )
+#define traceTASK_NOTIFY_TAKE_BLOCK() vtTraceRecord( vtTraceEvtBlockNotify, pxCurrentTCB->uxTCBNumber, 0 )
+#define traceTASK_NOTIFY_GIVE_FROM_ISR( pxTCB ) vtTraceRecord( vtTraceEvtNotifyFromIsr, ( pxTCB )->uxTCBNumber, 0 )
+
+#else
+
+#define vtTraceIsrEnter(isr)
+#define vtTraceIsrExit(isr)
+
+#endif
+#endif
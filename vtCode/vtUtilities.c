@@ -1,6 +1,7 @@
 #include "vtUtilities.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "vtTrace.h"
 #include "lpc17xx_gpio.h"
 
 // This tells us which pins on the board are the GPIO ports for the LEDs (printed on the board)
@@ -114,6 +115,8 @@ void vtHandleFatalError(int code,int line,char file[]) {
 	//   call this while another tries to get into 
 	taskENTER_CRITICAL();
 	taskDISABLE_INTERRUPTS();
+	// Keep the events that led up to this in the trace (see vtTrace.h for how to get it off the board)
+	vtTraceStop();
 	/* LEDs on ports 1 and 2 to output (1). */
 	// Note that all LED access is through the proper LPC library calls (or my own routines that call them)
 	vtInitLED();
@@ -393,5 +396,5 @@ int snprintf( char *buf, unsigned int count, const char *format, ... )
 #if MALLOC_VERSION==1
 #include "heap_3.c"
 #elif MALLOC_VERSION==2
-#include "heap_2.c"
+#include "heap_tlsf.c"
 #endif
\ No newline at end of file
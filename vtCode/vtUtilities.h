@@ -1,7 +1,7 @@
 #ifndef __vtUtilitiesh
 #define __vtUtilitiesh
 #include "lpc_types.h"
-#include "lpc17xx.h"
+#include "LPC17xx.h"
 #include "core_cm3.h"
 
 /* ************************************************************
@@ -14,7 +14,10 @@
 // Note: You can selectively enable/disable each port in the debug settings in the Keil tools, so you
 //       can leave your debug log statements in place w/o worrying about generating too much output.  Also,
 //       the following line (if set to 0) will let you eliminate these from the compiled code.
+//       It can also be set from the compiler command line (the host build in RTOSDemo/Host sets it to 0).
+#ifndef vtITMEnabled
 #define vtITMEnabled 2
+#endif
 // Here is where you should define each port you are using to avoid conflicts: use values 1 through 31
 #define vtITMPortI2C0IntHandler 1
 #define vtITMPortLCD 2
@@ -84,7 +87,10 @@ Something is wrong
 
 // Decide which version of malloc() is going to be used
 // NOTE: You should *really* think twice about directly using malloc()
+// It can also be set from the compiler command line (the host build uses this to try the other heap)
+#ifndef MALLOC_VERSION
 #define MALLOC_VERSION 1
+#endif
 
 #if MALLOC_VERSION==1
 // use the version built into the C libraries and supported by the heap allocation in syscalls.c
@@ -93,6 +99,9 @@ Something is wrong
 #elif MALLOC_VERSION==2
 // do not provide malloc()/free() to regular programs; tell FreeRTOS to use its own malloc()/free()
 //   the size of the heap used by FreeRTOS is defined in freertosconfig.h
+// FreeRTOS will be using heap_tlsf.c in this case (in place of heap_2.c, which never joins freed blocks back
+//   together and searches the whole free list on every call): malloc()/free() take the same time however
+//   full the heap is, and xPortGetLargestFreeBlock()/xPortGetMinimumEverFreeHeapSize() show how it is doing
 // If you are using this option *and* your code (or a routine it calls) makes a call to malloc(), then my
 //   code in syscalls.c will catch this and bring execution to a halt to let you know what happened.
 #else